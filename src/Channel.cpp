@@ -9,6 +9,9 @@
  * to forward configuration to every sub-block
  */
 #include "Channel.h"
+
+#include <algorithm>
+
 void Channel::b_transport( int id, tlm::tlm_generic_payload& trans, sc_time& delay )
 {
 
@@ -18,48 +21,400 @@ void Channel::b_transport( int id, tlm::tlm_generic_payload& trans, sc_time& del
 
     assert (id < (int)targ_socket.size());
 
-    // Forward path
+    vector<int> targets;
+
+    if (startTransmission(id, trans, targets))
+    {
+	// Realize the delay annotated onto the transport call
+	wait(delay);
+
+	if (!isCorrupted(id, targets))
+	    deliver(targets, trans);
+    }
+}
+
+
+tlm::tlm_sync_enum Channel::nb_transport_fw( int id, tlm::tlm_generic_payload& trans,
+                                             tlm::tlm_phase& phase, sc_time& delay )
+{
+    assert (id < (int)targ_socket.size());
+    assert (phase == tlm::BEGIN_REQ);
+
+    sc_time transmission_delay = delay + sc_time(this->cc_flit_transmission_delay_ps, SC_PS);
+
+    if (mac_policy == MAC_CSMA && carrierBusy(tx_hubs_id[id]))
+    {
+	// the initiator backs off
+	deferrals++;
+	trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+	return tlm::TLM_COMPLETED;
+    }
+
+    vector<int> targets;
+
+    if (startTransmission(id, trans, targets))
+    {
+	if (shared_access)
+	    checkCollisions(id, targets, trans);
+
+	m_id_map[&trans] = id;
+	peq.notify(trans, tlm::BEGIN_RESP, transmission_delay);
+    }
+
+    phase = tlm::END_REQ;
+    delay = transmission_delay;
+    return tlm::TLM_UPDATED;
+}
+
+
+void Channel::peq_cb(tlm::tlm_generic_payload& trans, const tlm::tlm_phase& phase)
+{
+    assert (phase == tlm::BEGIN_RESP);
+
+    std::map <tlm::tlm_generic_payload*, unsigned int>::iterator i = m_id_map.find(&trans);
+    assert (i != m_id_map.end());
+    unsigned int id = i->second;
+    m_id_map.erase(i);
+
+    Transmission t;
+    t.collided = false;
+    t.rx_busy = false;
+    t.trans = NULL;
+    for (unsigned int k = 0; k < in_flight.size(); k++)
+	if (in_flight[k].trans == &trans)
+	{
+	    t = in_flight[k];
+	    in_flight.erase(in_flight.begin() + k);
+	    break;
+	}
+
+    if (t.collided || t.rx_busy)
+    {
+	// the initiator retransmits the flit
+	if (t.rx_busy)
+	    rx_busy++;
+	else
+	    collisions++;
+	trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+    }
+    else
+    {
+	vector<int> targets;
+	decodeTargets(trans, targets);
+	// the receivers discard a corrupted flit, the initiator
+	// retransmits it once negatively acknowledged
+	if (!isCorrupted(id, targets))
+	    deliver(targets, trans);
+	busy_cycles += flit_transmission_cycles;
+
+	// a flit refused by a full antenna buffer is retransmitted
+	if (trans.is_response_ok())
+	{
+	    flits_delivered++;
+	    if (t.trans != NULL)
+		updateReceiver(t);
+	}
+    }
+
+    tlm::tlm_phase bw_phase = tlm::BEGIN_RESP;
+    sc_time delay = SC_ZERO_TIME;
+    targ_socket[id]->nb_transport_bw(trans, bw_phase, delay);
+}
+
+
+void Channel::decodeTargets(tlm::tlm_generic_payload& trans, vector<int> & targets)
+{
+    Flit * flit = (Flit *) trans.get_data_ptr();
+
+    targets.clear();
+
+    if (flit->multicast.empty())
+    {
+	sc_dt::uint64 masked_address;
+	targets.push_back(decode_address(trans.get_address(), masked_address));
+	return;
+    }
+
+    for (unsigned int i = 0; i < hubs_id.size(); i++)
+    {
+	const vector<int> & nodes = GlobalParams::hub_configuration[hubs_id[i]].attachedNodes;
+
+	for (unsigned int j = 0; j < nodes.size(); j++)
+	    if (flit->multicast.contains(nodes[j]) && tile2Hub(nodes[j]) == hubs_id[i])
+	    {
+		targets.push_back(i);
+		break;
+	    }
+    }
+    assert(!targets.empty());
+}
+
+
+bool Channel::startTransmission(int id, tlm::tlm_generic_payload& trans, vector<int> & targets)
+{
+    decodeTargets(trans, targets);
+
+    for (unsigned int i = 0; i < targets.size(); i++)
+	if (targets[i] >= (int)init_socket.size())
+	    return false;
+
+    flits_transmitted++;
+
+    // the initiator waits for the receivers to be on, which then stay on
+    // until they receive the flit
+    if (GlobalParams::wireless_sleep_policy != SLEEP_NONE)
+	for (unsigned int i = 0; i < targets.size(); i++)
+	    hubs[targets[i]]->rx_sleep.request();
+
+    accountWirelessRxPower(id);
+
+    powerManager(targets,trans);
+
+    return true;
+}
+
+
+void Channel::buildErrorModel()
+{
+    const pair<double, double> & ber = GlobalParams::channel_configuration[local_id].ber;
+
+    flit_error.assign(tx_hubs_id.size(), vector<double>(hubs_id.size(), 0.0));
+    if (ber.first == 0 && ber.second == 0)
+	return;
+
+    // distances of the pairs of hubs, only needed for a range of rates
+    vector<vector<double> > distance(tx_hubs_id.size(), vector<double>(hubs_id.size(), 0.0));
+    double min_distance = 0, max_distance = 0;
+
+    if (ber.first != ber.second && GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	min_distance = NOT_VALID;
+	for (unsigned int i = 0; i < tx_hubs_id.size(); i++)
+	    for (unsigned int j = 0; j < hubs_id.size(); j++)
+	    {
+		double tx_x, tx_y, rx_x, rx_y;
+
+		if (tx_hubs_id[i] == hubs_id[j])
+		    continue;
+		hubPosition(tx_hubs_id[i], tx_x, tx_y);
+		hubPosition(hubs_id[j], rx_x, rx_y);
+		distance[i][j] = sqrt(pow(tx_x - rx_x, 2) + pow(tx_y - rx_y, 2));
+		if (min_distance == NOT_VALID || distance[i][j] < min_distance)
+		    min_distance = distance[i][j];
+		max_distance = max(max_distance, distance[i][j]);
+	    }
+    }
+
+    for (unsigned int i = 0; i < tx_hubs_id.size(); i++)
+	for (unsigned int j = 0; j < hubs_id.size(); j++)
+	{
+	    // without a range of distances every pair has the farthest rate
+	    double rate = ber.second;
+
+	    if (max_distance > min_distance)
+		rate = ber.first + (ber.second - ber.first) * (distance[i][j] - min_distance) / (max_distance - min_distance);
+	    flit_error[i][j] = 1.0 - pow(1.0 - rate, GlobalParams::flit_size);
+	}
+}
+
+
+bool Channel::isCorrupted(int id, const vector<int> & targets)
+{
+    if (flit_error.size() != tx_hubs_id.size())
+	buildErrorModel();
+
+    bool corrupted_flit = false;
+
+    // a multicast flit is only delivered if it is received correctly by
+    // all its targets
+    for (unsigned int i = 0; i < targets.size(); i++)
+    {
+	double p = flit_error[id][targets[i]];
+
+	if (p > 0 && rand() < p * (RAND_MAX + 1.0))
+	    corrupted_flit = true;
+    }
+
+    if (corrupted_flit)
+    {
+	corrupted++;
+	LOG << "CRC error of a flit of HUB_" << tx_hubs_id[id] << " on channel " << local_id << endl;
+    }
+
+    return corrupted_flit;
+}
+
+
+void Channel::deliver(const vector<int> & targets, tlm::tlm_generic_payload& trans)
+{
+    // a receiver not on when the flit arrives misses it, which is
+    // retransmitted once the receiver is woken up (the initiator accounts
+    // the wasted transmission)
+    if (GlobalParams::wireless_sleep_policy != SLEEP_NONE)
+    {
+	bool missed = false;
+
+	for (unsigned int i = 0; i < targets.size(); i++)
+	    if (!hubs[targets[i]]->rx_sleep.isOn())
+	    {
+		hubs[targets[i]]->rx_sleep.request();
+		missed = true;
+	    }
+	if (missed)
+	{
+	    LOG << "Receiver asleep on channel " << local_id << ", flit not delivered" << endl;
+	    return;
+	}
+    }
+
+    if (targets.size() > 1)
+	for (unsigned int i = 0; i < targets.size(); i++)
+	{
+	    Hub * h = hubs[targets[i]];
+
+	    if (h->target[h->rx_index[local_id]]->buffer_rx.IsFull())
+	    {
+		LOG << "Antenna buffer of HUB_" << hubs_id[targets[i]] << " full, multicast flit not delivered" << endl;
+		return;
+	    }
+	}
+
     sc_dt::uint64 address = trans.get_address();
     sc_dt::uint64 masked_address;
-    unsigned int target_nr = decode_address( address, masked_address);
+    decode_address( address, masked_address);
 
-    if (target_nr < init_socket.size())
+    // Modify address within transaction
+    trans.set_address( masked_address );
+
+    // Forward transaction to appropriate targets (they do not wait)
+    for (unsigned int i = 0; i < targets.size(); i++)
     {
-	// Modify address within transaction
-	trans.set_address( masked_address );
+	sc_time delay = SC_ZERO_TIME;
+	init_socket[targets[i]]->b_transport(trans, delay);
+    }
 
+    // Replace original address
+    trans.set_address( address );
 
-	accountWirelessRxPower();
+    if (targets.size() > 1)
+    {
+	multicast_flits++;
+	multicast_deliveries += targets.size();
+    }
+}
 
-	powerManager(target_nr,trans);
 
-	// Realize the delay annotated onto the transport call
-	wait(delay);
+void Channel::checkCollisions(int id, const vector<int> & targets, tlm::tlm_generic_payload& trans)
+{
+    Transmission t;
+    t.trans = &trans;
+    t.start = sc_time_stamp();
+    t.tx_hub = tx_hubs_id[id];
+    t.targets = targets;
+    t.group = TokenRing::groupOf(local_id, t.tx_hub);
+    t.collided = false;
+    t.rx_busy = false;
+    for (unsigned int i = 0; i < targets.size(); i++)
+	if (rx_owner[targets[i]] != NOT_VALID && rx_owner[targets[i]] != t.tx_hub)
+	    t.rx_busy = true;
+
+    // the transmissions of a group are serialized by its token, unless
+    // with CSMA
+    for (unsigned int i = 0; i < in_flight.size(); i++)
+    {
+	Transmission & other = in_flight[i];
+
+	if ((mac_policy == MAC_CSMA || other.group != t.group) && interfere(t, other))
+	{
+	    LOG << "Collision of the transmissions of HUB_" << t.tx_hub << " and HUB_" << other.tx_hub << endl;
+	    other.collided = true;
+	    t.collided = true;
+	}
+    }
+
+    in_flight.push_back(t);
+}
+
+
+bool Channel::interfere(const Transmission & a, const Transmission & b) const
+{
+    for (unsigned int i = 0; i < a.targets.size(); i++)
+    {
+	if (find(b.targets.begin(), b.targets.end(), a.targets[i]) != b.targets.end() ||
+	    wirelessHeard(b.tx_hub, hubs_id[a.targets[i]]))
+	    return true;
+    }
+
+    for (unsigned int i = 0; i < b.targets.size(); i++)
+	if (wirelessHeard(a.tx_hub, hubs_id[b.targets[i]]))
+	    return true;
+
+    return false;
+}
+
+
+bool Channel::carrierBusy(int hub) const
+{
+    for (unsigned int i = 0; i < in_flight.size(); i++)
+	if (in_flight[i].start < sc_time_stamp() &&
+	    (in_flight[i].tx_hub == hub || wirelessHeard(in_flight[i].tx_hub, hub)))
+	    return true;
+
+    return false;
+}
+
+
+void Channel::updateReceiver(const Transmission & t)
+{
+    Flit * flit = (Flit *) t.trans->get_data_ptr();
+
+    // the flits of a bonded packet are reordered by the hub and do not
+    // lock the receiver
+    if (flit->bond_id != NOT_VALID)
+	return;
 
-	// Forward transaction to appropriate target
-	init_socket[target_nr]->b_transport(trans, delay);
+    for (unsigned int i = 0; i < t.targets.size(); i++)
+    {
+	int target_nr = t.targets[i];
 
+	if (flit->flit_type == FLIT_TYPE_HEAD)
+	{
+	    rx_owner[target_nr] = t.tx_hub;
+	    rx_open_packets[target_nr]++;
+	}
 
-	// Replace original address
-	trans.set_address( address );
+	if (flit->flit_type == FLIT_TYPE_TAIL && --rx_open_packets[target_nr] == 0)
+	    rx_owner[target_nr] = NOT_VALID;
     }
 }
 
 
-void Channel::accountWirelessRxPower()
+int Channel::getTokens() const
+{
+    if (mac_policy == MAC_CSMA)
+	return 0;
+
+    set<int> groups;
+    for (unsigned int i = 0; i < tx_hubs_id.size(); i++)
+	groups.insert(TokenRing::groupOf(local_id, tx_hubs_id[i]));
+    return groups.size();
+}
+
+
+void Channel::accountWirelessRxPower(int id)
 {
     for (unsigned int i = 0; i<hubs.size();i++)
     {
-	if (!GlobalParams::use_powermanager) 
-	    hubs[i]->power.wirelessDynamicRx();
-	else
-	if (!(hubs[i]->power.isSleeping()))
+	if (!wirelessHeard(tx_hubs_id[id], hubs_id[i]))
+	    continue;
+
+	if (!hubs[i]->rxSleeping())
 	    hubs[i]->power.wirelessDynamicRx();
     }
 }
 
 
-void Channel::powerManager(unsigned int hub_dst_index, tlm::tlm_generic_payload& trans)
+void Channel::powerManager(const vector<int> & targets, tlm::tlm_generic_payload& trans)
 {
     if (!GlobalParams::use_powermanager) return;
 
@@ -72,7 +427,7 @@ void Channel::powerManager(unsigned int hub_dst_index, tlm::tlm_generic_payload&
 	for (unsigned int i = 0; i<hubs.size();i++)
 	{
 
-	    if (i!=hub_dst_index) 
+	    if (find(targets.begin(), targets.end(), (int)i) == targets.end())
 	    {
 		hubs[i]->power.rxSleep(sleep_cycles);
 		LOG << " HUB_"<<hubs_id[i]<<" rxSleep() invoked with " << sleep_cycles << " cycles " << endl;
@@ -134,5 +489,12 @@ void Channel::addHub(Hub* h)
 
     hubs.push_back(h);
     hubs_id.push_back(h->getID());
+    rx_owner.push_back(NOT_VALID);
+    rx_open_packets.push_back(0);
+
+}
 
+void Channel::addTxHub(Hub* h)
+{
+    tx_hubs_id.push_back(h->getID());
 }
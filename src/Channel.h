@@ -20,6 +20,7 @@
 #include "tlm_utils/multi_passthrough_target_socket.h"
 #include "tlm_utils/peq_with_cb_and_phase.h"
 #include <queue>
+#include <set>
 
 using namespace sc_core;
 using namespace std;
@@ -39,6 +40,11 @@ struct Channel: sc_module
 
     void addHub(Hub*);
 
+    // hubs transmitting on the channel, in the order of targ_socket
+    vector<int> tx_hubs_id;
+
+    void addTxHub(Hub*);
+
 
   SC_HAS_PROCESS(Channel);
   // ***********************************************************
@@ -52,10 +58,25 @@ struct Channel: sc_module
   int local_id; // Unique ID
 
   Channel(sc_module_name nm, int id)
-  : sc_module(nm), targ_socket("targ_socket"), init_socket("init_socket")
+  : sc_module(nm), targ_socket("targ_socket"), init_socket("init_socket"), peq(this, &Channel::peq_cb)
   {
     local_id = id;
+    flits_transmitted = 0;
+    collisions = 0;
+    rx_busy = 0;
+    deferrals = 0;
+    busy_cycles = 0;
+    multicast_flits = 0;
+    multicast_deliveries = 0;
+    flits_delivered = 0;
+    corrupted = 0;
+    mac_policy = TokenRing::decodePolicy(GlobalParams::channel_configuration[local_id].macPolicy[0]);
+    // unless its hubs take turns on a single token, the transmissions on
+    // the channel are checked for collisions and the receivers locked
+    shared_access = wirelessReuse() || mac_policy == MAC_CSMA ||
+	mac_policy == MAC_TDMA || mac_policy == MAC_TDMA_WEIGHTED;
     targ_socket.register_b_transport(       this, &Channel::b_transport);
+    targ_socket.register_nb_transport_fw(   this, &Channel::nb_transport_fw);
     targ_socket.register_get_direct_mem_ptr(this, &Channel::get_direct_mem_ptr);
     targ_socket.register_transport_dbg(     this, &Channel::transport_dbg);
 
@@ -80,6 +101,12 @@ struct Channel: sc_module
   // Tagged TLM-2 blocking transport method
   virtual void b_transport( int id, tlm::tlm_generic_payload& trans, sc_time& delay );
 
+  // Tagged TLM-2 non-blocking transport method: the request is accepted
+  // right away (END_REQ), the flit is delivered to the target hub and the
+  // response (BEGIN_RESP) sent back after the transmission delay
+  virtual tlm::tlm_sync_enum nb_transport_fw( int id, tlm::tlm_generic_payload& trans,
+                                              tlm::tlm_phase& phase, sc_time& delay );
+
   // Tagged TLM-2 forward DMI method
   virtual bool get_direct_mem_ptr(int id,
                                   tlm::tlm_generic_payload& trans,
@@ -123,14 +150,89 @@ struct Channel: sc_module
 
   int getFlitTransmissionCycles() { return flit_transmission_cycles;}
 
+  // Tokens of the channel, one per reuse group of its transmitting hubs
+  int getTokens() const;
+
+  unsigned long flits_transmitted;	// flits whose transmission started
+  unsigned long collisions;		// flits lost for interference
+  unsigned long rx_busy;		// flits refused by a receiver busy with another transmitter
+  unsigned long deferrals;		// CSMA requests finding the carrier busy
+  unsigned long busy_cycles;		// transmitting flits delivered
+  unsigned long multicast_flits;	// multicast flits delivered
+  unsigned long multicast_deliveries;	// hubs they were delivered to
+  unsigned long flits_delivered;	// accepted by all their receivers
+  unsigned long corrupted;		// flits failing the CRC at a receiver
+
+  int getMacPolicy() const { return mac_policy; }
+
     private:
       int flit_transmission_cycles;
       int cc_flit_transmission_delay_ps; // clock compliant
-
-  std::map <tlm::tlm_generic_payload*, unsigned int> m_id_map;
-
-   void powerManager(unsigned int hub_dst_index, tlm::tlm_generic_payload& trans);
-   void accountWirelessRxPower();
+      int mac_policy;
+      bool shared_access;
+
+  std::map <tlm::tlm_generic_payload*, unsigned int> m_id_map;	// initiator of the transactions in flight
+
+  // With spatial reuse the hubs of different reuse groups transmit at
+  // the same time, with CSMA any two hubs: two overlapping transmissions
+  // collide, and are both lost, if they have a receiver in common or
+  // either transmitter is heard by a receiver of the other
+  struct Transmission {
+      tlm::tlm_generic_payload * trans;
+      sc_time start;
+      int tx_hub;
+      vector<int> targets;	// by target_nr, several for a multicast flit
+      int group;
+      bool collided;
+      bool rx_busy;
+  };
+  vector<Transmission> in_flight;
+
+  // A receiver completes the packets of a transmitter before accepting
+  // the flits of another one, by target_nr
+  vector<int> rx_owner;		// hub id, NOT_VALID if idle
+  vector<int> rx_open_packets;
+
+  // Adds a transmission to in_flight, marking the collisions
+  void checkCollisions(int id, const vector<int> & targets, tlm::tlm_generic_payload& trans);
+  bool interfere(const Transmission & a, const Transmission & b) const;
+
+  // CSMA: whether a hub senses a transmission, those started in the
+  // same cycle are not sensed yet
+  bool carrierBusy(int hub) const;
+
+  // Tracks the packets open at a receiver after a delivery
+  void updateReceiver(const Transmission & t);
+
+  // transactions in flight, until the end of their transmission
+  tlm_utils::peq_with_cb_and_phase<Channel> peq;
+  void peq_cb(tlm::tlm_generic_payload& trans, const tlm::tlm_phase& phase);
+
+  // Decodes the targets of a transaction: the hub addressed or, for a
+  // multicast flit, those of the nodes of its destination set
+  void decodeTargets(tlm::tlm_generic_payload& trans, vector<int> & targets);
+
+  // Decodes the targets of a transaction, accounting the power of the
+  // transmission, false if they are not attached to the channel
+  bool startTransmission(int id, tlm::tlm_generic_payload& trans, vector<int> & targets);
+
+  // Probability of a flit being corrupted, by targ_socket id and
+  // target_nr: the bit error rate of the pair of hubs, from the first
+  // (nearest pair of the channel) to the second (farthest pair) of the
+  // channel ber, over flit_size bits
+  vector<vector<double> > flit_error;
+  void buildErrorModel();
+
+  // Whether the CRC of a flit fails at any of its targets
+  bool isCorrupted(int id, const vector<int> & targets);
+
+  // A multicast flit is delivered to all its targets or, if the antenna
+  // buffer of any of them is full, to none
+  void deliver(const vector<int> & targets, tlm::tlm_generic_payload& trans);
+
+   void powerManager(const vector<int> & targets, tlm::tlm_generic_payload& trans);
+   // the hubs hearing the transmitter of targ_socket id
+   void accountWirelessRxPower(int id);
 
 };
 
@@ -9,11 +9,79 @@
  */
 
 #include "ConfigurationManager.h"
+#include "Utils.h"
 #include <systemc.h> //Included for the function time() 
 
 YAML::Node config;
 YAML::Node power_config;
 
+int parsePowerGating(const string & level)
+{
+    if (level == "NONE")
+	return PG_NONE;
+    if (level == "PORT")
+	return PG_PORT;
+    if (level == "ROUTER")
+	return PG_ROUTER;
+
+    cerr << "Error: invalid power gating level " << level << " (NONE, PORT or ROUTER)" << endl;
+    exit(1);
+}
+
+int parseWinocPathSelection(const string & policy)
+{
+    if (policy == "STATIC")
+	return WINOC_PATH_STATIC;
+    if (policy == "ADAPTIVE")
+	return WINOC_PATH_ADAPTIVE;
+
+    cerr << "Error: invalid wireless path selection " << policy << " (STATIC or ADAPTIVE)" << endl;
+    exit(1);
+}
+
+int parseHubSelection(const string & policy)
+{
+    if (policy == "PRIMARY")
+	return HUB_SELECTION_PRIMARY;
+    if (policy == "ROUND_ROBIN")
+	return HUB_SELECTION_ROUND_ROBIN;
+    if (policy == "ADAPTIVE")
+	return HUB_SELECTION_ADAPTIVE;
+
+    cerr << "Error: invalid hub selection " << policy << " (PRIMARY, ROUND_ROBIN or ADAPTIVE)" << endl;
+    exit(1);
+}
+
+int parseWirelessArq(const string & scheme)
+{
+    if (scheme == "NONE")
+	return ARQ_NONE;
+    if (scheme == "STOP_AND_WAIT")
+	return ARQ_STOP_AND_WAIT;
+    if (scheme == "GO_BACK_N")
+	return ARQ_GO_BACK_N;
+
+    cerr << "Error: invalid wireless ARQ scheme " << scheme << " (NONE, STOP_AND_WAIT or GO_BACK_N)" << endl;
+    exit(1);
+}
+
+int parseChannelSelection(const string & policy)
+{
+    if (policy == "RANDOM")
+	return CHSEL_RANDOM;
+    if (policy == "FIRST_FREE")
+	return CHSEL_FIRST_FREE;
+    if (policy == "LEAST_OCCUPIED")
+	return CHSEL_LEAST_OCCUPIED;
+    if (policy == "MIN_TOKEN_WAIT")
+	return CHSEL_MIN_TOKEN_WAIT;
+    if (policy == "DATA_RATE")
+	return CHSEL_DATA_RATE;
+
+    cerr << "Error: invalid channel selection " << policy << " (RANDOM, FIRST_FREE, LEAST_OCCUPIED, MIN_TOKEN_WAIT or DATA_RATE)" << endl;
+    exit(1);
+}
+
 void loadConfiguration() {
 
     cout << "Loading configuration from file \"" << GlobalParams::config_filename << "\"...";
@@ -46,6 +114,12 @@ void loadConfiguration() {
 
     // Initialize global configuration parameters (can be overridden with command-line arguments)
     GlobalParams::verbose_mode = readParam<string>(config, "verbose_mode");
+#ifdef DEBUG
+    GlobalParams::log_level = readParam<int>(config, "log_level", LOG_LEVEL_DEBUG);
+#else
+    GlobalParams::log_level = readParam<int>(config, "log_level", LOG_LEVEL_OFF);
+#endif
+    GlobalParams::log_module_levels = readParam<map<string, int> >(config, "log_modules", map<string, int>());
     GlobalParams::trace_mode = readParam<bool>(config, "trace_mode");
     GlobalParams::trace_filename = readParam<string>(config, "trace_filename");
 
@@ -88,10 +162,61 @@ void loadConfiguration() {
     GlobalParams::dyad_threshold = readParam<double>(config, "dyad_threshold");
     GlobalParams::max_volume_to_be_drained = readParam<unsigned int>(config, "max_volume_to_be_drained");
     //GlobalParams::hotspots;
+    GlobalParams::multicast_probability = readParam<double>(config, "multicast_probability", 0);
+    GlobalParams::multicast_size = readParam<int>(config, "multicast_size", 4);
     GlobalParams::show_buffer_stats = readParam<bool>(config, "show_buffer_stats");
+    GlobalParams::show_allocator_stats = readParam<bool>(config, "show_allocator_stats", false);
+    GlobalParams::latency_breakdown = readParam<bool>(config, "latency_breakdown", false);
     GlobalParams::use_winoc = readParam<bool>(config, "use_winoc");
     GlobalParams::winoc_dst_hops = readParam<int>(config, "winoc_dst_hops",0);
+    GlobalParams::winoc_tx_attenuation = readParam<bool>(config, "winoc_tx_attenuation", false);
+    GlobalParams::winoc_path_selection = parseWinocPathSelection(readParam<string>(config, "winoc_path_selection", "STATIC"));
+    GlobalParams::hub_selection = parseHubSelection(readParam<string>(config, "hub_selection", "PRIMARY"));
+    GlobalParams::channel_selection = parseChannelSelection(readParam<string>(config, "channel_selection", "RANDOM"));
+    GlobalParams::wireless_reuse_region = readParam<int>(config, "wireless_reuse_region", 0);
+    GlobalParams::wireless_interference_range = readParam<double>(config, "wireless_interference_range", 0);
+    GlobalParams::wireless_interference = readParam<vector<vector<int> > >(config, "wireless_interference", vector<vector<int> >());
+    GlobalParams::wireless_arq = parseWirelessArq(readParam<string>(config, "wireless_arq", "NONE"));
+    GlobalParams::wireless_arq_window = readParam<int>(config, "wireless_arq_window", 8);
+    GlobalParams::wireless_ack_cycles = readParam<int>(config, "wireless_ack_cycles", 2);
+    GlobalParams::wireless_bonding = readParam<int>(config, "wireless_bonding", 1);
     GlobalParams::use_powermanager = readParam<bool>(config, "use_wirxsleep");
+    GlobalParams::wireless_sleep_policy = readParam<string>(config, "wireless_sleep_policy", SLEEP_NONE);
+    GlobalParams::wireless_sleep_timeout = readParam<int>(config, "wireless_sleep_timeout", 20);
+    GlobalParams::wireless_sleep_history = readParam<int>(config, "wireless_sleep_history", 8);
+    GlobalParams::wireless_wakeup_latency = readParam<int>(config, "wireless_wakeup_latency", 10);
+    GlobalParams::wireless_wakeup_energy = readParam<double>(config, "wireless_wakeup_energy", 1.0e-10);
+    GlobalParams::profiling = readParam<bool>(config, "profiling", false);
+    GlobalParams::profile_interval = readParam<int>(config, "profile_interval", 1000);
+    GlobalParams::power_trace_mode = readParam<bool>(config, "power_trace_mode", false);
+    GlobalParams::power_trace_filename = readParam<string>(config, "power_trace_filename", "noxim.ptrace");
+    GlobalParams::power_trace_epoch = readParam<int>(config, "power_trace_epoch", 1000);
+    GlobalParams::power_trace_breakdown = readParam<bool>(config, "power_trace_breakdown", false);
+    GlobalParams::thermal_model = readParam<bool>(config, "thermal_model", false);
+    GlobalParams::thermal_ambient = readParam<double>(config, "thermal_ambient", 45.0);
+    GlobalParams::thermal_leakage_tref = readParam<double>(config, "thermal_leakage_tref", 45.0);
+    GlobalParams::thermal_leakage_beta = readParam<double>(config, "thermal_leakage_beta", 0.017);
+    GlobalParams::thermal_die_thickness = readParam<double>(config, "thermal_die_thickness", 0.15);
+    GlobalParams::thermal_conductivity = readParam<double>(config, "thermal_conductivity", 100.0);
+    GlobalParams::thermal_heat_capacity = readParam<double>(config, "thermal_heat_capacity", 1.75e6);
+    GlobalParams::thermal_vertical_resistance = readParam<double>(config, "thermal_vertical_resistance", 50.0);
+    GlobalParams::thermal_time_scale = readParam<double>(config, "thermal_time_scale", 1.0);
+    GlobalParams::power_gating = parsePowerGating(readParam<string>(config, "power_gating", "NONE"));
+    GlobalParams::pg_idle_threshold = readParam<int>(config, "pg_idle_threshold", 10);
+    GlobalParams::pg_wakeup_latency = readParam<int>(config, "pg_wakeup_latency", 8);
+    GlobalParams::pg_wakeup_energy = readParam<double>(config, "pg_wakeup_energy", 2.0e-11);
+    GlobalParams::pg_bypass = readParam<bool>(config, "pg_bypass", false);
+    GlobalParams::dvfs_policy = readParam<string>(config, "dvfs_policy", DVFS_NONE);
+    GlobalParams::dvfs_epoch = readParam<int>(config, "dvfs_epoch", 1000);
+    GlobalParams::dvfs_region = readParam<int>(config, "dvfs_region", 1);
+    GlobalParams::dvfs_sync_latency = readParam<int>(config, "dvfs_sync_latency", 2);
+    GlobalParams::dvfs_static_level = readParam<int>(config, "dvfs_static_level", 0);
+    GlobalParams::dvfs_low_threshold = readParam<double>(config, "dvfs_low_threshold", 0.05);
+    GlobalParams::dvfs_high_threshold = readParam<double>(config, "dvfs_high_threshold", 0.2);
+    GlobalParams::payload_mode = readParam<string>(config, "payload_mode", PAYLOAD_NONE);
+    GlobalParams::payload_bit_probability = readParam<double>(config, "payload_bit_probability", 0.5);
+    GlobalParams::payload_toggle_probability = readParam<double>(config, "payload_toggle_probability", 0.1);
+    GlobalParams::payload_trace_filename = readParam<string>(config, "payload_trace_filename", "");
     
 
     set<int> channelSet;
@@ -193,6 +318,8 @@ void showHelp(char selfname[])
          << "\t-config\t\t\tLoad the specified configuration file" << endl
          << "\t-power\t\t\tLoad the specified power configurations file" << endl
          << "\t-verbose N\t\tVerbosity level (1=low, 2=medium, 3=high)" << endl
+         << "\t-log N\t\t\tLog level of all modules (0=off, 1=error, 2=warning, 3=info, 4=debug)" << endl
+         << "\t-log_module NAME N      Log level N for module NAME and its submodules (e.g. Hub_0)" << endl
          << "\t-trace FILENAME\t\tTrace signals to a VCD file named 'FILENAME.vcd'" << endl
          << "\t-dimx N\t\t\tSet the mesh X dimension" << endl
          << "\t-dimy N\t\t\tSet the mesh Y dimension" << endl
@@ -204,6 +331,42 @@ void showHelp(char selfname[])
          << "\t-winoc\t\t\tEnable radio hub wireless transmission" << endl
          << "\t-winoc_dst_hops\t\t\tMax number of hops between target RadioHub and destination node" << endl
          << "\t-wirxsleep\t\tEnable radio hub wireless power manager" << endl
+         << "\t-wisleep POLICY\t\tTurn the idle radio hub transceivers off (any MAC and number of VCs), where POLICY is one of the following:" << endl
+         << "\t\tTIMEOUT\t\tAfter -wisleep_timeout idle cycles" << endl
+         << "\t\tPREDICTIVE\tAt once when the idle period predicted from the last ones exceeds the break-even time, waking up in advance" << endl
+         << "\t-wisleep_timeout N\tIdle cycles before turning a transceiver off (default 20)" << endl
+         << "\t-wisleep_history N\tIdle periods considered by the PREDICTIVE policy (default 8)" << endl
+         << "\t-wiwakeup N E\t\tWake-up latency [cycles] and energy [J] of a transceiver" << endl
+         << "\t-winoc_attenuation\tScale the transmit energy by the attenuation [dB] of tx_attenuation_map in the power file" << endl
+         << "\t-winoc_path POLICY\tChoose between the radio hub and the wired network, where POLICY is one of the following:" << endl
+         << "\t\tSTATIC\t\tRadio hub whenever it reaches the destination (default)" << endl
+         << "\t\tADAPTIVE\tRadio hub only if its estimated latency (token wait, antenna queue) is lower than the wired one (hops, congestion)" << endl
+         << "\t-hubsel POLICY\t\tSelect the hub of a tile attached to several ones, where POLICY is one of the following:" << endl
+         << "\t\tPRIMARY\t\tLowest id hub reaching the destination hub (default)" << endl
+         << "\t\tROUND_ROBIN\tEach hub in turn, a packet each" << endl
+         << "\t\tADAPTIVE\tLeast expected latency (hub buffers, token wait, antenna queue)" << endl
+         << "\t-chsel POLICY\t\tSelect the radio channel among those reaching the destination hub, where POLICY is one of the following:" << endl
+         << "\t\tRANDOM\t\tRandom channel (default)" << endl
+         << "\t\tFIRST_FREE\tFirst channel without a packet in progress, from a random one" << endl
+         << "\t\tLEAST_OCCUPIED\tFewest flits in the antenna TX buffer" << endl
+         << "\t\tMIN_TOKEN_WAIT\tShortest expected token wait plus antenna TX queue" << endl
+         << "\t\tDATA_RATE\tRandom channel, weighted by its data rate" << endl
+         << "\t-wireuse N\t\tSplit the hubs of each radio channel in square regions of N tiles per side, each with its own token" << endl
+         << "\t-wirange R\t\tInterference range of the radio hubs [tiles] (default 0, the whole chip)" << endl
+         << "\t-mac POLICY [ARGS]\tSet the mac_policy of all the radio channels, where POLICY [ARGS] is one of the following:" << endl
+         << "\t\tTOKEN_PACKET\tToken released at the end of each packet" << endl
+         << "\t\tTOKEN_HOLD N\tToken held for N cycles" << endl
+         << "\t\tTOKEN_MAX_HOLD N\tToken held while transmitting, up to N cycles" << endl
+         << "\t\tTDMA N\t\tRound robin slots of N cycles" << endl
+         << "\t\tTDMA_WEIGHTED N M\tFrames of M slots of N cycles, shared by the demand of the last frame" << endl
+         << "\t\tCSMA\t\tCarrier sense with random backoff, no token" << endl
+         << "\t-wiber BER\t\tSet the bit error rate of all the radio channels" << endl
+         << "\t-wiarq SCHEME [W]\tRetransmit the flits corrupted on the radio channels, where SCHEME [W] is one of the following:" << endl
+         << "\t\tNONE\t\tError-free radio channels (default)" << endl
+         << "\t\tSTOP_AND_WAIT\tEach flit waits for its acknowledgement" << endl
+         << "\t\tGO_BACK_N W\tUp to W flits waiting for acknowledgement, resent from the corrupted one" << endl
+         << "\t-wiack N\t\tCycles for the acknowledgement of a flit to reach the transmitter (default 2)" << endl
+         << "\t-wibond N\t\tStripe the flits of a packet over up to N radio channels reaching its hub (default 1)" << endl
          << "\t-size Nmin Nmax\t\tSet the minimum and maximum packet size [flits]" << endl
          << "\t-flit N\t\t\tSet the flit size [bit]" << endl
          << "\t-topology TYPE\t\tSet the topology to one of the following:" << endl
@@ -239,14 +402,45 @@ void showHelp(char selfname[])
          << "\t\tshuffle\t\tShuffle traffic distribution" << endl
          <<	"\t\ttable FILENAME\tTraffic Table Based traffic distribution with table in the specified file" << endl
          << "\t-hs ID P\t\tAdd node ID to hotspot nodes, with percentage P (0..1) (Only for 'random' traffic)" << endl
+         << "\t-multicast P N\t\tMake a fraction P (0..1) of the packets multicast to N random nodes" << endl
          << "\t-warmup N\t\tStart to collect statistics after N cycles" << endl
          << "\t-seed N\t\t\tSet the seed of the random generator (default time())" << endl
          << "\t-detailed\t\tShow detailed statistics" << endl
          << "\t-show_buf_stats\t\tShow buffers statistics" << endl
+         << "\t-show_alloc_stats\tShow allocation and contention statistics of the routers" << endl
+         << "\t-latency_breakdown\tShow the per-hop decomposition of the packet latency" << endl
          << "\t-volume N\t\tStop the simulation when either the maximum number of cycles has been reached or N flits have" << endl
          << "\t\t\t\tbeen delivered" << endl
          << "\t-asciimonitor\t\tShow status of the network while running (experimental)" << endl
          << "\t-sim N\t\t\tRun for the specified simulation time [cycles]" << endl
+         << "\t-profile\t\tReport host time spent in each simulation process type" << endl
+         << "\t-profile_interval N     Sample the simulation speed every N cycles when profiling" << endl
+         << "\t-power_trace FILENAME\tWrite the per-epoch power of each router and hub to FILENAME (ptrace format)" << endl
+         << "\t-power_trace_epoch N\tLength of the power trace epoch [cycles] (default 1000)" << endl
+         << "\t-power_trace_breakdown\tSplit each power trace unit into buffer, logic, link, ni and wireless columns" << endl
+         << "\t-thermal\t\tUpdate the tile temperatures every power trace epoch and scale the leakage accordingly" << endl
+         << "\t-thermal_ambient T\tAmbient temperature [C] (default 45)" << endl
+         << "\t-thermal_time_scale N\tThermal time elapsing per simulated time, to reach the steady state in short runs" << endl
+         << "\t-power_gating LEVEL\tGate idle router blocks, where LEVEL is one of the following:" << endl
+         << "\t\tNONE\t\tNo power gating (default)" << endl
+         << "\t\tPORT\t\tInput port buffers" << endl
+         << "\t\tROUTER\t\tInput port buffers and, when all of them are gated, router logic" << endl
+         << "\t-pg_idle N\t\tIdle cycles before gating a block (default 10)" << endl
+         << "\t-pg_wakeup N E\t\tWake-up latency [cycles] and energy [J] of a gated block" << endl
+         << "\t-pg_bypass\t\tForward transit flits across gated routers without waking them up" << endl
+         << "\t-dvfs POLICY\t\tScale the voltage/frequency of the routers (levels in the power file), where POLICY is one of the following:" << endl
+         << "\t\tNONE\t\tAlways at the nominal level (default)" << endl
+         << "\t\tSTATIC\t\tAlways at level dvfs_static_level" << endl
+         << "\t\tBUFFER_OCCUPANCY\tFrom the average input buffer occupancy" << endl
+         << "\t\tLINK_UTILIZATION\tFrom the flits forwarded per output port" << endl
+         << "\t-dvfs_epoch N\t\tCycles between two DVFS decisions (default 1000)" << endl
+         << "\t-dvfs_region N\t\tSide of the square regions of tiles sharing a level (default 1)" << endl
+         << "\t-dvfs_sync N\t\tSynchronizer latency [router cycles] between routers at different levels (default 2)" << endl
+         << "\t-payload MODE\t\tFill the flits with data and evaluate link and buffer energy from the bits toggling, where MODE is one of the following:" << endl
+         << "\t\tNONE\t\tNo data, fixed energy per flit (default)" << endl
+         << "\t\tRANDOM P\tEach bit set with probability P" << endl
+         << "\t\tCORRELATED P\tEach bit of the previous flit of the PE toggled with probability P" << endl
+         << "\t\tTRACE FILENAME\tFlits read from FILENAME, one hexadecimal word per line" << endl
          << endl
          << "If you find this program useful please don't forget to mention in your paper Maurizio Palesi <maurizio.palesi@unikore.it>" << endl
          <<	"If you find this program useless please feel free to complain with Davide Patti <davide.patti@dieei.unict.it>" << endl
@@ -258,6 +452,7 @@ void showConfig()
 {
     cout << "Using the following configuration: " << endl
          << "- verbose_mode = " << GlobalParams::verbose_mode << endl
+         << "- log_level = " << GlobalParams::log_level << endl
          << "- trace_mode = " << GlobalParams::trace_mode << endl
       // << "- trace_filename = " << GlobalParams::trace_filename << endl
          << "- mesh_dim_x = " << GlobalParams::mesh_dim_x << endl
@@ -329,6 +524,104 @@ void checkConfiguration()
 		}
 	}
 
+    if (GlobalParams::winoc_path_selection == WINOC_PATH_ADAPTIVE && !GlobalParams::use_winoc) {
+	cerr << "Error: -winoc_path ADAPTIVE makes sense only when -winoc is enabled!" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::hub_selection != HUB_SELECTION_PRIMARY && !GlobalParams::use_winoc) {
+	cerr << "Error: -hubsel makes sense only when -winoc is enabled!" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::use_winoc) {
+	map<int, int> links;
+
+	for (map<int, HubConfig>::iterator it = GlobalParams::hub_configuration.begin();
+	     it != GlobalParams::hub_configuration.end(); ++it)
+	    for (unsigned int i = 0; i < it->second.attachedNodes.size(); i++)
+		if (++links[it->second.attachedNodes[i]] > 1 && GlobalParams::topology != TOPOLOGY_MESH) {
+		    cerr << "Error: tiles attached to several hubs are only supported in MESH topology" << endl;
+		    exit(1);
+		}
+
+	for (map<int, int>::iterator it = links.begin(); it != links.end(); ++it)
+	    if (it->second > MAX_HUB_LINKS) {
+		cerr << "Error: tile " << it->first << " cannot be attached to more than " << MAX_HUB_LINKS << " hubs." << endl
+		     << "If you need more please modify the MAX_HUB_LINKS definition in " << endl
+		     << "GlobalParams.h and compile again " << endl;
+		exit(1);
+	    }
+    }
+
+    if (GlobalParams::wireless_reuse_region < 0 || GlobalParams::wireless_interference_range < 0) {
+	cerr << "Error: wireless reuse region and interference range must be >= 0" << endl;
+	exit(1);
+    }
+
+    if ((GlobalParams::wireless_reuse_region > 0 || GlobalParams::wireless_interference_range > 0) &&
+	GlobalParams::topology != TOPOLOGY_MESH) {
+	cerr << "Error: wireless reuse regions and interference range are only supported in MESH topology" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::use_powermanager && wirelessReuse()) {
+	cerr << "Error: Power manager (-wirxsleep) option does not support spatial reuse of the radio channels" << endl;
+	exit(1);
+    }
+
+    for (map<int, ChannelConfig>::iterator it = GlobalParams::channel_configuration.begin();
+	 it != GlobalParams::channel_configuration.end(); ++it) {
+	const vector<string> & mac = it->second.macPolicy;
+	string policy = mac.empty() ? "" : mac[0];
+	unsigned int n_args = 1;
+
+	if (policy == TOKEN_HOLD || policy == TOKEN_MAX_HOLD || policy == TDMA)
+	    n_args = 2;
+	else if (policy == TDMA_WEIGHTED)
+	    n_args = 3;
+	else if (policy != TOKEN_PACKET && policy != CSMA) {
+	    cerr << "Error: invalid mac_policy " << policy << " of radio channel " << it->first << endl;
+	    exit(1);
+	}
+	if (mac.size() < n_args) {
+	    cerr << "Error: mac_policy " << policy << " of radio channel " << it->first << " requires " << n_args - 1 << " cycle parameter(s)" << endl;
+	    exit(1);
+	}
+	if (policy == TDMA || policy == TDMA_WEIGHTED) {
+	    // a packet is only started if it fits in the rest of the slot
+	    int cycles = arqFlitCycles(ceil(1000.0 * GlobalParams::flit_size / it->second.dataRate / GlobalParams::clock_period_ps));
+	    if (atoi(mac[1].c_str()) < cycles * GlobalParams::max_packet_size) {
+		cerr << "Error: the TDMA slots of radio channel " << it->first << " must fit a packet of " << GlobalParams::max_packet_size << " flits (" << cycles * GlobalParams::max_packet_size << " cycles)" << endl;
+		exit(1);
+	    }
+	}
+	if (policy != TOKEN_PACKET && GlobalParams::use_powermanager) {
+	    cerr << "Error: Power manager (-wirxsleep) option only supports the TOKEN_PACKET mac_policy" << endl;
+	    exit(1);
+	}
+	const pair<double, double> & ber = it->second.ber;
+	if (ber.first < 0 || ber.first >= 1 || ber.second < 0 || ber.second >= 1) {
+	    cerr << "Error: the bit error rate of radio channel " << it->first << " must be in [0,1)" << endl;
+	    exit(1);
+	}
+	if ((ber.first > 0 || ber.second > 0) && GlobalParams::use_winoc &&
+	    GlobalParams::wireless_arq == ARQ_NONE) {
+	    cerr << "Error: radio channel " << it->first << " has a bit error rate, an ARQ scheme (-wiarq) is required" << endl;
+	    exit(1);
+	}
+    }
+
+    if (GlobalParams::wireless_arq_window < 1 || GlobalParams::wireless_ack_cycles < 0) {
+	cerr << "Error: the ARQ window must be >= 1 and the acknowledgement cycles >= 0" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::wireless_bonding < 1) {
+	cerr << "Error: the channels bonded by a packet must be >= 1" << endl;
+	exit(1);
+    }
+
     if (GlobalParams::buffer_depth < 1) {
 	cerr << "Error: buffer must be >= 1" << endl;
 	exit(1);
@@ -390,6 +683,25 @@ void checkConfiguration()
 	}
     }
 
+    if (GlobalParams::multicast_probability < 0 || GlobalParams::multicast_probability > 1) {
+	cerr << "Error: multicast probability must be in the interval [0,1]" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::multicast_probability > 0) {
+	int n_nodes = (GlobalParams::topology == TOPOLOGY_MESH) ?
+	    GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y : GlobalParams::n_delta_tiles;
+
+	if (n_nodes > MAX_MULTICAST_NODES) {
+	    cerr << "Error: multicast packets can address at most " << MAX_MULTICAST_NODES << " nodes" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::multicast_size < 1 || GlobalParams::multicast_size > n_nodes - 1) {
+	    cerr << "Error: multicast size must be in the interval [1," << n_nodes - 1 << "]" << endl;
+	    exit(1);
+	}
+    }
+
     if (GlobalParams::stats_warm_up_time < 0) {
 	cerr << "Error: warm-up time must be positive" << endl;
 	exit(1);
@@ -411,6 +723,85 @@ void checkConfiguration()
 	exit(1);
     }
 
+    if (GlobalParams::profile_interval <= 0) {
+	cerr << "Error: profile interval must be > 0" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::power_trace_epoch <= 0) {
+	cerr << "Error: power trace epoch must be > 0" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::pg_idle_threshold <= 0 || GlobalParams::pg_wakeup_latency < 0 ||
+	GlobalParams::pg_wakeup_energy < 0) {
+	cerr << "Error: power gating idle threshold must be > 0, wake-up latency and energy >= 0" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::pg_bypass && GlobalParams::power_gating != PG_ROUTER) {
+	cerr << "Error: the bypass of gated routers requires ROUTER power gating" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::dvfs_mode) {
+	if (GlobalParams::topology != TOPOLOGY_MESH) {
+	    cerr << "Error: DVFS is only available for the mesh topology" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::power_configuration.dvfs_levels.empty()) {
+	    cerr << "Error: DVFS requires the DVFS levels in the power configuration file" << endl;
+	    exit(1);
+	}
+	for (unsigned int i = 0; i < GlobalParams::power_configuration.dvfs_levels.size(); i++)
+	    if (GlobalParams::power_configuration.dvfs_levels[i].first <= 0 ||
+		GlobalParams::power_configuration.dvfs_levels[i].first > 1 ||
+		GlobalParams::power_configuration.dvfs_levels[i].second <= 0) {
+		cerr << "Error: DVFS frequency ratios must be in (0,1] and voltages > 0" << endl;
+		exit(1);
+	    }
+	if (GlobalParams::dvfs_epoch <= 0 || GlobalParams::dvfs_region <= 0 ||
+	    GlobalParams::dvfs_sync_latency < 0 || GlobalParams::dvfs_static_level < 0) {
+	    cerr << "Error: DVFS epoch and region must be > 0, synchronizer latency and static level >= 0" << endl;
+	    exit(1);
+	}
+    }
+
+    if (GlobalParams::payload_mode != PAYLOAD_NONE && GlobalParams::payload_mode != PAYLOAD_RANDOM &&
+	GlobalParams::payload_mode != PAYLOAD_CORRELATED && GlobalParams::payload_mode != PAYLOAD_TRACE) {
+	cerr << "Error: invalid payload mode " << GlobalParams::payload_mode << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::payload_energy) {
+	if (GlobalParams::flit_size > MAX_FLIT_SIZE) {
+	    cerr << "Error: flits carrying a payload must be at most " << MAX_FLIT_SIZE << " bits" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::payload_bit_probability < 0 || GlobalParams::payload_bit_probability > 1 ||
+	    GlobalParams::payload_toggle_probability < 0 || GlobalParams::payload_toggle_probability > 1) {
+	    cerr << "Error: payload probabilities must be in [0,1]" << endl;
+	    exit(1);
+	}
+	if (GlobalParams::payload_mode == PAYLOAD_TRACE && GlobalParams::payload_trace_filename.empty()) {
+	    cerr << "Error: the TRACE payload mode requires a trace file" << endl;
+	    exit(1);
+	}
+    }
+
+    if (GlobalParams::thermal_model && GlobalParams::topology != TOPOLOGY_MESH) {
+	cerr << "Error: the thermal model is only available for the mesh topology" << endl;
+	exit(1);
+    }
+
+    if (GlobalParams::thermal_model &&
+	(GlobalParams::thermal_die_thickness <= 0 || GlobalParams::thermal_conductivity <= 0 ||
+	 GlobalParams::thermal_heat_capacity <= 0 || GlobalParams::thermal_vertical_resistance <= 0 ||
+	 GlobalParams::thermal_time_scale <= 0)) {
+	cerr << "Error: thermal model parameters must be > 0" << endl;
+	exit(1);
+    }
+
     if (GlobalParams::locality<0 || GlobalParams::locality>1)
     {
 	cerr << "Error: traffic locality must be in the range 0..1" << endl;
@@ -436,18 +827,38 @@ void checkConfiguration()
 	     << "GlobalParams.h and compile again " << endl;
 	exit(1);
     }
-    if (GlobalParams::n_virtual_channels>1 && GlobalParams::use_powermanager)
+    if (GlobalParams::use_powermanager && GlobalParams::wireless_sleep_policy != SLEEP_NONE)
     {
-	cerr << "Error: Power manager (-wirxsleep) option only supports a single virtual channel" << endl;
+	cerr << "Error: Power manager (-wirxsleep) and transceiver sleep policy (-wisleep) are alternative" << endl;
+	exit(1);
+    }
+    if (GlobalParams::wireless_sleep_timeout < 0 || GlobalParams::wireless_sleep_history < 1 ||
+	GlobalParams::wireless_wakeup_latency < 0 || GlobalParams::wireless_wakeup_energy < 0)
+    {
+	cerr << "Error: sleep timeout, wake-up latency and energy must be >= 0, sleep history >= 1" << endl;
 	exit(1);
     }
 
-    if (GlobalParams::ascii_monitor)
+    if (GlobalParams::log_level < LOG_LEVEL_OFF || GlobalParams::log_level > LOG_LEVEL_DEBUG)
     {
-#ifdef DEBUG
-	cerr << "-ascii_monitor option need DEBUG flag to be disabled in Makefile " << endl;
+	cerr << "Error: log level must be in the range " << LOG_LEVEL_OFF << ".." << LOG_LEVEL_DEBUG << endl;
+	exit(1);
+    }
+
+    for (map<string, int>::iterator it = GlobalParams::log_module_levels.begin();
+	 it != GlobalParams::log_module_levels.end(); it++)
+    {
+	if (it->second < LOG_LEVEL_OFF || it->second > LOG_LEVEL_DEBUG)
+	{
+	    cerr << "Error: log level of module " << it->first << " must be in the range " << LOG_LEVEL_OFF << ".." << LOG_LEVEL_DEBUG << endl;
+	    exit(1);
+	}
+    }
+
+    if (GlobalParams::ascii_monitor && GlobalParams::log_level_max > LOG_LEVEL_OFF)
+    {
+	cerr << "-ascii_monitor option cannot be used while logging is enabled (-log, -log_module)" << endl;
 	exit(1);
-#endif
     }
 }
 
@@ -463,6 +874,13 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	{
 	    if (!strcmp(arg_vet[i], "-verbose"))
 		GlobalParams::verbose_mode = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-log"))
+		GlobalParams::log_level = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-log_module"))
+	    {
+		string module = arg_vet[++i];
+		GlobalParams::log_module_levels[module] = atoi(arg_vet[++i]);
+	    }
 	    else if (!strcmp(arg_vet[i], "-trace")) 
 	    {
 		GlobalParams::trace_mode = true;
@@ -498,6 +916,60 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 	    {
 		GlobalParams::use_powermanager = true;
 	    }
+	    else if (!strcmp(arg_vet[i], "-wisleep"))
+		GlobalParams::wireless_sleep_policy = arg_vet[++i];
+	    else if (!strcmp(arg_vet[i], "-wisleep_timeout"))
+		GlobalParams::wireless_sleep_timeout = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-wisleep_history"))
+		GlobalParams::wireless_sleep_history = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-wiwakeup"))
+	    {
+		GlobalParams::wireless_wakeup_latency = atoi(arg_vet[++i]);
+		GlobalParams::wireless_wakeup_energy = atof(arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-winoc_attenuation"))
+		GlobalParams::winoc_tx_attenuation = true;
+	    else if (!strcmp(arg_vet[i], "-winoc_path"))
+		GlobalParams::winoc_path_selection = parseWinocPathSelection(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-hubsel"))
+		GlobalParams::hub_selection = parseHubSelection(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-chsel"))
+		GlobalParams::channel_selection = parseChannelSelection(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-wireuse"))
+		GlobalParams::wireless_reuse_region = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-wirange"))
+		GlobalParams::wireless_interference_range = atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-mac"))
+	    {
+		vector<string> mac(1, arg_vet[++i]);
+		int n_args = 0;
+		if (mac[0] == TOKEN_HOLD || mac[0] == TOKEN_MAX_HOLD || mac[0] == TDMA)
+		    n_args = 1;
+		else if (mac[0] == TDMA_WEIGHTED)
+		    n_args = 2;
+		for (int j = 0; j < n_args && i + 1 < arg_num; j++)
+		    mac.push_back(arg_vet[++i]);
+		for (map<int, ChannelConfig>::iterator it = GlobalParams::channel_configuration.begin();
+		     it != GlobalParams::channel_configuration.end(); ++it)
+		    it->second.macPolicy = mac;
+	    }
+	    else if (!strcmp(arg_vet[i], "-wiber"))
+	    {
+		double ber = atof(arg_vet[++i]);
+		for (map<int, ChannelConfig>::iterator it = GlobalParams::channel_configuration.begin();
+		     it != GlobalParams::channel_configuration.end(); ++it)
+		    it->second.ber = make_pair(ber, ber);
+	    }
+	    else if (!strcmp(arg_vet[i], "-wiarq"))
+	    {
+		GlobalParams::wireless_arq = parseWirelessArq(arg_vet[++i]);
+		if (GlobalParams::wireless_arq == ARQ_GO_BACK_N && i + 1 < arg_num)
+		    GlobalParams::wireless_arq_window = atoi(arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-wiack"))
+		GlobalParams::wireless_ack_cycles = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-wibond"))
+		GlobalParams::wireless_bonding = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-size")) 
 	    {
 		GlobalParams::min_packet_size = atoi(arg_vet[++i]);
@@ -586,14 +1058,23 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		pair < int, double >t(node, percentage);
 		GlobalParams::hotspots.push_back(t);
 	    } 
+	    else if (!strcmp(arg_vet[i], "-multicast"))
+	    {
+		GlobalParams::multicast_probability = atof(arg_vet[++i]);
+		GlobalParams::multicast_size = atoi(arg_vet[++i]);
+	    }
 	    else if (!strcmp(arg_vet[i], "-warmup"))
 		GlobalParams::stats_warm_up_time = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-seed"))
 		GlobalParams::rnd_generator_seed = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-detailed"))
 		GlobalParams::detailed = true;
+	    else if (!strcmp(arg_vet[i], "-latency_breakdown"))
+		GlobalParams::latency_breakdown = true;
 	    else if (!strcmp(arg_vet[i], "-show_buf_stats"))
 		GlobalParams::show_buffer_stats = true;
+	    else if (!strcmp(arg_vet[i], "-show_alloc_stats"))
+		GlobalParams::show_allocator_stats = true;
 	    else if (!strcmp(arg_vet[i], "-volume"))
 		GlobalParams::max_volume_to_be_drained =
 		    atoi(arg_vet[++i]);
@@ -601,6 +1082,54 @@ void parseCmdLine(int arg_num, char *arg_vet[])
 		GlobalParams::simulation_time = atoi(arg_vet[++i]);
 	    else if (!strcmp(arg_vet[i], "-asciimonitor")) 
 		GlobalParams::ascii_monitor = true;
+	    else if (!strcmp(arg_vet[i], "-profile"))
+		GlobalParams::profiling = true;
+	    else if (!strcmp(arg_vet[i], "-profile_interval"))
+		GlobalParams::profile_interval = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-power_trace"))
+	    {
+		GlobalParams::power_trace_mode = true;
+		GlobalParams::power_trace_filename = arg_vet[++i];
+	    }
+	    else if (!strcmp(arg_vet[i], "-power_trace_epoch"))
+		GlobalParams::power_trace_epoch = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-power_trace_breakdown"))
+		GlobalParams::power_trace_breakdown = true;
+	    else if (!strcmp(arg_vet[i], "-thermal"))
+		GlobalParams::thermal_model = true;
+	    else if (!strcmp(arg_vet[i], "-thermal_ambient"))
+		GlobalParams::thermal_ambient = atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-thermal_time_scale"))
+		GlobalParams::thermal_time_scale = atof(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-power_gating"))
+		GlobalParams::power_gating = parsePowerGating(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-pg_idle"))
+		GlobalParams::pg_idle_threshold = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-pg_wakeup"))
+	    {
+		GlobalParams::pg_wakeup_latency = atoi(arg_vet[++i]);
+		GlobalParams::pg_wakeup_energy = atof(arg_vet[++i]);
+	    }
+	    else if (!strcmp(arg_vet[i], "-pg_bypass"))
+		GlobalParams::pg_bypass = true;
+	    else if (!strcmp(arg_vet[i], "-dvfs"))
+		GlobalParams::dvfs_policy = arg_vet[++i];
+	    else if (!strcmp(arg_vet[i], "-dvfs_epoch"))
+		GlobalParams::dvfs_epoch = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-dvfs_region"))
+		GlobalParams::dvfs_region = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-dvfs_sync"))
+		GlobalParams::dvfs_sync_latency = atoi(arg_vet[++i]);
+	    else if (!strcmp(arg_vet[i], "-payload"))
+	    {
+		GlobalParams::payload_mode = arg_vet[++i];
+		if (GlobalParams::payload_mode == PAYLOAD_RANDOM)
+		    GlobalParams::payload_bit_probability = atof(arg_vet[++i]);
+		else if (GlobalParams::payload_mode == PAYLOAD_CORRELATED)
+		    GlobalParams::payload_toggle_probability = atof(arg_vet[++i]);
+		else if (GlobalParams::payload_mode == PAYLOAD_TRACE)
+		    GlobalParams::payload_trace_filename = arg_vet[++i];
+	    }
 	    else if (!strcmp(arg_vet[i], "-config") || !strcmp(arg_vet[i], "-power"))
 		// -config is managed from configure function
 		// i++ skips the configuration file name 
@@ -670,6 +1199,16 @@ void configure(int arg_num, char *arg_vet[]) {
     loadConfiguration();
     parseCmdLine(arg_num, arg_vet);
 
+    // Highest log level used by any module, checked by LOG_AT before
+    // looking up the level of the single module
+    GlobalParams::log_level_max = GlobalParams::log_level;
+    for (map<string, int>::iterator it = GlobalParams::log_module_levels.begin();
+	 it != GlobalParams::log_module_levels.end(); it++)
+	GlobalParams::log_level_max = max(GlobalParams::log_level_max, it->second);
+
+    GlobalParams::dvfs_mode = (GlobalParams::dvfs_policy != DVFS_NONE);
+    GlobalParams::payload_energy = (GlobalParams::payload_mode != PAYLOAD_NONE);
+
     checkConfiguration();
 
     // Show configuration
@@ -64,6 +64,7 @@ namespace YAML {
             node["ber"] = channelConfig.ber;
             node["data_rate"] = channelConfig.dataRate;
             node["mac_policy"] = channelConfig.macPolicy;
+            node["reuse_groups"] = channelConfig.reuseGroups;
             return node;
         }
 
@@ -71,6 +72,7 @@ namespace YAML {
             channelConfig.ber = node["ber"].as<pair<double, double> >(GlobalParams::default_channel_configuration.ber);
             channelConfig.dataRate = node["data_rate"].as<int>(GlobalParams::default_channel_configuration.dataRate);
             channelConfig.macPolicy = node["mac_policy"].as<vector<string> >(GlobalParams::default_channel_configuration.macPolicy);
+            channelConfig.reuseGroups = node["reuse_groups"].as<vector<vector<int> > >(GlobalParams::default_channel_configuration.reuseGroups);
             return true;
         }
     };
@@ -178,6 +180,9 @@ namespace YAML {
             powerConfig.linkBitLinePowerConfig = node["LinkBitLine"].as<LinkBitLinePowerConfig>();
             powerConfig.routerPowerConfig = node["Router"].as<RouterPowerConfig>();
             powerConfig.hubPowerConfig = node["Hub"].as<HubPowerConfig>();
+            // [frequency ratio, voltage] of each level, nominal first
+            if (node["DVFS"].IsDefined())
+                powerConfig.dvfs_levels = node["DVFS"].as<vector<pair<double, double> > >();
             return true;
         }
     };
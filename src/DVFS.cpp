@@ -0,0 +1,197 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the router DVFS controller
+ */
+
+#include "DVFS.h"
+#include "Router.h"
+
+DVFSPoliciesMap * DVFSPolicies::dvfsPoliciesMap = 0;
+
+DVFSPolicy * DVFSPolicies::get(const string & dvfsPolicyName) {
+    DVFSPoliciesMap::iterator it = getDVFSPoliciesMap()->find(dvfsPolicyName);
+
+    if (it == getDVFSPoliciesMap()->end())
+	return 0;
+
+    return it->second;
+}
+
+DVFSPoliciesMap * DVFSPolicies::getDVFSPoliciesMap() {
+    if (dvfsPoliciesMap == 0)
+	dvfsPoliciesMap = new DVFSPoliciesMap();
+    return dvfsPoliciesMap;
+}
+
+// Keeps every region at dvfs_static_level
+class DVFS_STATIC : public DVFSPolicy {
+  public:
+    int selectLevel(const DVFSSample & sample, const int level, const int n_levels) {
+	return min(GlobalParams::dvfs_static_level, n_levels - 1);
+    }
+};
+
+// Steps the level up (slower) or down (faster) when the load falls below
+// dvfs_low_threshold or exceeds dvfs_high_threshold
+static int stepLevel(const double load, const int level, const int n_levels)
+{
+    if (load > GlobalParams::dvfs_high_threshold && level > 0)
+	return level - 1;
+    if (load < GlobalParams::dvfs_low_threshold && level < n_levels - 1)
+	return level + 1;
+    return level;
+}
+
+class DVFS_BUFFER_OCCUPANCY : public DVFSPolicy {
+  public:
+    int selectLevel(const DVFSSample & sample, const int level, const int n_levels) {
+	return stepLevel(sample.occupancy, level, n_levels);
+    }
+};
+
+class DVFS_LINK_UTILIZATION : public DVFSPolicy {
+  public:
+    int selectLevel(const DVFSSample & sample, const int level, const int n_levels) {
+	return stepLevel(sample.utilization, level, n_levels);
+    }
+};
+
+static DVFSPoliciesRegister dvfs_static("STATIC", new DVFS_STATIC());
+static DVFSPoliciesRegister dvfs_buffer_occupancy("BUFFER_OCCUPANCY", new DVFS_BUFFER_OCCUPANCY());
+static DVFSPoliciesRegister dvfs_link_utilization("LINK_UTILIZATION", new DVFS_LINK_UTILIZATION());
+
+vector <int> DVFSController::level;
+
+void DVFSController::configure(const vector <Router *> & _routers)
+{
+    int dim_x = GlobalParams::mesh_dim_x;
+    int dim_y = GlobalParams::mesh_dim_y;
+    int side = GlobalParams::dvfs_region;
+    int regions_x = (dim_x + side - 1) / side;
+    int n_levels = GlobalParams::power_configuration.dvfs_levels.size();
+
+    policy = DVFSPolicies::get(GlobalParams::dvfs_policy);
+    if (policy == 0)
+    {
+	cerr << " FATAL: invalid DVFS policy -dvfs " << GlobalParams::dvfs_policy << ", check with noxim -help" << endl;
+	exit(-1);
+    }
+
+    routers = _routers;
+    level.assign(dim_x * dim_y, 0);
+    last_energy.assign(dim_x * dim_y, 0.0);
+    regions.assign(regions_x * ((dim_y + side - 1) / side), vector <int>());
+
+    for (int y = 0; y < dim_y; y++)
+	for (int x = 0; x < dim_x; x++)
+	{
+	    int id = y * dim_x + x;
+
+	    regions[(y / side) * regions_x + x / side].push_back(id);
+	    routers[id]->setDVFSLevel(0);
+	}
+
+    level_cycles.assign(n_levels, 0.0);
+    level_flits.assign(n_levels, 0.0);
+    level_energy.assign(n_levels, 0.0);
+    level_changes = 0;
+    cycles = 0;
+}
+
+// Accounts the last epoch of a router to its current level
+void DVFSController::account(const int id)
+{
+    Router * r = routers[id];
+    double energy = r->power.getTotalPower();
+
+    level_cycles[level[id]] += r->dvfs_epoch_cycles;
+    level_flits[level[id]] += r->dvfs_forwarded;
+    level_energy[level[id]] += energy - last_energy[id];
+    last_energy[id] = energy;
+}
+
+void DVFSController::cycle()
+{
+    if (++cycles < GlobalParams::dvfs_epoch)
+	return;
+
+    cycles = 0;
+    update();
+}
+
+void DVFSController::update()
+{
+    int n_levels = GlobalParams::power_configuration.dvfs_levels.size();
+
+    for (unsigned int k = 0; k < regions.size(); k++)
+    {
+	DVFSSample sample;
+	int current = level[regions[k][0]];
+
+	sample.occupancy = sample.utilization = 0.0;
+	for (unsigned int i = 0; i < regions[k].size(); i++)
+	{
+	    Router * r = routers[regions[k][i]];
+
+	    if (r->dvfs_ticks > 0)
+	    {
+		sample.occupancy += r->dvfs_occupancy / r->dvfs_ticks;
+		sample.utilization += r->dvfs_forwarded / (double) (r->dvfs_ticks * (DIRECTIONS + 1));
+	    }
+	}
+	sample.occupancy /= regions[k].size();
+	sample.utilization /= regions[k].size();
+
+	int next = policy->selectLevel(sample, current, n_levels);
+
+	if (next != current)
+	    level_changes++;
+
+	for (unsigned int i = 0; i < regions[k].size(); i++)
+	{
+	    int id = regions[k][i];
+
+	    account(id);
+	    level[id] = next;
+	    routers[id]->setDVFSLevel(next);
+	}
+    }
+}
+
+void DVFSController::close()
+{
+    for (unsigned int id = 0; id < routers.size(); id++)
+    {
+	account(id);
+	routers[id]->setDVFSLevel(level[id]);
+    }
+}
+
+void DVFSController::showStats(std::ostream & out) const
+{
+    const vector < pair <double, double> > & levels = GlobalParams::power_configuration.dvfs_levels;
+    double total_cycles = 0.0;
+    double ratio = 0.0;
+
+    for (unsigned int l = 0; l < levels.size(); l++)
+    {
+	total_cycles += level_cycles[l];
+	ratio += level_cycles[l] * levels[l].first;
+    }
+
+    out << "dvfs_levels = [" << endl;
+    out << "%	level	frequency_ratio	voltage	time_fraction	flits	energy(J)" << endl;
+    for (unsigned int l = 0; l < levels.size(); l++)
+	out << "\t" << l << "\t" << levels[l].first << "\t" << levels[l].second
+	    << "\t" << (total_cycles > 0 ? level_cycles[l] / total_cycles : 0)
+	    << "\t" << level_flits[l] << "\t" << level_energy[l] << endl;
+    out << "];" << endl;
+
+    out << "% DVFS average frequency ratio: " << (total_cycles > 0 ? ratio / total_cycles : 0) << endl;
+    out << "% DVFS level changes: " << level_changes << endl;
+}
@@ -0,0 +1,98 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the router DVFS controller and of
+ * the policies selecting the voltage/frequency levels
+ */
+
+#ifndef __NOXIMDVFS_H__
+#define __NOXIMDVFS_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "GlobalParams.h"
+
+using namespace std;
+
+class Router;
+
+// Load of a DVFS region over the last epoch
+struct DVFSSample {
+    double occupancy;		// average fraction of the input buffer slots in use
+    double utilization;		// flits forwarded per router cycle and output port
+};
+
+// A policy selects the level (0 = nominal, fastest) of a region for the
+// next epoch
+class DVFSPolicy {
+  public:
+    virtual ~DVFSPolicy() {}
+    virtual int selectLevel(const DVFSSample & sample, const int level, const int n_levels) = 0;
+};
+
+typedef map<string, DVFSPolicy * > DVFSPoliciesMap;
+
+class DVFSPolicies {
+  public:
+    static DVFSPoliciesMap * dvfsPoliciesMap;
+    static DVFSPoliciesMap * getDVFSPoliciesMap();
+
+    static DVFSPolicy * get(const string & dvfsPolicyName);
+};
+
+struct DVFSPoliciesRegister : DVFSPolicies {
+    DVFSPoliciesRegister(const string & dvfsPolicyName, DVFSPolicy * dvfsPolicy) {
+	getDVFSPoliciesMap()->insert(make_pair(dvfsPolicyName, dvfsPolicy));
+    }
+};
+
+class DVFSController {
+
+  public:
+
+    // Groups the mesh routers (by tile id) in square regions of
+    // dvfs_region tiles per side, all starting at the nominal level
+    void configure(const vector <Router *> & routers);
+
+    // Counts a cycle, updating the levels at the end of each epoch
+    void cycle();
+
+    // Selects the level of each region from its load over the last epoch
+    void update();
+
+    // Accounts the energy of the last (partial) epoch to the levels
+    void close();
+
+    // Level of the router of a tile (read by its neighbors to know whether
+    // a flit crosses a frequency boundary)
+    static int getLevel(const int id) { return level[id]; }
+
+    void showStats(std::ostream & out) const;
+
+  private:
+
+    static vector <int> level;
+
+    DVFSPolicy * policy;
+    vector <Router *> routers;			// by tile id
+    vector < vector <int> > regions;		// tile ids of each region
+    vector <double> last_energy;		// energy of each router at the last epoch
+
+    // per level totals
+    vector <double> level_cycles;		// router x cycles
+    vector <double> level_flits;		// flits forwarded
+    vector <double> level_energy;		// [J]
+    unsigned long level_changes;
+    int cycles;				// in the current epoch
+
+    void account(const int id);
+};
+
+#endif
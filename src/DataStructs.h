@@ -31,16 +31,81 @@ enum FlitType {
 
 // Payload -- Payload definition
 struct Payload {
-    sc_uint<32> data;	// Bus for the data to be exchanged
+    // flit_size bits of data, least significant word first (unused bits
+    // are zero)
+    uint64_t data[PAYLOAD_WORDS];
+
+    Payload() {
+	for (int i = 0; i < PAYLOAD_WORDS; i++)
+	    data[i] = 0;
+    }
+
+    // Bits differing from another payload (wires toggling when it
+    // follows it on a link)
+    inline int toggles(const Payload & payload) const {
+	int n = 0;
+	for (int i = 0; i < PAYLOAD_WORDS; i++)
+	    n += __builtin_popcountll(data[i] ^ payload.data[i]);
+	return n;
+    }
 
     inline bool operator ==(const Payload & payload) const {
-	return (payload.data == data);
+	for (int i = 0; i < PAYLOAD_WORDS; i++)
+	    if (payload.data[i] != data[i]) return false;
+	return true;
+}};
+
+// DestinationSet -- Nodes addressed by a multicast packet, empty for the
+// unicast ones
+struct DestinationSet {
+    uint64_t mask[MULTICAST_WORDS];
+
+    DestinationSet() {
+	clear();
+    }
+
+    inline void clear() {
+	for (int i = 0; i < MULTICAST_WORDS; i++)
+	    mask[i] = 0;
+    }
+
+    inline void add(const int id) { mask[id / 64] |= (uint64_t) 1 << (id % 64); }
+    inline void remove(const int id) { mask[id / 64] &= ~((uint64_t) 1 << (id % 64)); }
+    inline bool contains(const int id) const { return (mask[id / 64] >> (id % 64)) & 1; }
+
+    inline bool empty() const {
+	for (int i = 0; i < MULTICAST_WORDS; i++)
+	    if (mask[i]) return false;
+	return true;
+    }
+
+    inline int size() const {
+	int n = 0;
+	for (int i = 0; i < MULTICAST_WORDS; i++)
+	    n += __builtin_popcountll(mask[i]);
+	return n;
+    }
+
+    // Node ids in increasing order
+    vector<int> nodes() const {
+	vector<int> ids;
+	for (int i = 0; i < MULTICAST_WORDS; i++)
+	    for (uint64_t m = mask[i]; m; m &= m - 1)
+		ids.push_back(i * 64 + __builtin_ctzll(m));
+	return ids;
+    }
+
+    inline bool operator ==(const DestinationSet & set) const {
+	for (int i = 0; i < MULTICAST_WORDS; i++)
+	    if (set.mask[i] != mask[i]) return false;
+	return true;
 }};
 
 // Packet -- Packet definition
 struct Packet {
     int src_id;
-    int dst_id;
+    int dst_id;		// first destination of a multicast packet
+    DestinationSet multicast;
     int vc_id;
     double timestamp;		// SC timestamp at packet generation
     int size;
@@ -62,6 +127,7 @@ struct Packet {
 	size = sz;
 	flit_left = sz;
 	use_low_voltage_path = false;
+	multicast.clear();
     }
 };
 
@@ -72,6 +138,8 @@ struct RouteData {
     int dst_id;
     int dir_in;			// direction from which the packet comes from
     int vc_id;
+    int sequence_length;	// packet length [flits]
+    bool multicast;		// multicast packet, sent to the radio hub
 };
 
 struct ChannelStatus {
@@ -119,6 +187,7 @@ struct TBufferFullStatus {
 struct Flit {
     int src_id;
     int dst_id;
+    DestinationSet multicast;	// Destinations of a multicast packet, empty otherwise
     int vc_id; // Virtual Channel
     FlitType flit_type;	// The flit type (FLIT_TYPE_HEAD, FLIT_TYPE_BODY, FLIT_TYPE_TAIL)
     int sequence_no;		// The sequence number of the flit inside the packet
@@ -129,16 +198,22 @@ struct Flit {
     bool use_low_voltage_path;
 
     int hub_relay_node;
+    int bond_id;		// Packet striped over several radio channels, NOT_VALID otherwise
+
+    double hop_time;		// Cycle of the last latency breakdown event (head flits only)
 
     inline bool operator ==(const Flit & flit) const {
 	return (flit.src_id == src_id && flit.dst_id == dst_id
+		&& flit.multicast == multicast
 		&& flit.flit_type == flit_type
 		&& flit.vc_id == vc_id
 		&& flit.sequence_no == sequence_no
 		&& flit.sequence_length == sequence_length
 		&& flit.payload == payload && flit.timestamp == timestamp
 		&& flit.hop_no == hop_no
-		&& flit.use_low_voltage_path == use_low_voltage_path);
+		&& flit.use_low_voltage_path == use_low_voltage_path
+		&& flit.bond_id == bond_id
+		&& flit.hop_time == hop_time);
 }};
 
 
@@ -172,6 +247,8 @@ enum
     WIRELESS_TX,
     WIRELESS_DYNAMIC_RX_PWR,
     WIRELESS_SNOOPING,
+    PG_WAKEUP_PWR_D,
+    WIRELESS_WAKEUP_PWR_D,
     NO_BREAKDOWN_ENTRIES_D
 };
 
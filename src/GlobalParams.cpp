@@ -11,6 +11,8 @@
 #include "GlobalParams.h"
 
 string GlobalParams::verbose_mode;
+int GlobalParams::log_level;
+map<string, int> GlobalParams::log_module_levels;
 int GlobalParams::trace_mode;
 string GlobalParams::trace_filename;
 
@@ -47,16 +49,71 @@ bool GlobalParams::detailed;
 double GlobalParams::dyad_threshold;
 unsigned int GlobalParams::max_volume_to_be_drained;
 vector <pair <int, double> > GlobalParams::hotspots;
+double GlobalParams::multicast_probability;
+int GlobalParams::multicast_size;
 bool GlobalParams::show_buffer_stats;
+bool GlobalParams::show_allocator_stats;
+bool GlobalParams::latency_breakdown;
 bool GlobalParams::use_winoc;
 int GlobalParams::winoc_dst_hops;
+bool GlobalParams::winoc_tx_attenuation;
+int GlobalParams::winoc_path_selection;
+int GlobalParams::hub_selection;
+int GlobalParams::wireless_reuse_region;
+double GlobalParams::wireless_interference_range;
+vector<vector<int> > GlobalParams::wireless_interference;
+int GlobalParams::wireless_arq;
+int GlobalParams::wireless_arq_window;
+int GlobalParams::wireless_ack_cycles;
+int GlobalParams::wireless_bonding;
 bool GlobalParams::use_powermanager;
+string GlobalParams::wireless_sleep_policy;
+int GlobalParams::wireless_sleep_timeout;
+int GlobalParams::wireless_sleep_history;
+int GlobalParams::wireless_wakeup_latency;
+double GlobalParams::wireless_wakeup_energy;
+bool GlobalParams::profiling;
+int GlobalParams::profile_interval;
+bool GlobalParams::power_trace_mode;
+string GlobalParams::power_trace_filename;
+int GlobalParams::power_trace_epoch;
+bool GlobalParams::power_trace_breakdown;
+bool GlobalParams::thermal_model;
+double GlobalParams::thermal_ambient;
+double GlobalParams::thermal_leakage_tref;
+double GlobalParams::thermal_leakage_beta;
+double GlobalParams::thermal_die_thickness;
+double GlobalParams::thermal_conductivity;
+double GlobalParams::thermal_heat_capacity;
+double GlobalParams::thermal_vertical_resistance;
+double GlobalParams::thermal_time_scale;
+int GlobalParams::power_gating;
+int GlobalParams::pg_idle_threshold;
+int GlobalParams::pg_wakeup_latency;
+double GlobalParams::pg_wakeup_energy;
+bool GlobalParams::pg_bypass;
+string GlobalParams::dvfs_policy;
+int GlobalParams::dvfs_epoch;
+int GlobalParams::dvfs_region;
+int GlobalParams::dvfs_sync_latency;
+int GlobalParams::dvfs_static_level;
+double GlobalParams::dvfs_low_threshold;
+double GlobalParams::dvfs_high_threshold;
+string GlobalParams::payload_mode;
+double GlobalParams::payload_bit_probability;
+double GlobalParams::payload_toggle_probability;
+string GlobalParams::payload_trace_filename;
 ChannelConfig GlobalParams::default_channel_configuration;
 map<int, ChannelConfig> GlobalParams::channel_configuration;
 HubConfig GlobalParams::default_hub_configuration;
 map<int, HubConfig> GlobalParams::hub_configuration;
 map<int, int> GlobalParams::hub_for_tile;
+map<int, vector<int> > GlobalParams::hubs_for_tile;
+int GlobalParams::hub_links = 1;
 PowerConfig GlobalParams::power_configuration;
 // out of yaml configuration
 bool GlobalParams::ascii_monitor;
 int GlobalParams::channel_selection;
+int GlobalParams::log_level_max;
+bool GlobalParams::dvfs_mode;
+bool GlobalParams::payload_energy;
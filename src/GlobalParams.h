@@ -31,9 +31,20 @@ using namespace std;
 #define DIRECTION_LOCAL         4
 #define DIRECTION_HUB           5
 #define DIRECTION_HUB_RELAY     5000
+// r2h links of a tile attached to several hubs: the first one is
+// DIRECTION_HUB, the others DIRECTION_HUB + 1, ...
+#define MAX_HUB_LINKS           4
+#define MAX_ROUTER_PORTS        (DIRECTION_HUB + MAX_HUB_LINKS)
 #define DIRECTION_WIRELESS    747
 
 #define MAX_VIRTUAL_CHANNELS	8
+
+// Widest flit carrying a payload, in bits and 64-bit words
+#define MAX_FLIT_SIZE		256
+#define PAYLOAD_WORDS		(MAX_FLIT_SIZE / 64)
+// Tiles a multicast packet can address, and 64-bit words of its set
+#define MAX_MULTICAST_NODES	256
+#define MULTICAST_WORDS		(MAX_MULTICAST_NODES / 64)
 #define DEFAULT_VC 		0
 
 #define RT_AVAILABLE 1
@@ -62,6 +73,9 @@ using namespace std;
 // Channel selection 
 #define CHSEL_RANDOM 0
 #define CHSEL_FIRST_FREE 1
+#define CHSEL_LEAST_OCCUPIED 2	// fewest flits in the antenna TX buffer
+#define CHSEL_MIN_TOKEN_WAIT 3	// shortest token wait plus antenna TX queue
+#define CHSEL_DATA_RATE 4	// random, weighted by the channel data rate
 
 // Traffic distribution
 #define TRAFFIC_RANDOM         "TRAFFIC_RANDOM"
@@ -81,6 +95,13 @@ using namespace std;
 #define VERBOSE_MEDIUM         "VERBOSE_MEDIUM"
 #define VERBOSE_HIGH           "VERBOSE_HIGH"
 
+// Log levels (see LOG_AT in Utils.h)
+#define LOG_LEVEL_OFF          0
+#define LOG_LEVEL_ERROR        1
+#define LOG_LEVEL_WARNING      2
+#define LOG_LEVEL_INFO         3
+#define LOG_LEVEL_DEBUG        4
+
 
 // Wireless MAC constants
 #define RELEASE_CHANNEL 1
@@ -89,11 +110,54 @@ using namespace std;
 #define TOKEN_HOLD             "TOKEN_HOLD"
 #define TOKEN_MAX_HOLD         "TOKEN_MAX_HOLD"
 #define TOKEN_PACKET           "TOKEN_PACKET"
+#define TDMA                   "TDMA"
+#define TDMA_WEIGHTED          "TDMA_WEIGHTED"
+#define CSMA                   "CSMA"
+
+// Decoded MAC policies (see TokenRing::getMacPolicy)
+#define MAC_TOKEN_PACKET       0
+#define MAC_TOKEN_HOLD         1
+#define MAC_TOKEN_MAX_HOLD     2
+#define MAC_TDMA               3	// fixed slots, one per hub
+#define MAC_TDMA_WEIGHTED      4	// slots of each frame by the demand of the previous one
+#define MAC_CSMA               5	// carrier sense, collisions and backoff, no token
+
+// Wired/wireless path selection of the WiNoC routers
+#define WINOC_PATH_STATIC      0	// wireless whenever the destination is reachable
+#define WINOC_PATH_ADAPTIVE    1	// wireless only if estimated faster than wired
+
+// Hub taken by the wireless packets of a tile attached to several hubs
+#define HUB_SELECTION_PRIMARY      0	// the lowest id hub reaching the destination one
+#define HUB_SELECTION_ROUND_ROBIN  1	// in turn, a packet each
+#define HUB_SELECTION_ADAPTIVE     2	// least expected latency: hub buffers and token state
+
+// Link-level retransmission of the flits corrupted on the radio channels
+#define ARQ_NONE               0	// error-free radio channels, no acknowledgements
+#define ARQ_STOP_AND_WAIT      1	// each flit waits for its acknowledgement
+#define ARQ_GO_BACK_N          2	// a window of flits, resent from the corrupted one
+
+// Router power gating levels
+#define PG_NONE                0
+#define PG_PORT                1	// input port buffers
+#define PG_ROUTER              2	// input port buffers and router logic
+
+// Router DVFS
+#define DVFS_NONE              "NONE"
+
+// Sleep policy of the radio hub transceivers
+#define SLEEP_NONE             "NONE"
+
+// Payload data
+#define PAYLOAD_NONE           "NONE"
+#define PAYLOAD_RANDOM         "RANDOM"
+#define PAYLOAD_CORRELATED     "CORRELATED"
+#define PAYLOAD_TRACE          "TRACE"
 
 typedef struct {
     pair<double, double> ber;
     int dataRate;
     vector<string> macPolicy;
+    vector<vector<int> > reuseGroups;	// hub ids of each token of the channel
 } ChannelConfig;
 
 typedef struct {
@@ -136,10 +200,13 @@ typedef struct {
     LinkBitLinePowerConfig linkBitLinePowerConfig;
     RouterPowerConfig routerPowerConfig;
     HubPowerConfig hubPowerConfig;
+    vector<pair<double, double> > dvfs_levels;	// [frequency ratio, voltage], nominal first
 } PowerConfig;
 
 struct GlobalParams {
     static string verbose_mode;
+    static int log_level;
+    static map<string, int> log_module_levels;
     static int trace_mode;
     static string trace_filename;
     static string topology;
@@ -170,21 +237,76 @@ struct GlobalParams {
     static int rnd_generator_seed;
     static bool detailed;
     static vector <pair <int, double> > hotspots;
+    static double multicast_probability;
+    static int multicast_size;
     static double dyad_threshold;
     static unsigned int max_volume_to_be_drained;
     static bool show_buffer_stats;
+    static bool show_allocator_stats;
+    static bool latency_breakdown;
     static bool use_winoc;
     static int winoc_dst_hops;
+    static bool winoc_tx_attenuation;
+    static int winoc_path_selection;
+    static int hub_selection;
+    static int wireless_reuse_region;
+    static double wireless_interference_range;
+    static vector<vector<int> > wireless_interference;
+    static int wireless_arq;
+    static int wireless_arq_window;
+    static int wireless_ack_cycles;
+    static int wireless_bonding;
     static bool use_powermanager;
+    static string wireless_sleep_policy;
+    static int wireless_sleep_timeout;
+    static int wireless_sleep_history;
+    static int wireless_wakeup_latency;
+    static double wireless_wakeup_energy;
+    static bool profiling;
+    static int profile_interval;
+    static bool power_trace_mode;
+    static string power_trace_filename;
+    static int power_trace_epoch;
+    static bool power_trace_breakdown;
+    static bool thermal_model;
+    static double thermal_ambient;
+    static double thermal_leakage_tref;
+    static double thermal_leakage_beta;
+    static double thermal_die_thickness;
+    static double thermal_conductivity;
+    static double thermal_heat_capacity;
+    static double thermal_vertical_resistance;
+    static double thermal_time_scale;
+    static int power_gating;
+    static int pg_idle_threshold;
+    static int pg_wakeup_latency;
+    static double pg_wakeup_energy;
+    static bool pg_bypass;
+    static string dvfs_policy;
+    static int dvfs_epoch;
+    static int dvfs_region;
+    static int dvfs_sync_latency;
+    static int dvfs_static_level;
+    static double dvfs_low_threshold;
+    static double dvfs_high_threshold;
+    static string payload_mode;
+    static double payload_bit_probability;
+    static double payload_toggle_probability;
+    static string payload_trace_filename;
     static ChannelConfig default_channel_configuration;
     static map<int, ChannelConfig> channel_configuration;
     static HubConfig default_hub_configuration;
     static map<int, HubConfig> hub_configuration;
-    static map<int, int> hub_for_tile;
+    static map<int, int> hub_for_tile;		// primary hub of a tile
+    static map<int, vector<int> > hubs_for_tile;	// all the hubs of a tile, primary first
+    static int hub_links;			// most hubs a tile is attached to
     static PowerConfig power_configuration;
     // out of yaml configuration
     static bool ascii_monitor;
     static int channel_selection;
+    static int log_level_max;
+    static bool dvfs_mode;
+    static bool payload_energy;
 };
 
 #endif
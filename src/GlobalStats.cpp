@@ -9,6 +9,7 @@
  */
 
 #include "GlobalStats.h"
+#include "Profiler.h"
 using namespace std;
 
 GlobalStats::GlobalStats(const NoC * _noc)
@@ -201,6 +202,40 @@ double GlobalStats::getAverageThroughput()
 }
 */
 
+double GlobalStats::getAveragePacketDelay()
+{
+    unsigned int total_packets = 0;
+    double avg_delay = 0.0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+    {
+	Stats & stats = noc->searchNode(i)->r->stats;
+	unsigned int completed_packets = stats.getCompletedPackets();
+
+	if (completed_packets)
+	{
+	    avg_delay += completed_packets * stats.getAveragePacketDelay();
+	    total_packets += completed_packets;
+	}
+    }
+
+    return avg_delay / (double) total_packets;
+}
+
+double GlobalStats::getMaxPacketDelay()
+{
+    double maxd = -1.0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+    {
+	double d = noc->searchNode(i)->r->stats.getMaxPacketDelay();
+	if (d > maxd)
+	    maxd = d;
+    }
+
+    return maxd;
+}
+
 double GlobalStats::getAggregatedThroughput()
 {
     int total_cycles = GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
@@ -307,6 +342,104 @@ double GlobalStats::getActiveThroughput()
 
 }
 
+int GlobalStats::getNumberOfIPs()
+{
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+	return GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+    else // other delta topologies
+	return GlobalParams::n_delta_tiles;
+}
+
+double GlobalStats::getOfferedLoad()
+{
+    int total_cycles = GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
+    unsigned long n = 0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+	n += noc->searchNode(i)->pe->source_stats.getOfferedFlits();
+
+    return (double) n / (double) (total_cycles * getNumberOfIPs());
+}
+
+double GlobalStats::getOfferedLoad(const int src_id)
+{
+    int total_cycles = GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
+
+    return (double) noc->searchNode(src_id)->pe->source_stats.getOfferedFlits() / (double) total_cycles;
+}
+
+double GlobalStats::getAcceptedLoad(const int src_id)
+{
+    int total_cycles = GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
+    unsigned int n = 0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+	n += noc->searchNode(i)->r->stats.getReceivedFlits(src_id);
+
+    return (double) n / (double) total_cycles;
+}
+
+double GlobalStats::getAverageBacklog()
+{
+    double backlog = 0.0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+	backlog += noc->searchNode(i)->pe->source_stats.getAverageBacklog();
+
+    return backlog / (double) getNumberOfIPs();
+}
+
+unsigned long GlobalStats::getMaxBacklog()
+{
+    unsigned long maxb = 0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+	maxb = max(maxb, noc->searchNode(i)->pe->source_stats.getMaxBacklog());
+
+    return maxb;
+}
+
+long GlobalStats::getBacklogGrowth()
+{
+    long growth = 0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+	growth += noc->searchNode(i)->pe->source_stats.getBacklogGrowth();
+
+    return growth;
+}
+
+bool GlobalStats::isSaturated()
+{
+    int total_cycles = GlobalParams::simulation_time - GlobalParams::stats_warm_up_time;
+    double offered = getOfferedLoad();
+
+    if (offered == 0)
+	return false;
+
+    // either the network delivers less than it is offered or the
+    // sources keep accumulating packets which are never counted as
+    // received (which would make the average delay look bounded)
+    return getThroughput() < SATURATION_ACCEPTED_RATIO * offered ||
+	getBacklogGrowth() > (1.0 - SATURATION_ACCEPTED_RATIO) * offered * total_cycles * getNumberOfIPs();
+}
+
+void GlobalStats::showSourceStats(std::ostream & out)
+{
+    out << "source_stats = [" << endl;
+    out << "%	src	offered(flits/cycle)	accepted(flits/cycle)	avg backlog(flits)	max backlog(flits)" << endl;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+    {
+	SourceStats & ss = noc->searchNode(i)->pe->source_stats;
+
+	out << "	" << i << "	" << getOfferedLoad(i) << "	" << getAcceptedLoad(i) << "	"
+	    << ss.getAverageBacklog() << "	" << ss.getMaxBacklog() << endl;
+    }
+
+    out << "];" << endl;
+}
+
 vector < vector < unsigned long > > GlobalStats::getRoutedFlitsMtx()
 {
 
@@ -468,6 +601,21 @@ void GlobalStats::showStats(std::ostream & out, bool detailed)
 	}
 	out << "];" << endl;
 
+	// show Temperature matrix
+	if (GlobalParams::thermal_model)
+	{
+	    out << endl << "temperature = [" << endl;
+	    for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    {
+		out << "   ";
+		for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		    out << setw(10) << noc->thermal_model.getTemperature(y * GlobalParams::mesh_dim_x + x);
+		out << endl;
+	    }
+	    out << "];" << endl;
+	}
+
+	showSourceStats(out);
 	showPowerBreakDown(out);
 	showPowerManagerStats(out);
     }
@@ -498,15 +646,68 @@ void GlobalStats::showStats(std::ostream & out, bool detailed)
     out << "% Average wireless utilization: " << getWirelessPackets()/(double)getReceivedPackets() << endl;
     out << "% Global average delay (cycles): " << getAverageDelay() << endl;
     out << "% Max delay (cycles): " << getMaxDelay() << endl;
+    out << "% Global average packet delay (cycles): " << getAveragePacketDelay() << endl;
+    out << "% Max packet delay (cycles): " << getMaxPacketDelay() << endl;
     out << "% Network throughput (flits/cycle): " << getAggregatedThroughput() << endl;
     out << "% Average IP throughput (flits/cycle/IP): " << getThroughput() << endl;
+    out << "% Offered load (flits/cycle/IP): " << getOfferedLoad() << endl;
+    out << "% Accepted load (flits/cycle/IP): " << getThroughput() << endl;
+    out << "% Average source backlog (flits/IP): " << getAverageBacklog() << endl;
+    out << "% Max source backlog (flits): " << getMaxBacklog() << endl;
+    out << "% Network saturated: " << (isSaturated() ? "yes" : "no") << endl;
     out << "% Total energy (J): " << getTotalPower() << endl;
     out << "% \tDynamic energy (J): " << getDynamicPower() << endl;
     out << "% \tStatic energy (J): " << getStaticPower() << endl;
 
+    if (GlobalParams::thermal_model)
+    {
+	out << "% Average temperature (C): " << noc->thermal_model.getAverageTemperature() << endl;
+	out << "% Max temperature (C): " << noc->thermal_model.getMaxTemperature() << endl;
+	out << "% Peak temperature (C): " << noc->thermal_model.getPeakTemperature() << endl;
+    }
+
+    if (GlobalParams::dvfs_mode)
+    {
+	out << "% Energy-delay product (J*cycles): " << getTotalPower() * getAverageDelay() << endl;
+	noc->dvfs.showStats(out);
+    }
+
     if (GlobalParams::show_buffer_stats)
       showBufferStats(out);
 
+    if (GlobalParams::show_allocator_stats)
+	showAllocatorStats(out);
+
+    if (GlobalParams::latency_breakdown)
+	showLatencyBreakdown(out);
+
+    if (GlobalParams::power_gating != PG_NONE)
+	showPowerGatingStats(out);
+
+    if (GlobalParams::winoc_path_selection == WINOC_PATH_ADAPTIVE)
+	WirelessPaths::showStats(out);
+
+    if (GlobalParams::use_winoc && GlobalParams::hub_links > 1)
+	WirelessPaths::showLinkStats(out);
+
+    if (GlobalParams::use_winoc)
+	showWirelessMacStats(out);
+
+    if (GlobalParams::use_winoc && GlobalParams::wireless_arq != ARQ_NONE)
+	showWirelessArqStats(out);
+
+    // already shown with the detailed stats
+    if (GlobalParams::use_winoc && GlobalParams::wireless_sleep_policy != SLEEP_NONE && !detailed)
+	showPowerManagerStats(out);
+
+    if (GlobalParams::use_winoc && GlobalParams::wireless_bonding > 1)
+	showWirelessBondingStats(out);
+
+    if (GlobalParams::multicast_probability > 0)
+	showMulticastStats(out);
+
+    Profiler::showStats(out);
+
 }
 
 void GlobalStats::updatePowerBreakDown(map<string,double> &dst,PowerBreakdown* src)
@@ -540,7 +741,7 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 	out << "\t" << hub_id << "\t" << std::fixed << (double)h->total_ttxoff_cycles/total_cycles << "\t";
 
 	int s = 0;
-	for (map<int,int>::iterator i = h->abtxoff_cycles.begin(); i!=h->abtxoff_cycles.end();i++) s+=i->second;
+	for (unsigned int i = 0; i < h->abtxoff_cycles.size(); i++) s+=h->abtxoff_cycles[i];
 
 	out << (double)s/h->abtxoff_cycles.size()/total_cycles << endl;
     }
@@ -571,18 +772,17 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 	out << "\t" << hub_id << "\t" << std::fixed << (double)h->total_sleep_cycles/total_cycles << "\t";
 
 	int s = 0;
-	for (map<int,int>::iterator i = h->buffer_rx_sleep_cycles.begin();
-		i!=h->buffer_rx_sleep_cycles.end();i++)
-	    s+=i->second;
+	for (unsigned int i = 0; i < h->buffer_rx_sleep_cycles.size(); i++)
+	    s+=h->buffer_rx_sleep_cycles[i];
 
 	out << (double)s/h->buffer_rx_sleep_cycles.size()/total_cycles << "\t";
 
 	s = 0;
-	for (map<int,int>::iterator i = h->buffer_to_tile_poweroff_cycles.begin();
-		i!=h->buffer_to_tile_poweroff_cycles.end();i++)
+	for (unsigned int i = 0; i < h->buffer_to_tile_poweroff_cycles.size(); i++)
 	{
-	    double bttoff_fraction = i->second/(double)total_cycles;
-	    s+=i->second;
+	    // the buffers of all the VCs of the port
+	    double bttoff_fraction = h->buffer_to_tile_poweroff_cycles[i]/(double)total_cycles/GlobalParams::n_virtual_channels;
+	    s+=h->buffer_to_tile_poweroff_cycles[i];
 	    if (bttoff_fraction<0.25)
 		bttoff_str+=" ";
 	    else if (bttoff_fraction<0.5)
@@ -596,11 +796,73 @@ void GlobalStats::showPowerManagerStats(std::ostream & out)
 	    
 
 	}
-	out << (double)s/h->buffer_to_tile_poweroff_cycles.size()/total_cycles << "\t" << bttoff_str << endl;
+	out << (double)s/h->buffer_to_tile_poweroff_cycles.size()/total_cycles/GlobalParams::n_virtual_channels << "\t" << bttoff_str << endl;
     }
 
     out << "];" << endl;
 
+    if (GlobalParams::wireless_sleep_policy != SLEEP_NONE)
+    {
+	double saved = 0.0, wakeup = 0.0, wasted = 0.0;
+	unsigned long stall_cycles = 0, waits = 0, missed = 0;
+
+	out << "wireless_sleep = [" << endl;
+	out << "%	Fraction of transceiver off, events and energy (J) of the " << GlobalParams::wireless_sleep_policy << " sleep policy" << endl;
+	out << "%	HUB	TRXoff	TTXoff	sleeps	wakeups	early	short	stalls	rx_waits	missed	saved	wakeup	wasted	net" << endl;
+
+	for (map<int, HubConfig>::iterator it = GlobalParams::hub_configuration.begin();
+		it != GlobalParams::hub_configuration.end();
+		++it)
+	{
+	    Hub * h = noc->hub.find(it->first)->second;
+	    const SleepController & rx = h->rx_sleep;
+	    const SleepController & tx = h->tx_sleep;
+
+	    double hub_saved = rx.sleep_cycles * rx.getOnEnergy() + tx.sleep_cycles * tx.getOnEnergy();
+	    double hub_wakeup = (rx.wakeups + rx.early_wakeups + tx.wakeups + tx.early_wakeups) * GlobalParams::wireless_wakeup_energy;
+
+	    // the flits transmitted by the hub that waited for a receiver
+	    // waking up or were missed by one not on
+	    unsigned long hub_waits = 0, hub_missed = 0;
+	    double hub_wasted = 0.0;
+	    for (unsigned int i = 0; i < h->init.size(); i++)
+	    {
+		hub_waits += h->init[i]->rx_wakeup_waits;
+		hub_missed += h->init[i]->rx_missed_flits;
+		hub_wasted += h->init[i]->rx_missed_energy;
+	    }
+
+	    out << "\t" << it->first << "\t" << std::fixed
+		<< (double)rx.sleep_cycles/total_cycles << "\t" << (double)tx.sleep_cycles/total_cycles << "\t";
+	    out.unsetf(std::ios::fixed);
+	    out << rx.sleeps + tx.sleeps << "\t" << rx.wakeups + tx.wakeups << "\t"
+		<< rx.early_wakeups + tx.early_wakeups << "\t" << rx.short_sleeps + tx.short_sleeps << "\t"
+		<< rx.stall_cycles + tx.stall_cycles << "\t" << hub_waits << "\t" << hub_missed << "\t"
+		<< hub_saved << "\t" << hub_wakeup << "\t" << hub_wasted << "\t" << hub_saved - hub_wakeup - hub_wasted << endl;
+
+	    saved += hub_saved;
+	    wakeup += hub_wakeup;
+	    wasted += hub_wasted;
+	    stall_cycles += rx.stall_cycles + tx.stall_cycles;
+	    waits += hub_waits;
+	    missed += hub_missed;
+	}
+
+	out << "];" << endl;
+
+	Hub * h = noc->hub.begin()->second;
+	unsigned int packets = getWirelessPackets();
+
+	out << "% Sleep energy saved (J): " << saved << endl;
+	out << "% Wake-up energy (J): " << wakeup << endl;
+	out << "% Transmissions wasted on receivers not on: " << missed << " (" << wasted << " J)" << endl;
+	out << "% Net energy saved (J): " << saved - wakeup - wasted << endl;
+	out << "% Latency added (stall cycles): " << stall_cycles << endl;
+	out << "% Latency added per wireless packet (cycles): " << (packets > 0 ? (double)stall_cycles / packets : 0) << endl;
+	out << "% Cycles flits waited for a receiver waking up: " << waits << endl;
+	out << "% Break-even time RX/TX (cycles): " << h->rx_sleep.getBreakEven() << "/" << h->tx_sleep.getBreakEven() << endl;
+    }
+
     out.unsetf(std::ios::fixed);
 
     out.precision(p);
@@ -653,6 +915,405 @@ void GlobalStats::showPowerBreakDown(std::ostream & out)
 
 
 
+vector <Router *> GlobalStats::getRouters()
+{
+    vector <Router *> routers;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+	    for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+		routers.push_back(noc->t[x][y]->r);
+    }
+    else // other delta topologies: switch blocks and cores
+    {
+	int stg = log2(GlobalParams::n_delta_tiles);
+	int sw = GlobalParams::n_delta_tiles / 2;
+
+	for (int i = 0; i < stg; i++)
+	    for (int j = 0; j < sw; j++)
+		routers.push_back(noc->t[i][j]->r);
+	for (int i = 0; i < GlobalParams::n_delta_tiles; i++)
+	    routers.push_back(noc->core[i]->r);
+    }
+
+    return routers;
+}
+
+void GlobalStats::showPowerGatingStats(std::ostream & out)
+{
+    vector <Router *> routers = getRouters();
+    int total_cycles = sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time;
+    PowerGatingStats total;
+    double saved = 0.0;
+
+    out << "power_gating = [" << endl;
+    out << "%	router	port_gatings	port_gated_cycles	router_gatings	router_gated_cycles	wakeups	short_sleeps	wakeup_stalls	bypassed_flits	saved(J)	net_saved(J)" << endl;
+
+    for (unsigned int k = 0; k < routers.size(); k++)
+    {
+	PowerGatingStats & pg = routers[k]->pg_stats;
+	unsigned long wakeups = pg.wakeups[PG_BLOCK_PORT] + pg.wakeups[PG_BLOCK_ROUTER];
+	double router_saved = pg.gated_cycles[PG_BLOCK_PORT] * routers[k]->getBlockLeakage(PG_BLOCK_PORT) +
+	    pg.gated_cycles[PG_BLOCK_ROUTER] * routers[k]->getBlockLeakage(PG_BLOCK_ROUTER);
+
+	out << "\t" << routers[k]->local_id
+	    << "\t" << pg.gatings[PG_BLOCK_PORT] << "\t" << pg.gated_cycles[PG_BLOCK_PORT]
+	    << "\t" << pg.gatings[PG_BLOCK_ROUTER] << "\t" << pg.gated_cycles[PG_BLOCK_ROUTER]
+	    << "\t" << wakeups << "\t" << pg.short_sleeps[PG_BLOCK_PORT] + pg.short_sleeps[PG_BLOCK_ROUTER]
+	    << "\t" << pg.wakeup_stall_cycles << "\t" << pg.bypassed_flits
+	    << "\t" << router_saved << "\t" << router_saved - wakeups * GlobalParams::pg_wakeup_energy << endl;
+
+	for (int b = 0; b < PG_NO_BLOCKS; b++)
+	{
+	    total.gatings[b] += pg.gatings[b];
+	    total.wakeups[b] += pg.wakeups[b];
+	    total.gated_cycles[b] += pg.gated_cycles[b];
+	    total.short_sleeps[b] += pg.short_sleeps[b];
+	}
+	total.wakeup_stall_cycles += pg.wakeup_stall_cycles;
+	total.bypassed_flits += pg.bypassed_flits;
+	saved += router_saved;
+    }
+    out << "];" << endl;
+
+    double wakeup_energy = (total.wakeups[PG_BLOCK_PORT] + total.wakeups[PG_BLOCK_ROUTER]) * GlobalParams::pg_wakeup_energy;
+    double port_cycles = (double) routers.size() * (DIRECTIONS + 1) * total_cycles;
+    double router_cycles = (double) routers.size() * total_cycles;
+
+    // the break-even time is the same for all the routers, unless the
+    // thermal model scales their leakage
+    out << "% Power gating break-even (cycles): port " << routers[0]->getBreakEven(PG_BLOCK_PORT)
+	<< ", router " << routers[0]->getBreakEven(PG_BLOCK_ROUTER) << endl;
+    out << "% Power gating gated fraction: ports " << (port_cycles > 0 ? total.gated_cycles[PG_BLOCK_PORT] / port_cycles : 0)
+	<< ", routers " << (router_cycles > 0 ? total.gated_cycles[PG_BLOCK_ROUTER] / router_cycles : 0) << endl;
+    out << "% Power gating wake-ups: ports " << total.wakeups[PG_BLOCK_PORT]
+	<< " (" << total.short_sleeps[PG_BLOCK_PORT] << " below break-even), routers "
+	<< total.wakeups[PG_BLOCK_ROUTER] << " (" << total.short_sleeps[PG_BLOCK_ROUTER] << " below break-even)" << endl;
+    out << "% Power gating wake-up stall cycles: " << total.wakeup_stall_cycles << endl;
+    if (GlobalParams::pg_bypass)
+	out << "% Power gating bypassed flits: " << total.bypassed_flits << endl;
+    out << "% Power gating leakage saved (J): " << saved << endl;
+    out << "% Power gating wake-up energy (J): " << wakeup_energy << endl;
+    out << "% Power gating net saving (J): " << saved - wakeup_energy << endl;
+}
+
+void GlobalStats::showWirelessMacStats(std::ostream & out)
+{
+    // access delay of the head flits, by channel
+    map<int, pair<double, unsigned long> > access;
+    for (map<int, Hub*>::const_iterator it = noc->hub.begin(); it != noc->hub.end(); it++)
+	for (unsigned int tx = 0; tx < it->second->init.size(); tx++)
+	{
+	    Initiator * init = it->second->init[tx];
+	    access[init->getChannel()].first += init->access_delay;
+	    access[init->getChannel()].second += init->access_samples;
+	}
+
+    unsigned long flits = 0;
+    unsigned long collisions = 0;
+    double utilization = 0;
+    pair<double, unsigned long> total_access(0, 0);
+
+    out << "% MAC: " << MAC_TOKEN_PACKET << " TOKEN_PACKET, " << MAC_TOKEN_HOLD << " TOKEN_HOLD, "
+	<< MAC_TOKEN_MAX_HOLD << " TOKEN_MAX_HOLD, " << MAC_TDMA << " TDMA, "
+	<< MAC_TDMA_WEIGHTED << " TDMA_WEIGHTED, " << MAC_CSMA << " CSMA" << endl;
+    out << "wireless_mac = [" << endl;
+    out << "%	channel	mac	tokens	flits	collisions	rx_busy	deferrals	utilization	access_delay" << endl;
+    for (map<int, Channel*>::const_iterator it = noc->channel.begin(); it != noc->channel.end(); it++)
+    {
+	Channel * c = it->second;
+	pair<double, unsigned long> & a = access[it->first];
+	double u = (double) c->busy_cycles / GlobalParams::simulation_time;
+
+	out << "	" << it->first << "	" << c->getMacPolicy() << "	" << c->getTokens() << "	"
+	    << c->flits_transmitted << "	" << c->collisions << "	" << c->rx_busy << "	"
+	    << c->deferrals << "	" << u << "	" << (a.second > 0 ? a.first / a.second : 0) << endl;
+
+	flits += c->flits_transmitted;
+	collisions += c->collisions;
+	utilization += u;
+	total_access.first += a.first;
+	total_access.second += a.second;
+    }
+    out << "];" << endl;
+
+    out << "% Wireless collision ratio: " << (flits > 0 ? (double) collisions / flits : 0) << endl;
+    out << "% Wireless channel utilization: " << (noc->channel.empty() ? 0 : utilization / noc->channel.size()) << endl;
+    out << "% Wireless access delay (cycles): " << (total_access.second > 0 ? total_access.first / total_access.second : 0) << endl;
+}
+
+void GlobalStats::showWirelessArqStats(std::ostream & out)
+{
+    // retransmissions, by channel
+    map<int, pair<unsigned long, unsigned long> > retransmitted;
+    for (map<int, Hub*>::const_iterator it = noc->hub.begin(); it != noc->hub.end(); it++)
+	for (unsigned int tx = 0; tx < it->second->init.size(); tx++)
+	{
+	    Initiator * init = it->second->init[tx];
+	    retransmitted[init->getChannel()].first += init->nacks;
+	    retransmitted[init->getChannel()].second += init->wasted_flits;
+	}
+
+    // simulated time [ps], to express the goodput in Gb/s
+    double time_ps = (double) GlobalParams::simulation_time * GlobalParams::clock_period_ps;
+    unsigned long flits = 0;
+    unsigned long delivered = 0;
+    unsigned long corrupted = 0;
+    unsigned long nacks = 0;
+    unsigned long wasted = 0;
+
+    out << "wireless_arq = [" << endl;
+    out << "%	channel	ber_near	ber_far	flits	delivered	corrupted	nacks	wasted	goodput(Gbps)	efficiency" << endl;
+    for (map<int, Channel*>::const_iterator it = noc->channel.begin(); it != noc->channel.end(); it++)
+    {
+	Channel * c = it->second;
+	const pair<double, double> & ber = GlobalParams::channel_configuration[it->first].ber;
+	pair<unsigned long, unsigned long> & r = retransmitted[it->first];
+	unsigned long sent = c->flits_transmitted + r.second;
+
+	out << "	" << it->first << "	" << ber.first << "	" << ber.second << "	"
+	    << c->flits_transmitted << "	" << c->flits_delivered << "	" << c->corrupted << "	"
+	    << r.first << "	" << r.second << "	"
+	    << 1000.0 * c->flits_delivered * GlobalParams::flit_size / time_ps << "	"
+	    << (sent > 0 ? (double) c->flits_delivered / sent : 0) << endl;
+
+	flits += c->flits_transmitted;
+	delivered += c->flits_delivered;
+	corrupted += c->corrupted;
+	nacks += r.first;
+	wasted += r.second;
+    }
+    out << "];" << endl;
+
+    out << "% Wireless flit error ratio: " << (flits > 0 ? (double) corrupted / flits : 0) << endl;
+    out << "% Wireless retransmitted flits: " << nacks + wasted << endl;
+    out << "% Wireless goodput (Gbps): " << 1000.0 * delivered * GlobalParams::flit_size / time_ps << endl;
+    out << "% Wireless transmission efficiency: " << (flits + wasted > 0 ? (double) delivered / (flits + wasted) : 0) << endl;
+}
+
+void GlobalStats::showMulticastStats(std::ostream & out)
+{
+    unsigned long packets = 0;
+    unsigned long destinations = 0;
+    unsigned long wireless = 0;
+
+    for (int i = 0; i < getNumberOfIPs(); i++)
+    {
+	SourceStats & ss = noc->searchNode(i)->pe->source_stats;
+
+	packets += ss.getMulticastPackets();
+	destinations += ss.getMulticastDestinations();
+	wireless += ss.getWirelessDestinations();
+    }
+
+    out << "% Multicast packets: " << packets << endl;
+    out << "% Multicast destinations per packet: " << (packets > 0 ? (double) destinations / packets : 0) << endl;
+    out << "% Multicast destinations reached by radio multicast: " << (destinations > 0 ? (double) wireless / destinations : 0) << endl;
+
+    if (!GlobalParams::use_winoc)
+	return;
+
+    unsigned long flits = 0;
+    unsigned long deliveries = 0;
+
+    for (map<int, Channel*>::const_iterator it = noc->channel.begin(); it != noc->channel.end(); it++)
+    {
+	flits += it->second->multicast_flits;
+	deliveries += it->second->multicast_deliveries;
+    }
+
+    out << "% Wireless multicast flits: " << flits << endl;
+    out << "% Wireless transmissions saved by multicast: " << deliveries - flits << endl;
+}
+
+void GlobalStats::showWirelessBondingStats(std::ostream & out)
+{
+    unsigned long packets = 0;
+    unsigned long channels = 0;
+    unsigned long reordered = 0;
+    unsigned long refused = 0;
+    unsigned long flits = 0;
+    double rate = 0;
+
+    out << "wireless_bonding = [" << endl;
+    out << "%	hub	bonded_packets	channels	rate(Gbps)	reordered	max_reassembly	refused" << endl;
+
+    for (map<int, Hub*>::const_iterator it = noc->hub.begin(); it != noc->hub.end(); it++)
+    {
+	Hub * h = it->second;
+
+	out << "	" << it->first << "	" << h->bonded_packets << "	"
+	    << (h->bonded_packets > 0 ? (double) h->bonded_channels / h->bonded_packets : 0) << "	"
+	    << (h->bonded_packets > 0 ? h->bonded_rate / h->bonded_packets : 0) << "	"
+	    << h->reordered_flits << "	" << h->max_reassembly_flits << "	"
+	    << h->reassembly_refusals << endl;
+
+	packets += h->bonded_packets;
+	channels += h->bonded_channels;
+	rate += h->bonded_rate;
+	reordered += h->reordered_flits;
+	flits += h->reassembled_flits;
+	refused += h->reassembly_refusals;
+    }
+    out << "];" << endl;
+
+    out << "% Bonded packets: " << packets << endl;
+    out << "% Channels per bonded packet: " << (packets > 0 ? (double) channels / packets : 0) << endl;
+    out << "% Data rate per bonded packet (Gbps): " << (packets > 0 ? rate / packets : 0) << endl;
+    out << "% Reordered bonded flits: " << (flits > 0 ? (double) reordered / flits : 0) << endl;
+    out << "% Packets not bonded for lack of reassembly storage: " << refused << endl;
+}
+
+void GlobalStats::showAllocatorStats(std::ostream & out)
+{
+    vector <Router *> routers = getRouters();
+    AllocatorStats total;
+
+    out << "allocator_stats = [" << endl;
+    out << "%	router	port	requests	grants	outvc_busy	other_out	stall_ack	stall_full	hol_cycles	max_wait" << endl;
+
+    for (unsigned int k = 0; k < routers.size(); k++)
+    {
+	AllocatorStats & as = routers[k]->allocator_stats;
+
+	for (int i = 0; i < DIRECTION_HUB + GlobalParams::hub_links; i++)
+	{
+	    // skip ports that never carried a flit (e.g. mesh borders)
+	    if (as.requests[i] == 0 && as.hol_cycles[i] == 0)
+		continue;
+
+	    out << "\t" << routers[k]->local_id << "\t" << i << "\t" << as.requests[i] << "\t" << as.grants[i]
+		<< "\t" << as.outvc_busy[i] << "\t" << as.other_out[i]
+		<< "\t" << as.stall_ack[i] << "\t" << as.stall_full[i]
+		<< "\t" << as.hol_cycles[i] << "\t" << as.max_wait[i] << endl;
+
+	    total.requests[i] += as.requests[i];
+	    total.grants[i] += as.grants[i];
+	    total.outvc_busy[i] += as.outvc_busy[i];
+	    total.other_out[i] += as.other_out[i];
+	    total.stall_ack[i] += as.stall_ack[i];
+	    total.stall_full[i] += as.stall_full[i];
+	    total.hol_cycles[i] += as.hol_cycles[i];
+	    total.max_wait[i] = max(total.max_wait[i], as.max_wait[i]);
+	}
+    }
+    out << "];" << endl;
+
+    out << "allocator_stats_port = [" << endl;
+    out << "%	port	requests	grants	outvc_busy	other_out	stall_ack	stall_full	hol_cycles	max_wait" << endl;
+    for (int i = 0; i < DIRECTION_HUB + GlobalParams::hub_links; i++)
+	out << "\t" << i << "\t" << total.requests[i] << "\t" << total.grants[i]
+	    << "\t" << total.outvc_busy[i] << "\t" << total.other_out[i]
+	    << "\t" << total.stall_ack[i] << "\t" << total.stall_full[i]
+	    << "\t" << total.hol_cycles[i] << "\t" << total.max_wait[i] << endl;
+    out << "];" << endl;
+}
+
+void GlobalStats::showLatencyBreakdown(std::ostream & out)
+{
+    vector <Router *> routers = getRouters();
+
+    vector <LatencyStats *> all;
+    for (unsigned int i = 0; i < routers.size(); i++)
+	all.push_back(&routers[i]->latency_stats);
+    for (map<int, Hub*>::const_iterator it = noc->hub.begin(); it != noc->hub.end(); it++)
+	all.push_back(&it->second->latency_stats);
+
+    double total[LAT_NO_COMPONENTS];
+    unsigned long samples[LAT_NO_COMPONENTS];
+    map < pair <int, int>, vector <double> > flows;
+
+    for (int c = 0; c < LAT_NO_COMPONENTS; c++)
+    {
+	total[c] = 0.0;
+	samples[c] = 0;
+    }
+
+    for (unsigned int i = 0; i < all.size(); i++)
+    {
+	for (int c = 0; c < LAT_NO_COMPONENTS; c++)
+	{
+	    total[c] += all[i]->total[c];
+	    samples[c] += all[i]->samples[c];
+	}
+
+	for (map < pair <int, int>, vector <double> >::iterator it = all[i]->flows.begin();
+	     it != all[i]->flows.end(); it++)
+	{
+	    vector <double> & v = flows[it->first];
+	    if (v.empty())
+		v.resize(LAT_NO_COMPONENTS + 1, 0.0);
+	    for (int c = 0; c <= LAT_NO_COMPONENTS; c++)
+		v[c] += it->second[c];
+	}
+    }
+
+    std::streamsize p = out.precision();
+    out.precision(4);
+
+    out << "latency_breakdown = [" << endl;
+    out << "%	samples	avg(cycles)" << endl;
+    for (int c = 0; c < LAT_NO_COMPONENTS; c++)
+	out << "	" << samples[c] << "	" << (samples[c] ? total[c] / samples[c] : 0)
+	    << "	 % " << LatencyStats::getLabel(c) << endl;
+    out << "];" << endl;
+
+    // average cycles spent by a head flit in each component of a node
+    out << "latency_breakdown_router = [" << endl;
+    out << "%	id";
+    for (int c = LAT_ROUTING; c <= LAT_LINK; c++)
+	out << "	" << LatencyStats::getLabel(c);
+    out << endl;
+    for (unsigned int i = 0; i < routers.size(); i++)
+    {
+	LatencyStats & ls = routers[i]->latency_stats;
+	out << "	" << routers[i]->local_id;
+	for (int c = LAT_ROUTING; c <= LAT_LINK; c++)
+	    out << "	" << (ls.samples[c] ? ls.total[c] / ls.samples[c] : 0);
+	out << endl;
+    }
+    out << "];" << endl;
+
+    out << "latency_breakdown_hub = [" << endl;
+    out << "%	id";
+    for (int c = LAT_LINK; c <= LAT_HUB_RX_QUEUEING; c++)
+	out << "	" << LatencyStats::getLabel(c);
+    out << endl;
+    for (map<int, Hub*>::const_iterator it = noc->hub.begin(); it != noc->hub.end(); it++)
+    {
+	LatencyStats & ls = it->second->latency_stats;
+	out << "	" << it->first;
+	for (int c = LAT_LINK; c <= LAT_HUB_RX_QUEUEING; c++)
+	    out << "	" << (ls.samples[c] ? ls.total[c] / ls.samples[c] : 0);
+	out << endl;
+    }
+    out << "];" << endl;
+
+    // average cycles per delivered packet of each component
+    out << "latency_breakdown_flow = [" << endl;
+    out << "%	src	dst	packets";
+    for (int c = 0; c < LAT_NO_COMPONENTS; c++)
+	out << "	" << LatencyStats::getLabel(c);
+    out << endl;
+    for (map < pair <int, int>, vector <double> >::iterator it = flows.begin(); it != flows.end(); it++)
+    {
+	double packets = it->second[LAT_NO_COMPONENTS];
+
+	// packets still in flight at the end of the simulation
+	if (packets == 0)
+	    continue;
+
+	out << "	" << it->first.first << "	" << it->first.second << "	" << packets;
+	for (int c = 0; c < LAT_NO_COMPONENTS; c++)
+	    out << "	" << it->second[c] / packets;
+	out << endl;
+    }
+    out << "];" << endl;
+
+    out.precision(p);
+}
+
 void GlobalStats::showBufferStats(std::ostream & out)
 {
   out << "Router id\tBuffer N\t\tBuffer E\t\tBuffer S\t\tBuffer W\t\tBuffer L" << endl;
@@ -18,6 +18,10 @@
 #include "Tile.h"
 using namespace std;
 
+// The network is considered saturated when it accepts less than this
+// fraction of the offered load
+#define SATURATION_ACCEPTED_RATIO 0.95
+
 class GlobalStats {
 
   public:
@@ -44,6 +48,13 @@ class GlobalStats {
     // Returns tha matrix of max delay for any node of the network
      vector < vector < double > > getMaxDelayMtx();
 
+    // Returns the average packet completion delay (cycles), from packet
+    // generation to the arrival of its last flit
+    double getAveragePacketDelay();
+
+    // Returns the max packet completion delay (cycles)
+    double getMaxPacketDelay();
+
     // Returns the aggregated average throughput (flits/cycles)
     double getAggregatedThroughput();
 
@@ -53,6 +64,30 @@ class GlobalStats {
     // Returns the average throughput considering only a active IP (flit/cycles/IP)
     double getActiveThroughput();
 
+    // Returns the load offered by the sources (flits/cycle/IP)
+    double getOfferedLoad();
+
+    // Returns the load offered by src_id (flits/cycle)
+    double getOfferedLoad(const int src_id);
+
+    // Returns the load generated by src_id and accepted by the network,
+    // i.e. delivered to any destination (flits/cycle)
+    double getAcceptedLoad(const int src_id);
+
+    // Returns the average number of flits waiting in the source
+    // queues (flits/IP)
+    double getAverageBacklog();
+
+    // Returns the max number of flits waiting in a source queue
+    unsigned long getMaxBacklog();
+
+    // Returns the growth of the source backlog along the measured
+    // window, summed over all the sources (flits)
+    long getBacklogGrowth();
+
+    // Returns true when the network cannot sustain the offered load
+    bool isSaturated();
+
     // Returns the aggregated average throughput (flits/cycles) for
     // communication src_id->dst_id
     double getAverageThroughput(const int src_id, const int dst_id);
@@ -83,11 +118,41 @@ class GlobalStats {
 
     void showBufferStats(std::ostream & out);
 
+    // Shows offered and accepted load and backlog of each source
+    void showSourceStats(std::ostream & out);
+
 
     void showPowerBreakDown(std::ostream & out);
 
+    // Shows the fraction of cycles the hub buffers and transceivers are
+    // off and, with a sleep policy, its energy saved and latency added
     void showPowerManagerStats(std::ostream & out);
 
+    // Shows the allocation and contention counters of the routers
+    void showAllocatorStats(std::ostream & out);
+
+    // Shows gating events, leakage saved and wake-up costs of the routers
+    void showPowerGatingStats(std::ostream & out);
+
+    // Shows MAC, tokens, transmissions, collisions, utilization and
+    // access delay of the radio channels
+    void showWirelessMacStats(std::ostream & out);
+
+    // Shows the flits corrupted on the radio channels, their
+    // retransmissions and the resulting goodput
+    void showWirelessArqStats(std::ostream & out);
+
+    // Shows the packets striped over several radio channels, their
+    // channels and data rate, and the flits reordered by the receivers
+    void showWirelessBondingStats(std::ostream & out);
+
+    // Shows the multicast packets, how many of their destinations were
+    // reached by a radio multicast and the transmissions it saved
+    void showMulticastStats(std::ostream & out);
+
+    // Shows the per-hop decomposition of the packet latency
+    void showLatencyBreakdown(std::ostream & out);
+
     double getReceivedIdealFlitRatio();
 
 
@@ -98,6 +163,8 @@ class GlobalStats {
 
   private:
     const NoC *noc;
+    int getNumberOfIPs();
+    vector <Router *> getRouters();
     void updatePowerBreakDown(map<string,double> &dst,PowerBreakdown* src);
 };
 
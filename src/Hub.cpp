@@ -9,25 +9,38 @@
  * to forward configuration to every sub-block
  */
 #include "Hub.h"
+#include "Profiler.h"
+#include "WirelessPaths.h"
+
+int Hub::next_bond_id = 0;
 
 int Hub::tile2Port(int id)
 {
-	// TODO: check all [..] map access to replace with at()
-	return tile2port_mapping.at(id);
+	int port = tile2port_mapping.at(id);
+
+	assert(port != NOT_VALID);
+	return port;
 }
 
 int Hub::route(Flit& f)
 {
-	// check if it is a local delivery
-	for (vector<int>::size_type i=0; i< GlobalParams::hub_configuration[local_id].attachedNodes.size();i++)
+	if (!f.multicast.empty())
+		return DIRECTION_WIRELESS;
+
+	// check if it is a local delivery (the tiles attached to several
+	// hubs receive from their primary one only)
+	for (vector<int>::size_type i=0; i< attachedNodes.size();i++)
 	{
+		if (tile2Hub(attachedNodes[i]) != local_id)
+			continue;
+
 		// ...to a destination which is connected to the Hub
-		if (GlobalParams::hub_configuration[local_id].attachedNodes[i]==f.dst_id)
+		if (attachedNodes[i]==f.dst_id)
 		{
 			return tile2Port(f.dst_id);
 		}
 		// ...or to a relay which is locally connected to the Hub
-		if (GlobalParams::hub_configuration[local_id].attachedNodes[i]==f.hub_relay_node)
+		if (attachedNodes[i]==f.hub_relay_node)
 		{
 			assert(GlobalParams::winoc_dst_hops>0);
 			return tile2Port(f.hub_relay_node);
@@ -42,41 +55,44 @@ int Hub::route(Flit& f)
 void Hub::rxPowerManager()
 {
 	// Check wheter accounting or not buffer to tile leakage
-	// For each port, two poweroff condition should be checked:
+	// For each port and VC, two poweroff condition should be checked:
 	// - the buffer to tile is empty
 	// - it has not been reserved
-
-	// currently only supported without VC
-	assert(GlobalParams::n_virtual_channels==1);
-
 	for (int port=0;port<num_ports;port++)
-	{
-		if (!buffer_to_tile[port][DEFAULT_VC].IsEmpty() ||
-			antenna2tile_reservation_table.isNotReserved(port))
-			power.leakageBufferToTile();
+		for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
+		{
+			if (!buffer_to_tile[port][vc].IsEmpty() ||
+				!antenna2tile_reservation_table.isNotReserved(port, vc))
+				power.leakageBufferToTile();
 
-		else
-			buffer_to_tile_poweroff_cycles[port]++;
-	}
+			else
+				buffer_to_tile_poweroff_cycles[port]++;
+		}
 
 
 	for (unsigned int i=0;i<rxChannels.size();i++)
 	{
-		int ch_id = rxChannels[i];
-
-		if (!target[ch_id]->buffer_rx.IsEmpty())
+		if (!target[i]->buffer_rx.IsEmpty())
 		{
 			power.leakageAntennaBuffer();
 		}
 		else
-			buffer_rx_sleep_cycles[ch_id]++;
+			buffer_rx_sleep_cycles[i]++;
 	}
 
 	// Check wheter accounting antenna RX buffer
 	// check if there is at least one not empty antenna RX buffer
 	// To be only applied if the current hub is in RADIO_EVENT_SLEEP_ON mode
 
-	if (power.isSleeping())
+	if (GlobalParams::wireless_sleep_policy != SLEEP_NONE)
+	{
+		// the receiver is needed while receiving packets
+		rx_sleep.cycle(rx_open_packets > 0 || rx_flit_received);
+		rx_flit_received = false;
+		accountWakeups();
+	}
+
+	if (rxSleeping())
 		total_sleep_cycles++;
 
 	else // not sleeping
@@ -90,7 +106,7 @@ void Hub::rxPowerManager()
 
 void Hub::updateRxPower()
 {
-	if (GlobalParams::use_powermanager)
+	if (GlobalParams::use_powermanager || GlobalParams::wireless_sleep_policy != SLEEP_NONE)
 		rxPowerManager();
 	else
 	{
@@ -98,25 +114,25 @@ void Hub::updateRxPower()
 		power.leakageTransceiverRx();
 		power.biasingRx();
 
-		for (unsigned int i=0;i<rxChannels.size();i++)
-			for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
-				power.leakageAntennaBuffer();
-
-		for (int i = 0; i < num_ports; i++)
-			for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
-				power.leakageBufferToTile();
+		power.leakageAntennaBuffer(rxChannels.size() * GlobalParams::n_virtual_channels);
+		power.leakageBufferToTile(num_ports * GlobalParams::n_virtual_channels);
 	}
 }
 
 void Hub::txPowerManager()
 {
+	bool tx_busy = false;
+
 	for (unsigned int i=0;i<txChannels.size();i++)
 	{
 		// check if not empty or reserved
 		if (!init[i]->buffer_tx.IsEmpty() ||
-			tile2antenna_reservation_table.isNotReserved(i) )
+			!tile2antenna_reservation_table.isNotReserved(i) )
 		{
+			tx_busy = true;
 			power.leakageAntennaBuffer();
+			if (!GlobalParams::use_powermanager)
+				continue;
 			// check the second condition for turning off analog tx
 			if (power.isSleeping())
 			{
@@ -132,21 +148,42 @@ void Hub::txPowerManager()
 		{   // abtx is empty and not reserved - turn off
 			// note that this also applies to analog tx and serializer
 			abtxoff_cycles[i]++;
+			if (!GlobalParams::use_powermanager)
+				continue;
 			analogtxoff_cycles[i]++;
 			total_ttxoff_cycles++;
 		}
 	}
+
+	if (GlobalParams::use_powermanager)
+		return;
+
+	// transceiver sleep policy: a single transmitter for all the channels
+	for (unsigned int i=0;i<txChannels.size();i++)
+		tx_busy = tx_busy || transmission_in_progress[i];
+	tx_sleep.cycle(tx_busy);
+	accountWakeups();
+
+	if (tx_sleep.isOff())
+	{
+		total_ttxoff_cycles++;
+		for (unsigned int i=0;i<txChannels.size();i++)
+			analogtxoff_cycles[i]++;
+	}
+	else
+	{
+		power.leakageTransceiverTx();
+		power.biasingTx();
+	}
 }
 
 void Hub::updateTxPower()
 {
-	if (GlobalParams::use_powermanager)
+	if (GlobalParams::use_powermanager || GlobalParams::wireless_sleep_policy != SLEEP_NONE)
 		txPowerManager();
 	else
 	{
-		for (unsigned int i=0;i<txChannels.size();i++)
-			for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
-				power.leakageAntennaBuffer();
+		power.leakageAntennaBuffer(txChannels.size() * GlobalParams::n_virtual_channels);
 
 		power.leakageTransceiverTx();
 		power.biasingTx();
@@ -154,60 +191,140 @@ void Hub::updateTxPower()
 
 	// mandatory
 	power.leakageLinkRouter2Hub();
-	for (int i = 0; i < num_ports; i++)
-		for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
-			power.leakageBufferFromTile();
+	power.leakageBufferFromTile(num_ports * GlobalParams::n_virtual_channels);
+}
+
+bool Hub::rxSleeping()
+{
+	if (GlobalParams::use_powermanager)
+		return power.isSleeping();
+
+	return GlobalParams::wireless_sleep_policy != SLEEP_NONE && !rx_sleep.isOn();
+}
+
+void Hub::accountWakeups()
+{
+	unsigned long wakeups = rx_sleep.wakeups + rx_sleep.early_wakeups +
+		tx_sleep.wakeups + tx_sleep.early_wakeups;
+
+	for (; accounted_wakeups < wakeups; accounted_wakeups++)
+		power.wirelessWakeup();
+}
+
+void Hub::configureSleep()
+{
+	rx_sleep.configure(power.getStaticEnergy(TRANSCEIVER_RX_PWR_S) + power.getStaticEnergy(TRANSCEIVER_RX_PWR_BIASING));
+	tx_sleep.configure(power.getStaticEnergy(TRANSCEIVER_TX_PWR_S) + power.getStaticEnergy(TRANSCEIVER_TX_PWR_BIASING));
+}
+
+
+double Hub::expectedWait(int tx) const
+{
+	return token_ring->tokenWait(txChannels[tx], local_id) +
+		(double) init[tx]->buffer_tx.Size() * arqFlitCycles(flit_transmission_cycles[tx]);
+}
+
+int Hub::fromTileFlits(int tile)
+{
+	int port = tile2Port(tile);
+	int flits = 0;
+
+	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		flits += buffer_from_tile[port][vc].Size();
+	return flits;
+}
+
+double Hub::wirelessLatency(int dst_hub, int length)
+{
+	assert(dst_hub < (int)tx_to_hub.size() && !tx_to_hub[dst_hub].empty() && "hubs are not connected by any channel");
+
+	const vector<int> & candidates = tx_to_hub[dst_hub];
+	double best = NOT_VALID;
+
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	{
+		int tx = candidates[i];
+		double latency = expectedWait(tx) + (double) length * arqFlitCycles(flit_transmission_cycles[tx]);
+
+		// the flits are spread over the bonded channels, at their
+		// aggregate rate
+		if (GlobalParams::wireless_bonding > 1)
+		{
+			vector<int> bonded = bondCandidates(tx, dst_hub);
+			double flits_per_cycle = 0;
+
+			for (unsigned int k = 0; k < bonded.size(); k++)
+				flits_per_cycle += 1.0 / arqFlitCycles(flit_transmission_cycles[bonded[k]]);
+			latency = expectedWait(tx) + length / flits_per_cycle;
+		}
+
+		if (best == NOT_VALID || latency < best)
+			best = latency;
+	}
+
+	return best;
 }
 
+int Hub::tokenHoldCycles(int tx)
+{
+	int expiration = current_token_expiration[tx]->read();
 
-void Hub::txRadioProcessTokenPacket(int channel)
+	if (expiration == NOT_VALID)
+		return 0;
+
+	// cycles left as counted by the token ring at the previous cycle
+	int cycle = (int)(sc_time_stamp().to_double() / GlobalParams::clock_period_ps);
+	return expiration - (cycle - 1);
+}
+
+void Hub::txRadioProcessTokenPacket(int tx)
 {
-    int current_holder = current_token_holder[channel]->read();
-    int current_channel_flag =flag[channel]->read();
+	int current_holder = current_token_holder[tx]->read();
+	int current_channel_flag = flag[tx]->read();
 
 	if ( current_holder == local_id && current_channel_flag !=RELEASE_CHANNEL)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[tx]->buffer_tx.IsEmpty())
 		{
-			Flit flit = init[channel]->buffer_tx.Front();
+			Flit flit = init[tx]->buffer_tx.Front();
 
 			// TODO: check whether it would make sense to use transmission_in_progress to
 			// avoid multiple notify()
-			LOG << "*** [Ch"<<channel<<"] Requesting transmission event of flit " << flit << endl;
-			init[channel]->start_request_event.notify();
+			LOG << "*** [Ch"<<txChannels[tx]<<"] Requesting transmission event of flit " << flit << endl;
+			init[tx]->start_request_event.notify();
 		}
 		else
 		{
-			if (!transmission_in_progress.at(channel))
+			if (!transmission_in_progress[tx] && tx_bond[tx] == NOT_VALID)
 			{
-				LOG << "*** [Ch"<<channel<<"] Buffer_tx empty and no trasmission in progress, releasing token" << endl;
-				flag[channel]->write(RELEASE_CHANNEL);
+				LOG << "*** [Ch"<<txChannels[tx]<<"] Buffer_tx empty and no trasmission in progress, releasing token" << endl;
+				flag[tx]->write(RELEASE_CHANNEL);
 			}
 			else
-				LOG << "*** [Ch"<<channel<<"] Buffer_tx empty, but trasmission in progress, holding token" << endl;
+				LOG << "*** [Ch"<<txChannels[tx]<<"] Buffer_tx empty, but trasmission in progress, holding token" << endl;
 		}
 	}
 }
 
-void Hub::txRadioProcessTokenHold(int channel)
+void Hub::txRadioProcessTokenHold(int tx)
 {
-	if (flag[channel]->read()==RELEASE_CHANNEL)
-		flag[channel]->write(HOLD_CHANNEL);
+	if (flag[tx]->read()==RELEASE_CHANNEL)
+		flag[tx]->write(HOLD_CHANNEL);
 
-	if (current_token_holder[channel]->read() == local_id)
+	if (current_token_holder[tx]->read() == local_id)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[tx]->buffer_tx.IsEmpty())
 		{
 			//LOG << "Token holder for channel " << channel << " with not empty buffer_tx" << endl;
-			if (current_token_expiration[channel]->read() < flit_transmission_cycles[channel])
+			if (tokenHoldCycles(tx) < flit_transmission_cycles[tx])
 			{
 				//LOG << "TOKEN_HOLD policy: Not enough token expiration time for sending channel " << channel << endl;
 			}
 			else
 			{
-				flag[channel]->write(HOLD_CHANNEL);
-				LOG << "*** [Ch" << channel << "] Starting transmission event" << endl;
-				init[channel]->start_request_event.notify();
+				flag[tx]->write(HOLD_CHANNEL);
+				LOG << "*** [Ch" << txChannels[tx] << "] Starting transmission event" << endl;
+				init[tx]->start_request_event.notify();
 			}
 		}
 		else
@@ -217,39 +334,66 @@ void Hub::txRadioProcessTokenHold(int channel)
 	}
 }
 
-void Hub::txRadioProcessTokenMaxHold(int channel)
+void Hub::txRadioProcessTokenMaxHold(int tx)
 {
-	if (flag[channel]->read()==RELEASE_CHANNEL)
-		flag[channel]->write(HOLD_CHANNEL);
+	if (flag[tx]->read()==RELEASE_CHANNEL)
+		flag[tx]->write(HOLD_CHANNEL);
 
-	if (current_token_holder[channel]->read() == local_id)
+	if (current_token_holder[tx]->read() == local_id)
 	{
-		if (!init[channel]->buffer_tx.IsEmpty())
+		if (!init[tx]->buffer_tx.IsEmpty())
 		{
 			//LOG << "Token holder for channel " << channel << " with not empty buffer_tx" << endl;
 
-			if (current_token_expiration[channel]->read() < flit_transmission_cycles[channel])
+			if (tokenHoldCycles(tx) < flit_transmission_cycles[tx])
 			{
 				//LOG << "TOKEN_MAX_HOLD: Not enough token expiration time, releasing token for channel " << channel << endl;
-				flag[channel]->write(RELEASE_CHANNEL);
+				flag[tx]->write(RELEASE_CHANNEL);
 			}
 			else
 			{
-				flag[channel]->write(HOLD_CHANNEL);
-				LOG << "Starting transmission on channel " << channel << endl;
-				init[channel]->start_request_event.notify();
+				flag[tx]->write(HOLD_CHANNEL);
+				LOG << "Starting transmission on channel " << txChannels[tx] << endl;
+				init[tx]->start_request_event.notify();
 			}
 		}
 		else
 		{
 			//LOG << "TOKEN_MAX_HOLD: Buffer_tx empty, releasing token for channel " << channel << endl;
-			flag[channel]->write(RELEASE_CHANNEL);
+			flag[tx]->write(RELEASE_CHANNEL);
 		}
 	}
 }
 
+void Hub::txRadioProcessTDMA(int tx)
+{
+	if (current_token_holder[tx]->read() != local_id || init[tx]->buffer_tx.IsEmpty())
+		return;
+
+	// a packet starts only if it fits in the rest of the slot
+	Flit flit = init[tx]->buffer_tx.Front();
+	int cycles = arqFlitCycles(flit_transmission_cycles[tx]);
+	if (flit.flit_type == FLIT_TYPE_HEAD)
+		cycles *= flit.sequence_length;
+
+	if (tokenHoldCycles(tx) >= cycles)
+	{
+		LOG << "*** [Ch" << txChannels[tx] << "] Starting transmission event" << endl;
+		init[tx]->start_request_event.notify();
+	}
+}
+
+void Hub::txRadioProcessCSMA(int tx)
+{
+	// the initiator senses the carrier and backs off
+	if (!init[tx]->buffer_tx.IsEmpty())
+		init[tx]->start_request_event.notify();
+}
+
 void Hub::antennaToTileProcess()
 {
+	PROFILE(PROF_HUB_ANTENNA_TO_TILE);
+
 	if (reset.read())
 	{
 		for (int i = 0; i < num_ports; i++)
@@ -296,13 +440,26 @@ void Hub::antennaToTileProcess()
 				{
 					LOG << "Flit " << flit << " moved from buffer_to_tile[" << i <<"][" << vc << "] to signal flit_tx["<<i<<"] " << endl;
 
+					if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+					{
+						double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+						latency_stats.account(flit, LAT_HUB_RX_QUEUEING, now - flit.hop_time);
+						flit.hop_time = now;
+					}
+
 					flit_tx[i].write(flit);
 					current_level_tx[i] = 1 - current_level_tx[i];
 					req_tx[i].write(current_level_tx[i]);
 
 					buffer_to_tile[i][vc].Pop();
 					power.bufferToTilePop();
-					power.r2hLink();
+					if (GlobalParams::payload_energy)
+					{
+						power.r2hLink(flit.payload.toggles(last_tx_payload[i]));
+						last_tx_payload[i] = flit.payload;
+					}
+					else
+						power.r2hLink();
 					break; // port flit transmitted, skip remaining VCs
 				}
 				else
@@ -325,13 +482,15 @@ void Hub::antennaToTileProcess()
 	{
 		int channel = rxChannels[i];
 
-		if (!(target[channel]->buffer_rx.IsEmpty()))
+		if (!(target[i]->buffer_rx.IsEmpty()))
 		{
-			Flit received_flit = target[channel]->buffer_rx.Front();
+			Flit received_flit = target[i]->buffer_rx.Front();
 			power.antennaBufferFront();
 
 			// Check antenna buffer_rx making appropriate reservations
-			if (received_flit.flit_type==FLIT_TYPE_HEAD)
+			if (received_flit.flit_type==FLIT_TYPE_HEAD && !received_flit.multicast.empty())
+				reserveMulticast(i, received_flit);
+			else if (received_flit.flit_type==FLIT_TYPE_HEAD)
 			{
 				int dst_port;
 
@@ -341,7 +500,7 @@ void Hub::antennaToTileProcess()
                     dst_port = tile2Port(received_flit.dst_id);
 
 				TReservation r;
-				r.input = channel;
+				r.input = i;
 				r.vc = received_flit.vc_id;
 
 				LOG << " Checking reservation availability of output port " << dst_port << " by channel " << channel << " for flit " << received_flit << endl;
@@ -374,8 +533,14 @@ void Hub::antennaToTileProcess()
 	// forwarding
 	for (unsigned int i = 0; i < rxChannels.size(); i++)
 	{
+		if (!multicast_nodes[i].empty())
+		{
+			forwardMulticast(i);
+			continue;
+		}
+
 		int channel = rxChannels[i];
-		vector<pair<int,int> > reservations = antenna2tile_reservation_table.getReservations(channel);
+		vector<pair<int,int> > reservations = antenna2tile_reservation_table.getReservations(i);
 
 		if (reservations.size()!=0)
 		{
@@ -384,14 +549,14 @@ void Hub::antennaToTileProcess()
 			int port = reservations[rnd_idx].first;
 			int vc = reservations[rnd_idx].second;
 
-			if (!(target[channel]->buffer_rx.IsEmpty()))
+			if (!(target[i]->buffer_rx.IsEmpty()))
 			{
-				Flit received_flit = target[channel]->buffer_rx.Front();
+				Flit received_flit = target[i]->buffer_rx.Front();
 				power.antennaBufferFront();
 
 				if ( !buffer_to_tile[port][vc].IsFull() )
 				{
-					target[channel]->buffer_rx.Pop();
+					target[i]->buffer_rx.Pop();
 					power.antennaBufferPop();
 					LOG << "*** [Ch" << channel << "] Moving flit  " << received_flit << " from buffer_rx to buffer_to_tile[" << port <<"][" << vc << "]" << endl;
 
@@ -402,7 +567,7 @@ void Hub::antennaToTileProcess()
 					{
 						LOG << "Releasing reservation for output port " << port << ", flit " << received_flit << endl;
 						TReservation r;
-						r.input = channel;
+						r.input = i;
 						r.vc = vc;
 						antenna2tile_reservation_table.release(r,port);
 					}
@@ -414,16 +579,21 @@ void Hub::antennaToTileProcess()
 			{
 				// should be ok
 				/*
-                LOG << "WARNING: empty target["<<channel<<"] buffer_rx, but reservation still present, if correct, remove assertion below " << endl;
+                LOG_WARNING << "WARNING: empty target["<<channel<<"] buffer_rx, but reservation still present, if correct, remove assertion below " << endl;
                 assert(false);
                 */
 			}
 		}
 	}
+
+	if (!reassembly.empty())
+		forwardBonded();
 }
 
 void Hub::tileToAntennaProcess()
 {
+	PROFILE(PROF_HUB_TILE_TO_ANTENNA);
+
 	// double cycle = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
 	// if (cycle > 0 && cycle < 58428)
 	// {
@@ -440,10 +610,7 @@ void Hub::tileToAntennaProcess()
 	if (reset.read())
 	{
 		for (unsigned int i =0 ;i<txChannels.size();i++)
-		{
-			int channel = txChannels[i];
-			flag[channel]->write(HOLD_CHANNEL);
-		}
+			flag[i]->write(HOLD_CHANNEL);
 
 		TBufferFullStatus bfs;
 		for (int i = 0; i < num_ports; i++)
@@ -457,27 +624,31 @@ void Hub::tileToAntennaProcess()
 
 	for (unsigned int i =0 ;i<txChannels.size();i++)
 	{
-		int channel = txChannels[i];
-
-		string macPolicy = token_ring->getPolicy(channel).first;
-
-		if (macPolicy == TOKEN_PACKET)
-			txRadioProcessTokenPacket(channel);
-		else if (macPolicy == TOKEN_HOLD)
-			txRadioProcessTokenHold(channel);
-		else if (macPolicy == TOKEN_MAX_HOLD)
-			txRadioProcessTokenMaxHold(channel);
-		else
+		switch (mac_policy[i])
+		{
+		case MAC_TOKEN_PACKET:
+			txRadioProcessTokenPacket(i);
+			break;
+		case MAC_TOKEN_HOLD:
+			txRadioProcessTokenHold(i);
+			break;
+		case MAC_TOKEN_MAX_HOLD:
+			txRadioProcessTokenMaxHold(i);
+			break;
+		case MAC_TDMA:
+		case MAC_TDMA_WEIGHTED:
+			txRadioProcessTDMA(i);
+			break;
+		case MAC_CSMA:
+			txRadioProcessCSMA(i);
+			break;
+		default:
 			assert(false);
+		}
 	}
 
 	int last_reserved = NOT_VALID;
 
-	// used to store routing decisions
-	int * r_from_tile[num_ports];
-	for (int i=0;i<num_ports;i++)
-		r_from_tile[i] = new int[GlobalParams::n_virtual_channels];
-
 	// 1st phase: Reservation
 	for (int j = 0; j < num_ports; j++)
 	{
@@ -506,23 +677,34 @@ void Hub::tileToAntennaProcess()
 
 					assert(r_from_tile[i][vc]==DIRECTION_WIRELESS);
 					int channel;
+					int dst_hub = NOT_VALID;
 
-					if (flit.hub_relay_node==NOT_VALID)
-						channel = selectChannel(local_id, tile2Hub(flit.dst_id));
+					if (!flit.multicast.empty())
+						channel = selectChannel(multicastChannels(flit.multicast));
 					else
-						channel = selectChannel(local_id, tile2Hub(flit.hub_relay_node));
+					{
+						if (flit.hub_relay_node==NOT_VALID)
+							dst_hub = tile2Hub(flit.dst_id);
+						else
+							dst_hub = tile2Hub(flit.hub_relay_node);
+						channel = selectChannel(dst_hub);
+					}
 
 
 					assert(channel!=NOT_VALID && "hubs are not connected by any channel");
+					int tx = tx_index[channel];
 
 					LOG << "Checking reservation availability of Channel " << channel << " by Hub port[" << i << "][" << vc << "] for flit " << flit << endl;
 
-					int rt_status = tile2antenna_reservation_table.checkReservation(r,channel);
+					int rt_status = tile2antenna_reservation_table.checkReservation(r,tx);
 
 					if (rt_status == RT_AVAILABLE)
 					{
 						LOG << "Reservation of channel " << channel << " from Hub port["<< i << "]["<<vc<<"] by flit " << flit << endl;
-						tile2antenna_reservation_table.reserve(r, channel);
+						tile2antenna_reservation_table.reserve(r, tx);
+
+						if (GlobalParams::wireless_bonding > 1 && dst_hub != NOT_VALID)
+							bondChannels(i, flit, tx, dst_hub);
 					}
 					else if (rt_status == RT_ALREADY_SAME)
 					{
@@ -565,22 +747,50 @@ void Hub::tileToAntennaProcess()
 
 				assert(r_from_tile[i][vc] == DIRECTION_WIRELESS);
 
-				int channel =  o;
+				int tx = o;
+
+				// the flits of a bonded packet are spread over its channels
+				if (!bond_tx[i][vc].empty())
+				{
+					tx = bondedChannel(i, vc, flit);
+					flit.bond_id = bond_id[i][vc];
+					flit.hub_relay_node = bond_relay[i][vc];
+				}
 
-				if (channel != NOT_RESERVED)
+				if (tx != NOT_RESERVED)
 				{
-					if (!(init[channel]->buffer_tx.IsFull()) )
+					int channel = txChannels[tx];
+
+					if (!init[tx]->isFull())
 					{
 						buffer_from_tile[i][vc].Pop();
 						power.bufferFromTilePop();
-						init[channel]->buffer_tx.Push(flit);
+						if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+						{
+							double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+							latency_stats.account(flit, LAT_HUB_TX_QUEUEING, now - flit.hop_time);
+							flit.hop_time = now;
+						}
+						init[tx]->queue(flit);
 						power.antennaBufferPush();
+						if (mac_policy[tx] == MAC_TDMA_WEIGHTED)
+							token_ring->accountDemand(channel, local_id);
 						if (flit.flit_type == FLIT_TYPE_TAIL)
 						{
 							TReservation r;
 							r.input = i;
 							r.vc = vc;
-							tile2antenna_reservation_table.release(r,channel);
+							if (bond_tx[i][vc].empty())
+								tile2antenna_reservation_table.release(r,tx);
+							else
+							{
+								for (unsigned int k = 0; k < bond_tx[i][vc].size(); k++)
+								{
+									tile2antenna_reservation_table.release(r,bond_tx[i][vc][k]);
+									tx_bond[bond_tx[i][vc][k]] = NOT_VALID;
+								}
+								bond_tx[i][vc].clear();
+							}
 						}
 
 						LOG << "Flit " << flit << " moved from buffer_from_tile["<<i<<"]["<<vc<<"]  to buffer_tx["<<channel<<"] " << endl;
@@ -621,6 +831,13 @@ void Hub::tileToAntennaProcess()
 			{
 				LOG << "Storing " << received_flit << " on buffer_from_tile[" << i << "][" << vc << "]" << endl;
 
+				if (GlobalParams::latency_breakdown && received_flit.flit_type == FLIT_TYPE_HEAD)
+				{
+					double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+					latency_stats.account(received_flit, LAT_LINK, now - received_flit.hop_time);
+					received_flit.hop_time = now;
+				}
+
 				buffer_from_tile[i][vc].Push(received_flit);
 				power.bufferFromTilePush();
 
@@ -645,46 +862,407 @@ void Hub::tileToAntennaProcess()
 	updateTxPower();
 }
 
-int Hub::selectChannel(int src_hub, int dst_hub) const
+void Hub::reserveMulticast(int rx, const Flit & flit)
 {
-	vector<int> & first = GlobalParams::hub_configuration[src_hub].txChannels;
-	vector<int> & second = GlobalParams::hub_configuration[dst_hub].rxChannels;
+	if (!multicast_nodes[rx].empty())
+		return;
+
+	// the destinations attached to the hub, which receive from their
+	// primary one only
+	vector<int> nodes, ports;
+	vector<int> destinations = flit.multicast.nodes();
+	for (unsigned int k = 0; k < destinations.size(); k++)
+		if (tile2Hub(destinations[k]) == local_id)
+		{
+			nodes.push_back(destinations[k]);
+			ports.push_back(tile2Port(destinations[k]));
+		}
+	assert(!nodes.empty());
 
-	vector<int> intersection;
+	TReservation r;
+	r.input = rx;
+	r.vc = flit.vc_id;
 
-	for (unsigned int i=0;i<first.size();i++)
+	// all or none, so that two multicast packets cannot hold part of
+	// the ports the other waits for
+	for (unsigned int k = 0; k < ports.size(); k++)
 	{
-		for (unsigned int j=0;j<second.size();j++)
+		int rt_status = antenna2tile_reservation_table.checkReservation(r, ports[k]);
+
+		if (rt_status != RT_AVAILABLE)
 		{
-			if (first[i] ==second[j])
-				intersection.push_back(first[i]);
+			LOG << " Output port " << ports[k] << " not available for multicast flit " << flit << " (" << rt_status << ")" << endl;
+			return;
 		}
 	}
 
-	if (intersection.size()==0)
+	LOG << "Reserving " << ports.size() << " output ports by channel " << rxChannels[rx] << " for multicast flit " << flit << endl;
+	for (unsigned int k = 0; k < ports.size(); k++)
+		antenna2tile_reservation_table.reserve(r, ports[k], true);
+	multicast_nodes[rx] = nodes;
+
+	wireless_communications_counter++;
+}
+
+void Hub::forwardMulticast(int rx)
+{
+	if (target[rx]->buffer_rx.IsEmpty())
+		return;
+
+	Flit received_flit = target[rx]->buffer_rx.Front();
+	power.antennaBufferFront();
+
+	int vc = received_flit.vc_id;
+	vector<int> & nodes = multicast_nodes[rx];
+	vector<int> ports;
+	for (unsigned int k = 0; k < nodes.size(); k++)
+		ports.push_back(tile2Port(nodes[k]));
+	vector<pair<int,int> > reservations = antenna2tile_reservation_table.getReservations(rx);
+
+	// each port must be granted to the packet and have room for the copy
+	for (unsigned int k = 0; k < ports.size(); k++)
+		if (find(reservations.begin(), reservations.end(), make_pair(ports[k], vc)) == reservations.end() ||
+			buffer_to_tile[ports[k]][vc].IsFull())
+		{
+			LOG << "Cannot replicate multicast flit " << received_flit << " to buffer_to_tile[" << ports[k] << "][" << vc << "]" << endl;
+			return;
+		}
+
+	target[rx]->buffer_rx.Pop();
+	power.antennaBufferPop();
+	LOG << "*** [Ch" << rxChannels[rx] << "] Replicating multicast flit " << received_flit << " to " << ports.size() << " ports" << endl;
+
+	for (unsigned int k = 0; k < ports.size(); k++)
+	{
+		Flit copy = received_flit;
+		copy.dst_id = nodes[k];
+		copy.multicast.clear();
+		buffer_to_tile[ports[k]][vc].Push(copy);
+		power.bufferToTilePush();
+	}
+
+	if (received_flit.flit_type == FLIT_TYPE_TAIL)
+	{
+		TReservation r;
+		r.input = rx;
+		r.vc = vc;
+		for (unsigned int k = 0; k < ports.size(); k++)
+			antenna2tile_reservation_table.release(r, ports[k]);
+		nodes.clear();
+	}
+}
+
+vector<int> Hub::bondCandidates(int tx, int dst_hub)
+{
+	vector<int> bonded(1, tx);
+	vector<pair<double,int> > spare;
+
+	for (unsigned int i = 0; i < tx_to_hub[dst_hub].size(); i++)
+	{
+		int k = tx_to_hub[dst_hub][i];
+		if (k != tx && tile2antenna_reservation_table.isNotReserved(k))
+			spare.push_back(make_pair(expectedWait(k), k));
+	}
+	sort(spare.begin(), spare.end());
+
+	for (unsigned int i = 0; i < spare.size() && (int)bonded.size() < GlobalParams::wireless_bonding; i++)
+		bonded.push_back(spare[i].second);
+
+	return bonded;
+}
+
+void Hub::bondChannels(int port, const Flit & head, int tx, int dst_hub)
+{
+	vector<int> bonded = bondCandidates(tx, dst_hub);
+
+	if (bonded.size() < 2)
+		return;
+
+	Hub * dst = WirelessPaths::getHubModule(dst_hub);
+
+	if (!dst->reserveReassembly(next_bond_id, head.sequence_length))
+	{
+		LOG << "Reassembly storage of HUB_" << dst_hub << " full, packet of flit " << head << " not striped" << endl;
+		return;
+	}
+
+	TReservation r;
+	r.input = port;
+	r.vc = head.vc_id;
+
+	for (unsigned int k = 1; k < bonded.size(); k++)
+		tile2antenna_reservation_table.reserve(r, bonded[k], true);
+
+	bond_tx[port][r.vc] = bonded;
+	bond_id[port][r.vc] = next_bond_id++;
+	for (unsigned int k = 0; k < bonded.size(); k++)
+		tx_bond[bonded[k]] = bond_id[port][r.vc];
+	bond_relay[port][r.vc] = head.hub_relay_node;
+
+	bonded_packets++;
+	bonded_channels += bonded.size();
+	for (unsigned int k = 0; k < bonded.size(); k++)
+		bonded_rate += GlobalParams::channel_configuration[txChannels[bonded[k]]].dataRate;
+
+	LOG << "Packet of flit " << head << " striped over " << bonded.size() << " channels to HUB_" << dst_hub << endl;
+}
+
+int Hub::bondedChannel(int port, int vc, const Flit & flit)
+{
+	const vector<int> & bonded = bond_tx[port][vc];
+
+	if (flit.flit_type == FLIT_TYPE_HEAD)
+		return bonded[0];
+
+	int tx = NOT_VALID;
+	double best = 0;
+
+	for (unsigned int k = 0; k < bonded.size(); k++)
+	{
+		if (init[bonded[k]]->isFull())
+			continue;
+
+		double wait = expectedWait(bonded[k]);
+		if (tx == NOT_VALID || wait < best)
+		{
+			tx = bonded[k];
+			best = wait;
+		}
+	}
+
+	// all full, the flit waits for the first one
+	return tx == NOT_VALID ? bonded[0] : tx;
+}
+
+bool Hub::reserveReassembly(const int bond_id, const int length)
+{
+	// admitting a packet only when its first flit arrives would let the
+	// flits refused for lack of room hold the channels (and tokens) that
+	// the missing flits of the admitted packets have to take
+	int size = max(GlobalParams::hub_configuration[local_id].rxBufferSize * GlobalParams::wireless_bonding,
+		       GlobalParams::max_packet_size);
+
+	if (reassembly_flits + length > size)
+	{
+		reassembly_refusals++;
+		return false;
+	}
+
+	Reassembly r;
+	r.next = r.received = 0;
+	reassembly.insert(make_pair(bond_id, r));
+	reassembly_flits += length;
+	max_reassembly_flits = max(max_reassembly_flits, reassembly_flits);
+
+	return true;
+}
+
+void Hub::reassemble(const Flit & flit)
+{
+	map<int, Reassembly>::iterator it = reassembly.find(flit.bond_id);
+	assert(it != reassembly.end() && "bonded flit without reassembly storage");
+
+	reassembled_flits++;
+	if (flit.sequence_no != it->second.next)
+		reordered_flits++;
+
+	it->second.flits[flit.sequence_no] = flit;
+
+	// the receiver is needed from the first flit received of the packet
+	// to the last one, whichever they are
+	if (flit.sequence_length > 1)
+	{
+		if (it->second.received == 0)
+			rx_open_packets++;
+		if (++it->second.received == flit.sequence_length)
+			rx_open_packets--;
+	}
+}
+
+void Hub::forwardBonded()
+{
+	map<int, Reassembly>::iterator it = reassembly.begin();
+
+	while (it != reassembly.end())
+	{
+		Reassembly & ra = it->second;
+		map<int, Flit>::iterator f = ra.flits.find(ra.next);
+
+		if (f == ra.flits.end())
+		{
+			++it;
+			continue;
+		}
+
+		Flit flit = f->second;
+		power.antennaBufferFront();
+
+		// each reassembly is a distinct input of the reservation table
+		TReservation r;
+		r.input = rxChannels.size() + it->first;
+		r.vc = flit.vc_id;
+
+		int port;
+		if (flit.hub_relay_node != NOT_VALID)
+			port = tile2Port(flit.hub_relay_node);
+		else
+			port = tile2Port(flit.dst_id);
+
+		if (flit.flit_type == FLIT_TYPE_HEAD)
+		{
+			int rt_status = antenna2tile_reservation_table.checkReservation(r, port);
+
+			if (rt_status == RT_AVAILABLE)
+			{
+				LOG << "Reserving output port " << port << " for bonded flit " << flit << endl;
+				antenna2tile_reservation_table.reserve(r, port);
+				wireless_communications_counter++;
+			}
+			else if (rt_status != RT_ALREADY_SAME)
+			{
+				++it;
+				continue;
+			}
+		}
+
+		vector<pair<int,int> > reservations = antenna2tile_reservation_table.getReservations(r.input);
+
+		if (find(reservations.begin(), reservations.end(), make_pair(port, r.vc)) == reservations.end() ||
+			buffer_to_tile[port][r.vc].IsFull())
+		{
+			++it;
+			continue;
+		}
+
+		ra.flits.erase(f);
+		ra.next++;
+		reassembly_flits--;
+		power.antennaBufferPop();
+
+		LOG << "Moving bonded flit " << flit << " to buffer_to_tile[" << port << "][" << r.vc << "]" << endl;
+		buffer_to_tile[port][r.vc].Push(flit);
+		power.bufferToTilePush();
+
+		if (flit.flit_type == FLIT_TYPE_TAIL)
+		{
+			antenna2tile_reservation_table.release(r, port);
+			reassembly.erase(it++);
+		}
+		else
+			++it;
+	}
+}
+
+vector<int> Hub::multicastChannels(const DestinationSet & multicast) const
+{
+	vector<int> hubs = multicastHubs(multicast);
+	vector<int> candidates;
+
+	if (hubs[0] >= (int)tx_to_hub.size())
+		return candidates;
+
+	for (unsigned int i = 0; i < tx_to_hub[hubs[0]].size(); i++)
+	{
+		int tx = tx_to_hub[hubs[0]][i];
+		bool reaches_all = true;
+
+		for (unsigned int h = 1; h < hubs.size() && reaches_all; h++)
+			reaches_all = hubs[h] < (int)tx_to_hub.size() &&
+				find(tx_to_hub[hubs[h]].begin(), tx_to_hub[hubs[h]].end(), tx) != tx_to_hub[hubs[h]].end();
+
+		if (reaches_all)
+			candidates.push_back(tx);
+	}
+
+	return candidates;
+}
+
+int Hub::selectChannel(int dst_hub) const
+{
+	if (dst_hub >= (int)tx_to_hub.size())
 	    return NOT_VALID;
 
-	if (GlobalParams::channel_selection==CHSEL_RANDOM)
-		return intersection[rand()%intersection.size()];
-	else
-	if (GlobalParams::channel_selection==CHSEL_FIRST_FREE)
+	return selectChannel(tx_to_hub[dst_hub]);
+}
+
+int Hub::selectChannel(const vector<int> & candidates) const
+{
+	if (candidates.empty())
+	    return NOT_VALID;
+
+	int tx = NOT_VALID;
+
+	switch (GlobalParams::channel_selection)
+	{
+	case CHSEL_RANDOM:
+		tx = candidates[rand()%candidates.size()];
+		break;
+
+	case CHSEL_FIRST_FREE:
 	{
-		int start_channel = rand()%intersection.size();
-		int k;
+		int start_channel = rand()%candidates.size();
 
-		for (vector<int>::size_type i=0;i<intersection.size();i++)
+		for (unsigned int i = 0; i < candidates.size() && tx == NOT_VALID; i++)
 		{
-			k = (start_channel+i)%intersection.size();
+			int k = (start_channel+i)%candidates.size();
+			if (!transmission_in_progress[candidates[k]])
+				tx = candidates[k];
+		}
 
-			if (!transmission_in_progress.at(intersection[k]))
+		if (tx == NOT_VALID)
+		{
+			LOG << "All channels busy, applying random selection" << endl;
+			tx = candidates[rand()%candidates.size()];
+		}
+		break;
+	}
+
+	case CHSEL_LEAST_OCCUPIED:
+	case CHSEL_MIN_TOKEN_WAIT:
+	{
+		// ties are broken starting from a random channel
+		int start_channel = rand()%candidates.size();
+		double best = 0;
+
+		for (unsigned int i = 0; i < candidates.size(); i++)
+		{
+			int k = candidates[(start_channel+i)%candidates.size()];
+			double cost;
+
+			if (GlobalParams::channel_selection == CHSEL_LEAST_OCCUPIED)
+				cost = init[k]->buffer_tx.Size();
+			else
+				cost = expectedWait(k);
+
+			if (tx == NOT_VALID || cost < best)
 			{
-				cout << "Found free channel " << intersection[k] << " on (src,dest) (" << src_hub << "," << dst_hub << ") " << endl;
-				return intersection[k];
+				tx = k;
+				best = cost;
 			}
 		}
-		cout << "All channel busy, applying random selection " << endl;
-		return intersection[rand()%intersection.size()];
+		break;
+	}
+
+	case CHSEL_DATA_RATE:
+	{
+		// random, with probability proportional to the data rate
+		double total = 0;
+		for (unsigned int i = 0; i < candidates.size(); i++)
+			total += GlobalParams::channel_configuration[txChannels[candidates[i]]].dataRate;
+
+		double r = total * rand() / ((double)RAND_MAX + 1);
+		for (unsigned int i = 0; i < candidates.size() && tx == NOT_VALID; i++)
+		{
+			r -= GlobalParams::channel_configuration[txChannels[candidates[i]]].dataRate;
+			if (r < 0 || i == candidates.size() - 1)
+				tx = candidates[i];
+		}
+		break;
+	}
+
+	default:
+		assert(false);
 	}
 
-	return NOT_VALID;
+	return txChannels[tx];
 }
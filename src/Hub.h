@@ -11,7 +11,7 @@
 #ifndef __NOXIMHUB_H__
 #define __NOXIMHUB_H__
 
-#include <map>
+#include <vector>
 #include <systemc.h>
 #include "DataStructs.h"
 #include "Buffer.h"
@@ -21,6 +21,8 @@
 #include "Target.h"
 #include "TokenRing.h"
 #include "Power.h"
+#include "SleepController.h"
+#include "Stats.h"
 
 using namespace std;
 
@@ -53,24 +55,36 @@ SC_MODULE(Hub)
     BufferBank* buffer_to_tile;     // Buffer for each port
     bool* current_level_rx;	// Current level for ABP
     bool* current_level_tx;	// Current level for ABP
+    Payload* last_tx_payload;	// Last payload sent to each tile (payload_energy)
 
 
-    map<int, sc_in<int>* > current_token_holder;
-    map<int, sc_in<int>* > current_token_expiration;
-    map<int, sc_inout<int>* > flag;
-    map<int, bool> transmission_in_progress;
+    // indexed by position in txChannels
+    vector<sc_in<int>* > current_token_holder;
+    vector<sc_in<int>* > current_token_expiration;
+    vector<sc_inout<int>* > flag;
+    vector<bool> transmission_in_progress;
+    vector<Initiator*> init;
+    vector<int> mac_policy;
 
-    map<int, Initiator*> init;
-    map<int, Target*> target;
+    // indexed by position in rxChannels
+    vector<Target*> target;
+    vector<vector<int> > multicast_nodes;	// local destinations of the multicast packet in progress, whose ports it reserved
 
-    map<int, int> tile2port_mapping;
-    map<int, int> tile2hub_mapping;
+    // channel id -> position in txChannels/rxChannels (NOT_VALID if absent)
+    vector<int> tx_index;
+    vector<int> rx_index;
+
+    vector<int> tile2port_mapping;	// by tile id, NOT_VALID if not attached
+
+    // hub id -> tx indexes of the channels it receives from, in the order
+    // of txChannels
+    vector<vector<int> > tx_to_hub;
 
     int start_from_port; // Port from which to start the reservation cycle
     int * start_from_vc; // VC from which to start the reservation cycle for the specific port
 
     ReservationTable antenna2tile_reservation_table;	// Switch reservation table
-    ReservationTable tile2antenna_reservation_table;// Wireless reservation table
+    ReservationTable tile2antenna_reservation_table;// Wireless reservation table (outputs by tx index)
 
     void updateRxPower();
     void updateTxPower();
@@ -80,20 +94,73 @@ SC_MODULE(Hub)
     int route(Flit&);
     int tile2Port(int);
 
-    void setFlitTransmissionCycles(int cycles,int ch_id) {flit_transmission_cycles[ch_id]=cycles;}
+    void setFlitTransmissionCycles(int cycles,int tx) {flit_transmission_cycles[tx]=cycles;}
+
+    // Cycles a packet of length flits is expected to take to be
+    // transmitted to dst_hub on the best channel reaching it: token wait
+    // plus the antenna buffer queue and the packet itself
+    double wirelessLatency(int dst_hub, int length);
+
+    // Cycles before a new packet can start on a channel: token wait plus
+    // the flits queued in its antenna buffer
+    double expectedWait(int tx) const;
+
+    // Flits queued in the buffers from a tile attached to the hub
+    int fromTileFlits(int tile);
 
     // Power stats
     Power power;
+    LatencyStats latency_stats;	// Latency breakdown of the flits crossing the hub
 
     int total_sleep_cycles;
     int total_ttxoff_cycles;
-    map<int,int> buffer_rx_sleep_cycles; // antenna buffer RX power off cycles
-    map<int,int> abtxoff_cycles; // antenna buffer TX power off cycles
-    map<int,int> analogtxoff_cycles; // analog TX power off cycles
-    map<int,int> buffer_to_tile_poweroff_cycles;
+    vector<int> buffer_rx_sleep_cycles; // antenna buffer RX power off cycles, by rx index
+    vector<int> abtxoff_cycles; // antenna buffer TX power off cycles, by tx index
+    vector<int> analogtxoff_cycles; // analog TX power off cycles, by tx index
+    vector<int> buffer_to_tile_poweroff_cycles; // by port
 
     int wireless_communications_counter;
 
+    // Transceivers turned off by the wireless_sleep_policy
+    SleepController rx_sleep;
+    SleepController tx_sleep;
+    int rx_open_packets;	// packets being received from the channels
+    bool rx_flit_received;	// in the current cycle
+
+    // Sets the energy the sleep controllers save, once the power model
+    // is configured
+    void configureSleep();
+
+    // The receiver cannot snoop the channels, either because of the
+    // power manager or of the sleep policy
+    bool rxSleeping();
+
+    // Flits of a packet striped over several channels (wireless_bonding),
+    // received in any order and forwarded to the tile in order
+    struct Reassembly {
+	map<int, Flit> flits;	// by sequence number
+	int next;		// sequence number of the next flit to forward
+	int received;		// flits received, in any order
+    };
+    map<int, Reassembly> reassembly;	// by bond id
+    int reassembly_flits;		// storage taken by the packets being reassembled
+
+    // The storage for a whole bonded packet is reserved by its
+    // transmitter before striping it, so that its flits are never
+    // refused: false if there is not enough left, the packet is then
+    // sent on a single channel
+    bool reserveReassembly(const int bond_id, const int length);
+    void reassemble(const Flit & flit);
+
+    // Bonding stats
+    int bonded_packets;		// transmitted striped
+    int bonded_channels;	// summed over the bonded packets
+    double bonded_rate;		// data rate [Gbps] summed over the bonded packets
+    int reassembled_flits;	// bonded flits received
+    int reordered_flits;	// received before a flit preceding them
+    int max_reassembly_flits;
+    int reassembly_refusals;	// packets not bonded for lack of storage
+
     // Constructor
 
     Hub(sc_module_name nm, int id, TokenRing * tr): sc_module(nm) {
@@ -118,10 +185,12 @@ SC_MODULE(Hub)
         txChannels = GlobalParams::hub_configuration[local_id].txChannels;
 
 	antenna2tile_reservation_table.setSize(num_ports);
-	// fix this
-	//tile2antenna_reservation_table.setSize(txChannels.size());
-#define STATIC_MAX_CHANNELS 100
-      tile2antenna_reservation_table.setSize(STATIC_MAX_CHANNELS);
+	tile2antenna_reservation_table.setSize(txChannels.size());
+
+	int max_tile = NOT_VALID;
+	for (int i = 0; i < num_ports; i++)
+	    max_tile = max(max_tile, attachedNodes[i]);
+	tile2port_mapping.assign(max_tile + 1, NOT_VALID);
 
         flit_rx = new sc_in<Flit>[num_ports];
         req_rx = new sc_in<bool>[num_ports];
@@ -141,8 +210,10 @@ SC_MODULE(Hub)
 
         current_level_rx = new bool[num_ports];
         current_level_tx = new bool[num_ports];
+        last_tx_payload = new Payload[num_ports];
 
         start_from_port = 0;
+        r_from_tile.assign(num_ports, vector<int>(GlobalParams::n_virtual_channels, NOT_VALID));
 
         for(int i = 0; i < num_ports; i++)
         {
@@ -154,53 +225,147 @@ SC_MODULE(Hub)
                 buffer_to_tile[i][vc].setLabel(string(name())+"->btt["+i_to_string(i)+"]["+i_to_string(vc)+"]");
             }
             start_from_vc[i] = 0;
+            // the processes also run at the initialization, before the reset
+            current_level_rx[i] = current_level_tx[i] = 0;
         }
 
+        int max_channel = NOT_VALID;
+        for (unsigned int i = 0; i < txChannels.size(); i++)
+            max_channel = max(max_channel, txChannels[i]);
+        for (unsigned int i = 0; i < rxChannels.size(); i++)
+            max_channel = max(max_channel, rxChannels[i]);
+        tx_index.assign(max_channel + 1, NOT_VALID);
+        rx_index.assign(max_channel + 1, NOT_VALID);
+
         for (unsigned int i = 0; i < txChannels.size(); i++) {
             char txt[20];
             int ch = txChannels[i];
             sprintf(txt, "init_%d", ch);
-            init[ch] = new Initiator(txt,this);
-            init[ch]->buffer_tx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].txBufferSize);
-            init[ch]->buffer_tx.setLabel(string(name())+"->abtx["+i_to_string(i)+"]");
-            current_token_holder[ch] = new sc_in<int>();
-            current_token_expiration[ch] = new sc_in<int>();
-            flag[ch] = new sc_inout<int>();
-            token_ring->attachHub(ch,local_id, current_token_holder[ch],current_token_expiration[ch],flag[ch]);
-            transmission_in_progress[ch] = false;
+            tx_index[ch] = i;
+            init.push_back(new Initiator(txt,this,i));
+            init[i]->buffer_tx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].txBufferSize);
+            init[i]->buffer_tx.setLabel(string(name())+"->abtx["+i_to_string(i)+"]");
+            current_token_holder.push_back(new sc_in<int>());
+            current_token_expiration.push_back(new sc_in<int>());
+            flag.push_back(new sc_inout<int>());
+            token_ring->attachHub(ch,local_id, current_token_holder[i],current_token_expiration[i],flag[i]);
+            transmission_in_progress.push_back(false);
+            mac_policy.push_back(token_ring->getMacPolicy(ch));
             // power manager currently assumes TOKEN_PACKET mac policy
             if (GlobalParams::use_powermanager)
-                assert(token_ring->getPolicy(ch).first==TOKEN_PACKET);
+                assert(mac_policy[i]==MAC_TOKEN_PACKET);
         }
+        flit_transmission_cycles.assign(txChannels.size(), 0);
+        tx_bond.assign(txChannels.size(), NOT_VALID);
+
+        for (map<int, HubConfig>::iterator h = GlobalParams::hub_configuration.begin();
+                h != GlobalParams::hub_configuration.end(); ++h) {
+            vector<int> & dst_rx = h->second.rxChannels;
+            if (h->first >= (int)tx_to_hub.size())
+                tx_to_hub.resize(h->first + 1);
+            for (unsigned int i = 0; i < txChannels.size(); i++)
+                for (unsigned int j = 0; j < dst_rx.size(); j++)
+                    if (txChannels[i] == dst_rx[j])
+                        tx_to_hub[h->first].push_back(i);
+        }
+        abtxoff_cycles.assign(txChannels.size(), 0);
+        analogtxoff_cycles.assign(txChannels.size(), 0);
 
         for (unsigned int i = 0; i < rxChannels.size(); i++) {
             char txt[20];
             sprintf(txt, "target_%d", rxChannels[i]);
-            target[rxChannels[i]] = new Target(txt, rxChannels[i], this);
-            target[rxChannels[i]]->buffer_rx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].rxBufferSize);
-            target[rxChannels[i]]->buffer_rx.setLabel(string(name())+"->abrx["+i_to_string(i)+"]");
+            rx_index[rxChannels[i]] = i;
+            target.push_back(new Target(txt, rxChannels[i], this));
+            target[i]->buffer_rx.SetMaxBufferSize(GlobalParams::hub_configuration[local_id].rxBufferSize);
+            target[i]->buffer_rx.setLabel(string(name())+"->abrx["+i_to_string(i)+"]");
         }
+        multicast_nodes.assign(rxChannels.size(), vector<int>());
+        buffer_rx_sleep_cycles.assign(rxChannels.size(), 0);
+        buffer_to_tile_poweroff_cycles.assign(num_ports, 0);
 
 	start_from_port = 0;
 	total_sleep_cycles = 0;
 	total_ttxoff_cycles = 0;
 	wireless_communications_counter = 0;
+	rx_open_packets = 0;
+	reassembly_flits = max_reassembly_flits = reassembly_refusals = 0;
+	bonded_packets = bonded_channels = reassembled_flits = reordered_flits = 0;
+	bonded_rate = 0.0;
+	bond_tx.assign(num_ports, vector<vector<int> >(GlobalParams::n_virtual_channels));
+	bond_id.assign(num_ports, vector<int>(GlobalParams::n_virtual_channels, NOT_VALID));
+	bond_relay.assign(num_ports, vector<int>(GlobalParams::n_virtual_channels, NOT_VALID));
+	rx_flit_received = false;
+	accounted_wakeups = 0;
     }
 
 
     int getID() { return local_id;}
 
     private:
-    map<int,int> flit_transmission_cycles;
+    vector<int> flit_transmission_cycles;	// by tx index
+
+    vector<vector<int> > r_from_tile;	// routing decisions by port and VC
 
-    void txRadioProcessTokenPacket(int channel);
-    void txRadioProcessTokenHold(int channel);
-    void txRadioProcessTokenMaxHold(int channel);
+    // Channels over which the packet of a port and VC is striped (tx
+    // indexes, the one of the head flit first, empty if not bonded), its
+    // bond id and relay node, by port and VC
+    vector<vector<vector<int> > > bond_tx;
+    vector<vector<int> > bond_id;
+    vector<vector<int> > bond_relay;
+    static int next_bond_id;
+
+    // bond id of the packet striped over a channel, by tx index: with
+    // TOKEN_PACKET the channel keeps its token until the packet has been
+    // queued on all its channels
+    vector<int> tx_bond;
+
+    // Channels a packet starting on tx could be striped over to dst_hub:
+    // tx and up to wireless_bonding - 1 other channels reaching dst_hub
+    // that are not reserved, by expected wait
+    vector<int> bondCandidates(int tx, int dst_hub);
+
+    // Reserves the other channels of the packet of port and VC, whose
+    // head has just reserved tx
+    void bondChannels(int port, const Flit & head, int tx, int dst_hub);
+
+    // Channel of a flit of a bonded packet: the first one for the head
+    // flit, otherwise the one with the shortest expected wait that has
+    // room for it (NOT_VALID if none)
+    int bondedChannel(int port, int vc, const Flit & flit);
+
+    // Moves the reassembled flits to the buffers to tile
+    void forwardBonded();
+
+    // Cycles left before the token hold of a channel expires
+    int tokenHoldCycles(int tx);
+
+    void txRadioProcessTokenPacket(int tx);
+    void txRadioProcessTokenHold(int tx);
+    void txRadioProcessTokenMaxHold(int tx);
+    void txRadioProcessTDMA(int tx);
+    void txRadioProcessCSMA(int tx);
 
     void rxPowerManager();
     void txPowerManager();
 
-    int selectChannel(int src, int dst) const ;
+    // Accounts the energy of the wake-ups since the last call
+    void accountWakeups();
+    unsigned long accounted_wakeups;
+
+    // Channel on which to transmit a packet to dst_hub, according to the
+    // channel_selection policy (NOT_VALID if no channel reaches it)
+    int selectChannel(int dst_hub) const;
+    int selectChannel(const vector<int> & candidates) const;
+
+    // tx indexes of the channels reaching all the hubs of a multicast
+    // packet
+    vector<int> multicastChannels(const DestinationSet & multicast) const;
+
+    // A multicast packet received from a channel is replicated to the
+    // ports of its local destinations: they are reserved together and
+    // each flit moves to all of them in the same cycle
+    void reserveMulticast(int rx, const Flit & flit);
+    void forwardMulticast(int rx);
 };
 
 #endif
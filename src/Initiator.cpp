@@ -9,95 +9,276 @@
  */
 #include "Hub.h"
 #include "Initiator.h"
+#include "Profiler.h"
+#include "WirelessPaths.h"
 
-void Initiator::thread_process()
+void Initiator::transmitProcess()
 {
+	PROFILE(PROF_INITIATOR_TRANSMIT);
 
-	tlm::tlm_generic_payload* trans = new tlm::tlm_generic_payload;
-	tlm::tlm_phase phase;
-	sc_time delay;
+	// notified while the channel is still transmitting
+	if (transmitting)
+		return;
 
-	while (1)
+	double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+	// backing off after a failed attempt, or waiting for a negative
+	// acknowledgement
+	if (now < retry_cycle)
+		return;
+
+	// the transmitter is waking up
+	if (GlobalParams::wireless_sleep_policy != SLEEP_NONE && !hub->tx_sleep.isOn())
 	{
-		LOG << " *** waiting for transmissions" << endl;
+		hub->tx_sleep.request();
+		return;
+	}
 
-		wait(start_request_event);
+	if (GlobalParams::wireless_arq != ARQ_NONE)
+	{
+		int window = GlobalParams::wireless_arq == ARQ_GO_BACK_N ? GlobalParams::wireless_arq_window : 1;
 
-		tlm::tlm_command cmd = tlm::TLM_WRITE_COMMAND;
-		flit_payload = buffer_tx.Front();
-		hub->power.antennaBufferFront();
+		if ((int)unacknowledged() >= window)
+			return;
+	}
 
-		int destHub;
+	tlm::tlm_command cmd = tlm::TLM_WRITE_COMMAND;
+	flit_payload = buffer_tx.Front();
+	hub->power.antennaBufferFront();
 
-		// hub relay management  ////////////////////////////////////////////////////////////////
-		// if explicitly set in the header flit, trasmission target should reach a relay hub
-		if (flit_payload.flit_type == FLIT_TYPE_HEAD)
-		{
-			if (flit_payload.hub_relay_node!=NOT_VALID) {
-				current_hub_relay = flit_payload.hub_relay_node;
-				LOG << "HUB RELAY: Flit " << flit_payload << " setting transmission hub relay " << current_hub_relay << " to reach destination " << endl;
-			}
-			else
-				current_hub_relay = NOT_VALID;
+	// hub relay management  ////////////////////////////////////////////////////////////////
+	// if explicitly set in the header flit, trasmission target should reach a relay hub
+	// (each flit of a bonded packet carries it, as they can take any of its channels)
+	if (flit_payload.flit_type == FLIT_TYPE_HEAD || flit_payload.bond_id != NOT_VALID)
+	{
+		if (flit_payload.hub_relay_node!=NOT_VALID) {
+			current_hub_relay = flit_payload.hub_relay_node;
+			LOG << "HUB RELAY: Flit " << flit_payload << " setting transmission hub relay " << current_hub_relay << " to reach destination " << endl;
 		}
+		else
+			current_hub_relay = NOT_VALID;
+	}
+
+	if (current_hub_relay!=NOT_VALID)
+	{
+		flit_payload.hub_relay_node = current_hub_relay;
+		dest_hub = tile2Hub(flit_payload.hub_relay_node);
+	}
+	else
+	{
+		// the channel decodes the other hubs of a multicast flit from
+		// its destination set
+		dest_hub = tile2Hub(flit_payload.dst_id);
+	}
+	////////////////////////////////////////////////////////////////////////////////
+
+	// the receivers are waking up: the flit waits for them without
+	// taking the channel
+	if (GlobalParams::wireless_sleep_policy != SLEEP_NONE && !receiversOn())
+	{
+		rx_wakeup_waits++;
+		LOG << "*** [Ch"<< _channel_id <<"] receiver waking up, deferring " << flit_payload << endl;
+		return;
+	}
+
+	LOG << " *** Starting transmission of " << flit_payload << " to reach HUB_" << dest_hub <<  endl;
+
+	trans.set_command(cmd);
+	trans.set_address(static_cast<const uint64>(dest_hub));
+
+	trans.set_data_ptr( reinterpret_cast<unsigned char*>(&flit_payload) );
+	trans.set_data_length( sizeof(Flit) );
+	trans.set_streaming_width( sizeof(Flit) ); // = data_length to indicate no streaming
+	trans.set_byte_enable_ptr( 0 ); // 0 indicates unused
+	trans.set_dmi_allowed( false ); // Mandatory initial value
+	trans.set_response_status( tlm::TLM_INCOMPLETE_RESPONSE ); // Mandatory initial value
 
-		if (current_hub_relay!=NOT_VALID)
+	// the token wait ends when the transmission starts, the target
+	// accounts the transmission itself
+	token_wait = 0;
+	if (GlobalParams::latency_breakdown && flit_payload.flit_type == FLIT_TYPE_HEAD)
+	{
+		token_wait = now - flit_payload.hop_time;
+		flit_payload.hop_time = now;
+	}
+
+	tlm::tlm_phase phase = tlm::BEGIN_REQ;
+	sc_time delay = SC_ZERO_TIME;
+
+	// the channel accepts the request right away and responds
+	// (nb_transport_bw) once the flit has been transmitted; the requests
+	// notified meanwhile are ignored
+	tlm::tlm_sync_enum status = socket->nb_transport_fw(trans, phase, delay);
+
+	if (status == tlm::TLM_COMPLETED)
+	{
+		// carrier sensed busy
+		assert(trans.is_response_error());
+		LOG << "*** [Ch"<< _channel_id <<"] channel busy, deferring " << flit_payload << endl;
+		backOff();
+		return;
+	}
+
+	assert(status == tlm::TLM_UPDATED && phase == tlm::END_REQ);
+
+	attempt_cycle = now;
+	transmitting = true;
+}
+
+void Initiator::queue(const Flit & flit)
+{
+	if (buffer_tx.IsEmpty())
+		front_cycle = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+	buffer_tx.Push(flit);
+}
+
+unsigned int Initiator::unacknowledged()
+{
+	double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+	while (!unacked.empty() && unacked.front() <= now)
+		unacked.pop_front();
+
+	return unacked.size();
+}
+
+bool Initiator::isFull()
+{
+	if (unacked.empty())
+		return buffer_tx.IsFull();
+
+	return buffer_tx.Size() + unacknowledged() >= buffer_tx.GetMaxBufferSize();
+}
+
+void Initiator::retransmit(double now)
+{
+	nacks++;
+	retry_cycle = now + GlobalParams::wireless_ack_cycles;
+
+	if (GlobalParams::wireless_arq == ARQ_GO_BACK_N)
+	{
+		// the flits that followed it until the negative acknowledgement
+		// arrived, discarded by the receiver
+		int flit_cycles = max(1, (int)(now - attempt_cycle));
+		int wasted = (GlobalParams::wireless_ack_cycles + flit_cycles - 1) / flit_cycles;
+
+		wasted = min(wasted, GlobalParams::wireless_arq_window - 1);
+		wasted = min(wasted, (int)buffer_tx.Size() - 1);
+		for (int i = 0; i < wasted; i++)
 		{
-			flit_payload.hub_relay_node = current_hub_relay;
-			destHub = tile2Hub(flit_payload.hub_relay_node);
+			hub->power.antennaBufferFront();
+			hub->power.wirelessTx(dest_hub);
 		}
-		else
+		wasted_flits += wasted;
+	}
+
+	LOG << "*** [Ch"<< _channel_id <<"] negative acknowledgement, retransmitting " << flit_payload << " at cycle " << retry_cycle << endl;
+}
+
+bool Initiator::receiversOn()
+{
+	vector<int> dsts = flit_payload.multicast.empty() ? vector<int>(1, dest_hub) : multicastHubs(flit_payload.multicast);
+	bool on = true;
+
+	for (unsigned int i = 0; i < dsts.size(); i++)
+	{
+		SleepController & rx = WirelessPaths::getHubModule(dsts[i])->rx_sleep;
+
+		if (!rx.isOn())
 		{
-			destHub = tile2Hub(flit_payload.dst_id);
+			rx.request();
+			on = false;
 		}
-		////////////////////////////////////////////////////////////////////////////////
+	}
 
+	return on;
+}
 
-		LOG << " *** Starting transmission of " << flit_payload << " to reach HUB_" << destHub <<  endl;
+void Initiator::backOff()
+{
+	attempts++;
+	int backoff = rand() % (1 << min(attempts, MAX_BACKOFF_EXPONENT));
+	retry_cycle = sc_time_stamp().to_double() / GlobalParams::clock_period_ps + backoff;
+	LOG << "*** [Ch"<< _channel_id <<"] backing off " << backoff << " cycles" << endl;
+}
 
-		trans->set_command(cmd);
-		trans->set_address(static_cast<const uint64>(destHub));
+tlm::tlm_sync_enum Initiator::nb_transport_bw(tlm::tlm_generic_payload& trans, tlm::tlm_phase& phase, sc_time& delay)
+{
+	PROFILE(PROF_INITIATOR_TRANSMIT);
 
-		trans->set_data_ptr( reinterpret_cast<unsigned char*>(&flit_payload) );
-		trans->set_data_length( sizeof(Flit) );
-		trans->set_streaming_width( sizeof(Flit) ); // = data_length to indicate no streaming
-		trans->set_byte_enable_ptr( 0 ); // 0 indicates unused
-		trans->set_dmi_allowed( false ); // Mandatory initial value
-		trans->set_response_status( tlm::TLM_INCOMPLETE_RESPONSE ); // Mandatory initial value
+	assert(phase == tlm::BEGIN_RESP);
 
-		delay = sc_time(0, SC_PS);
+	transmitting = false;
+	if (flit_payload.multicast.empty())
+		hub->power.wirelessTx(dest_hub);
+	else
+		hub->power.wirelessTx(multicastHubs(flit_payload.multicast));
 
-		// Call b_transport to demonstrate the b/nb conversion by the simple_target_socket
-		socket->b_transport( *trans, delay);
+	// the transmission of a flit missed by a receiver not on is wasted
+	if (GlobalParams::wireless_sleep_policy != SLEEP_NONE &&
+		trans.get_response_status() == tlm::TLM_INCOMPLETE_RESPONSE && !receiversOn())
+	{
+		vector<int> dsts = flit_payload.multicast.empty() ? vector<int>(1, dest_hub) : multicastHubs(flit_payload.multicast);
+		double energy = 0.0;
 
-		hub->power.wirelessTx(hub->local_id,destHub,GlobalParams::flit_size);
+		for (unsigned int i = 0; i < dsts.size(); i++)
+			energy = max(energy, hub->power.getWirelessTxEnergy(dsts[i]));
+		rx_missed_flits++;
+		rx_missed_energy += energy;
+	}
 
-		// Initiator obliged to check response status and delay
-		if (!trans->is_response_error() )
-		{
-			buffer_tx.Pop();
-			hub->power.antennaBufferPop();
-
-			if (flit_payload.flit_type == FLIT_TYPE_HEAD)
-				hub->transmission_in_progress.at(_channel_id) = true;
-
-			if (flit_payload.flit_type == FLIT_TYPE_TAIL)
-			{
-				LOG << "*** [Ch"<< _channel_id <<"] tail flit sent " << flit_payload << ", releasing token" << endl;
-				hub->flag[_channel_id]->write(RELEASE_CHANNEL);
-				hub->transmission_in_progress.at(_channel_id) = false;
-			}
-		}
-		else
+	// Initiator obliged to check response status
+	if (!trans.is_response_error() )
+	{
+		attempts = 0;
+		if (flit_payload.flit_type == FLIT_TYPE_HEAD)
 		{
-			LOG << " WARNING: incomplete transaction " << endl;
+			access_delay += attempt_cycle - front_cycle;
+			access_samples++;
 		}
 
-		//check_transaction( *trans );
+		buffer_tx.Pop();
+		hub->power.antennaBufferPop();
+		front_cycle = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
 
-	}
+		if (GlobalParams::wireless_arq != ARQ_NONE)
+			unacked.push_back(front_cycle + GlobalParams::wireless_ack_cycles);
 
-}
+		if (GlobalParams::latency_breakdown && flit_payload.flit_type == FLIT_TYPE_HEAD)
+			hub->latency_stats.account(flit_payload, LAT_TOKEN_WAIT, token_wait);
+
+		// the channels of a bonded packet keep their tokens while it is
+		// striped (see Hub::txRadioProcessTokenPacket)
+		if (flit_payload.flit_type == FLIT_TYPE_HEAD && flit_payload.bond_id == NOT_VALID)
+			hub->transmission_in_progress[_tx_index] = true;
 
+		if (flit_payload.flit_type == FLIT_TYPE_TAIL)
+		{
+			LOG << "*** [Ch"<< _channel_id <<"] tail flit sent " << flit_payload << ", releasing token" << endl;
+			hub->flag[_tx_index]->write(RELEASE_CHANNEL);
+			hub->transmission_in_progress[_tx_index] = false;
+		}
+	}
+	else if (trans.get_response_status() == tlm::TLM_GENERIC_ERROR_RESPONSE)
+	{
+		// lost for a collision on the channel, retransmitted at the
+		// next request
+		LOG << "*** [Ch"<< _channel_id <<"] collision, retransmitting " << flit_payload << endl;
+		backOff();
+	}
+	else if (GlobalParams::wireless_arq != ARQ_NONE)
+	{
+		// corrupted or refused by a full antenna buffer
+		retransmit(sc_time_stamp().to_double() / GlobalParams::clock_period_ps);
+	}
+	else
+	{
+		LOG_WARNING << " WARNING: incomplete transaction " << endl;
+	}
 
+	//check_transaction( trans );
 
+	phase = tlm::END_RESP;
+	return tlm::TLM_COMPLETED;
+}
@@ -17,6 +17,7 @@
 #include "DataStructs.h"
 #include "Buffer.h"
 
+#include <deque>
 
 
 using namespace sc_core;
@@ -24,8 +25,12 @@ using namespace std;
 
 struct Hub;
 
+// Largest exponent of the backoff window after a collision [cycles]
+#define MAX_BACKOFF_EXPONENT	6
+
 // **************************************************************************************
-// Initiator module generating multiple pipelined generic payload transactions
+// Initiator module transmitting the flits of an antenna buffer, one non-blocking
+// generic payload transaction per flit
 // **************************************************************************************
 
 struct Initiator: sc_module
@@ -38,17 +43,41 @@ struct Initiator: sc_module
 
   //SC_CTOR(Initiator)
   //: socket("socket")  // Construct and name socket
-  Initiator(sc_module_name nm,Hub* h): sc_module(nm),hub(h), socket("socket")
+  Initiator(sc_module_name nm,Hub* h,int tx): sc_module(nm),hub(h), socket("socket")
   {
 
       int c;
-      if (GlobalParams::use_winoc) SC_THREAD(thread_process);
+      if (GlobalParams::use_winoc)
+      {
+	  SC_METHOD(transmitProcess);
+	  sensitive << start_request_event;
+	  dont_initialize();
+      }
+      socket.register_nb_transport_bw(this, &Initiator::nb_transport_bw);
       sscanf(nm,"init_%d",&c);
       _channel_id = c;
+      _tx_index = tx;
       current_hub_relay = NOT_VALID;
+      transmitting = false;
+      attempts = 0;
+      retry_cycle = 0;
+      front_cycle = 0;
+      access_delay = 0;
+      access_samples = 0;
+      nacks = 0;
+      wasted_flits = 0;
+      rx_wakeup_waits = 0;
+      rx_missed_flits = 0;
+      rx_missed_energy = 0.0;
   }
 
-  void thread_process();
+  // Starts the transmission of the front flit of buffer_tx, the requests
+  // notified until the channel has transmitted it are ignored
+  void transmitProcess();
+
+  // Completion of the transmission (BEGIN_RESP from the channel)
+  tlm::tlm_sync_enum nb_transport_bw(tlm::tlm_generic_payload& trans, tlm::tlm_phase& phase, sc_time& delay);
+
   void check_transaction(tlm::tlm_generic_payload& trans);
 
   sc_event end_request_event;
@@ -59,9 +88,64 @@ struct Initiator: sc_module
   Buffer buffer_tx;
   Flit flit_payload; 
 
+  int getChannel() const { return _channel_id; }
+
+  // Pushes a flit in buffer_tx
+  void queue(const Flit & flit);
+
+  // Whether buffer_tx is full, counting the flits kept for
+  // retransmission until they are acknowledged
+  bool isFull();
+
+  double access_delay;		// total over the head flits [cycles]
+  unsigned long access_samples;
+
+  unsigned long nacks;		// flits negatively acknowledged (ARQ)
+  unsigned long wasted_flits;	// sent after them and discarded (GO_BACK_N)
+
+  // Sleep policies: a flit waits for its receivers to wake up before
+  // being transmitted, one missed by a receiver not on wastes its
+  // transmission
+  unsigned long rx_wakeup_waits;	// cycles
+  unsigned long rx_missed_flits;
+  double rx_missed_energy;		// [J]
+
     private: 
   int _channel_id;
+  int _tx_index; // position of the channel in the hub txChannels
   int current_hub_relay;
+
+  tlm::tlm_generic_payload trans;
+  bool transmitting;	// a flit is on the channel
+  int dest_hub;		// of the flit on the channel
+  double token_wait;	// of the head flit on the channel (latency breakdown)
+
+  // after a collision (or, with CSMA, finding the carrier busy) the flit
+  // is retransmitted after a random backoff, doubling its maximum at each
+  // further failed attempt
+  int attempts;		// failed, of the flit on the channel
+  double retry_cycle;
+  void backOff();
+
+  // MAC access delay: from the head flit reaching the front of buffer_tx
+  // to the start of its successful transmission
+  double front_cycle;
+  double attempt_cycle;	// start of the last transmission
+
+  // ARQ: cycles at which the acknowledgements of the flits delivered
+  // reach the transmitter, which keeps them until then; at most a window
+  // of flits (one with STOP_AND_WAIT) waits for them
+  deque<double> unacked;
+  unsigned int unacknowledged();
+
+  // A flit not accepted by the receiver is resent once its negative
+  // acknowledgement arrives, with GO_BACK_N after those which followed
+  // it in the window
+  void retransmit(double now);
+
+  // Whether the receivers of the flit on the channel are on, those
+  // which are not are requested to wake up
+  bool receiversOn();
 };
 
 #endif
@@ -13,6 +13,7 @@
 #include "GlobalStats.h"
 #include "DataStructs.h"
 #include "GlobalParams.h"
+#include "Profiler.h"
 
 #include <csignal>
 
@@ -97,6 +98,7 @@ int sc_main(int arg_num, char *arg_vet[])
     reset.write(1);
     cout << "Reset for " << (int)(GlobalParams::reset_time) << " cycles... ";
     srand(GlobalParams::rnd_generator_seed);
+    Profiler::start();
     sc_start(GlobalParams::reset_time, SC_NS);
 
     reset.write(0);
@@ -107,6 +109,8 @@ int sc_main(int arg_num, char *arg_vet[])
 
     // Close the simulation
     if (GlobalParams::trace_mode) sc_close_vcd_trace_file(tf);
+    if (GlobalParams::power_trace_mode) n->power_trace.close();
+    if (GlobalParams::dvfs_mode) n->dvfs.close();
     cout << "Noxim simulation completed.";
     cout << " (" << sc_time_stamp().to_double() / GlobalParams::clock_period_ps << " cycles executed)" << endl;
     cout << endl;
@@ -9,6 +9,7 @@
  */
 
 #include "NoC.h"
+#include "Profiler.h"
 
 using namespace std;
 
@@ -54,7 +55,12 @@ void NoC::buildCommon()
 			iit != hub_config.attachedNodes.end();
 			++iit)
 		{
-			GlobalParams::hub_for_tile[*iit] = hub_id;
+			// a tile attached to several hubs has one r2h link for each
+			// of them; the one with the lowest id is its primary hub
+			if (GlobalParams::hub_for_tile.find(*iit) == GlobalParams::hub_for_tile.end())
+				GlobalParams::hub_for_tile[*iit] = hub_id;
+			GlobalParams::hubs_for_tile[*iit].push_back(hub_id);
+			GlobalParams::hub_links = max(GlobalParams::hub_links, (int)GlobalParams::hubs_for_tile[*iit].size());
 			//LOG<<"I am hub "<<hub_id<<" and I amconnecting to "<<*iit<<endl;
 
 		}
@@ -62,24 +68,23 @@ void NoC::buildCommon()
 		//LOG<<"it1 first "<< it1->first<< "second"<< it1->second<<endl;
 
 		// Determine, from configuration file, which Hub is connected to which Channel
-		for(vector<int>::iterator iit = hub_config.txChannels.begin();
-			iit != hub_config.txChannels.end();
-			++iit)
+		// the hub keeps its initiators and targets in the order of
+		// txChannels and rxChannels
+		for (unsigned int tx = 0; tx < hub_config.txChannels.size(); tx++)
 		{
-			int channel_id = *iit;
+			int channel_id = hub_config.txChannels[tx];
 			//LOG << "Binding " << hub[hub_id]->name() << " to txChannel " << channel_id << endl;
-			hub[hub_id]->init[channel_id]->socket.bind(channel[channel_id]->targ_socket);
+			hub[hub_id]->init[tx]->socket.bind(channel[channel_id]->targ_socket);
+			channel[channel_id]->addTxHub(hub[hub_id]);
 			//LOG << "Binding " << hub[hub_id]->name() << " to txChannel " << channel_id << endl;
-			hub[hub_id]->setFlitTransmissionCycles(channel[channel_id]->getFlitTransmissionCycles(),channel_id);
+			hub[hub_id]->setFlitTransmissionCycles(channel[channel_id]->getFlitTransmissionCycles(),tx);
 		}
 
-		for(vector<int>::iterator iit = hub_config.rxChannels.begin();
-			iit != hub_config.rxChannels.end();
-			++iit)
+		for (unsigned int rx = 0; rx < hub_config.rxChannels.size(); rx++)
 		{
-			int channel_id = *iit;
+			int channel_id = hub_config.rxChannels[rx];
 			//LOG << "Binding " << hub[hub_id]->name() << " to rxChannel " << channel_id << endl;
-			channel[channel_id]->init_socket.bind(hub[hub_id]->target[channel_id]->socket);
+			channel[channel_id]->init_socket.bind(hub[hub_id]->target[rx]->socket);
 			channel[channel_id]->addHub(hub[hub_id]);
 		}
 
@@ -101,7 +106,8 @@ void NoC::buildCommon()
 		// TODO: update power model (configureHub to support different tx/tx buffer depth in the power breakdown
 		// Currently, an averaged value is used when accounting in Power class methods
 
-		hub[hub_id]->power.configureHub(GlobalParams::flit_size,
+		hub[hub_id]->power.configureHub(hub_id,
+										GlobalParams::flit_size,
 										GlobalParams::hub_configuration[hub_id].toTileBufferSize,
 										GlobalParams::hub_configuration[hub_id].fromTileBufferSize,
 										GlobalParams::flit_size,
@@ -109,6 +115,9 @@ void NoC::buildCommon()
 										GlobalParams::hub_configuration[hub_id].txBufferSize,
 										GlobalParams::flit_size,
 										data_rate_gbs);
+
+		if (GlobalParams::wireless_sleep_policy != SLEEP_NONE)
+			hub[hub_id]->configureSleep();
 	}
 
 
@@ -2292,6 +2301,31 @@ void NoC::buildMesh()
             hub[hub_id]->buffer_full_status_tx[port](buffer_full_status[i][j].to_hub);
         }
 
+        // further r2h links of a tile attached to several hubs, on the
+        // signals of the tile
+        if (it != GlobalParams::hub_for_tile.end())
+        {
+            const vector<int> & hubs = GlobalParams::hubs_for_tile[tile_id];
+
+            for (unsigned int k = 1; k < hubs.size(); k++)
+            {
+                int port = hub_connected_ports[hubs[k]]++;
+                HubLink & link = t[i][j]->hub_link[k - 1];
+
+                hub[hubs[k]]->tile2port_mapping[tile_id] = port;
+
+                hub[hubs[k]]->req_rx[port](link.req_to_hub);
+                hub[hubs[k]]->flit_rx[port](link.flit_to_hub);
+                hub[hubs[k]]->ack_rx[port](link.ack_from_hub);
+                hub[hubs[k]]->buffer_full_status_rx[port](link.buffer_full_status_from_hub);
+
+                hub[hubs[k]]->flit_tx[port](link.flit_from_hub);
+                hub[hubs[k]]->req_tx[port](link.req_from_hub);
+                hub[hubs[k]]->ack_tx[port](link.ack_to_hub);
+                hub[hubs[k]]->buffer_full_status_tx[port](link.buffer_full_status_to_hub);
+            }
+        }
+
         // Map buffer level signals (analogy with req_tx/rx port mapping)
 	    t[i][j]->free_slots[DIRECTION_NORTH] (free_slots[i][j].north);
 	    t[i][j]->free_slots[DIRECTION_EAST] (free_slots[i + 1][j].east);
@@ -2405,3 +2439,109 @@ void NoC::asciiMonitor()
 	}
 }
 
+void NoC::profileMonitor()
+{
+	double cycle = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+	if (cycle > 0 && (long)cycle % GlobalParams::profile_interval == 0)
+		Profiler::sample(cycle);
+}
+
+void NoC::buildPowerTrace()
+{
+	const int router_categories = (1 << PT_BUFFER) | (1 << PT_LOGIC) | (1 << PT_LINK) | (1 << PT_NI);
+	const int hub_categories = (1 << PT_BUFFER) | (1 << PT_LINK) | (1 << PT_WIRELESS);
+	char name[64];
+
+	if (GlobalParams::thermal_model)
+		thermal_model.configure(GlobalParams::mesh_dim_x, GlobalParams::mesh_dim_y, GlobalParams::r2r_link_length);
+
+	// units are listed in floorplan order: routers by tile id, then hubs
+	if (GlobalParams::topology == TOPOLOGY_MESH)
+	{
+		for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+			for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+			{
+				sprintf(name, "router_%d", t[x][y]->r->local_id);
+				power_trace.addUnit(name, &t[x][y]->r->power, router_categories);
+				if (GlobalParams::thermal_model)
+					thermal_model.addUnit(&t[x][y]->r->power, vector<int>(1, t[x][y]->r->local_id));
+			}
+	}
+	else
+	{
+		int stg = log2(GlobalParams::n_delta_tiles);
+		int sw = GlobalParams::n_delta_tiles / 2;
+
+		for (int i = 0; i < GlobalParams::n_delta_tiles; i++)
+		{
+			sprintf(name, "router_%d", core[i]->r->local_id);
+			power_trace.addUnit(name, &core[i]->r->power, router_categories);
+		}
+		for (int i = 0; i < stg; i++)
+			for (int j = 0; j < sw; j++)
+			{
+				sprintf(name, "switch_%d_%d", i, j);
+				power_trace.addUnit(name, &t[i][j]->r->power, router_categories);
+			}
+	}
+
+	for (map<int, Hub*>::iterator it = hub.begin(); it != hub.end(); ++it)
+	{
+		sprintf(name, "hub_%d", it->first);
+		power_trace.addUnit(name, &it->second->power, hub_categories);
+
+		// the hub dissipates on the tiles it is attached to
+		if (GlobalParams::thermal_model)
+		{
+			vector<int> tiles;
+
+			for (map<int, vector<int> >::iterator ht = GlobalParams::hubs_for_tile.begin();
+			     ht != GlobalParams::hubs_for_tile.end(); ++ht)
+				if (find(ht->second.begin(), ht->second.end(), it->first) != ht->second.end())
+					tiles.push_back(ht->first);
+			thermal_model.addUnit(&it->second->power, tiles);
+		}
+	}
+
+	if (GlobalParams::power_trace_mode)
+		power_trace.open(GlobalParams::power_trace_filename, GlobalParams::power_trace_breakdown);
+}
+
+void NoC::powerTraceMonitor()
+{
+	if (reset.read())
+		return;
+
+	if (power_trace.cycle(GlobalParams::power_trace_epoch) && GlobalParams::thermal_model)
+		thermal_model.update(power_trace.getUnitPower(),
+				     GlobalParams::power_trace_epoch * GlobalParams::clock_period_ps * 1.0e-12);
+}
+
+void NoC::buildWirelessPaths()
+{
+	// any router computes the delta paths
+	if (GlobalParams::topology == TOPOLOGY_MESH)
+		WirelessPaths::configure(t[0][0]->r, hub);
+	else
+		WirelessPaths::configure(core[0]->r, hub);
+}
+
+void NoC::buildDVFS()
+{
+	vector<Router*> routers(GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y);
+
+	for (int y = 0; y < GlobalParams::mesh_dim_y; y++)
+		for (int x = 0; x < GlobalParams::mesh_dim_x; x++)
+			routers[t[x][y]->r->local_id] = t[x][y]->r;
+
+	dvfs.configure(routers);
+}
+
+void NoC::dvfsMonitor()
+{
+	if (reset.read())
+		return;
+
+	dvfs.cycle();
+}
@@ -18,6 +18,9 @@
 #include "Hub.h"
 #include "Channel.h"
 #include "TokenRing.h"
+#include "PowerTrace.h"
+#include "ThermalModel.h"
+#include "DVFS.h"
 
 using namespace std;
 
@@ -87,6 +90,13 @@ SC_MODULE(NoC)
     GlobalRoutingTable grtable;
     GlobalTrafficTable gttable;
 
+    // Per-epoch power of routers and hubs
+    PowerTrace power_trace;
+    ThermalModel thermal_model;
+
+    // Voltage/frequency levels of the routers
+    DVFSController dvfs;
+
 
     // Constructor
 
@@ -107,9 +117,8 @@ SC_MODULE(NoC)
 	    cerr << "ERROR: Topology " << GlobalParams::topology << " is not yet supported." << endl;
 	    exit(0);
     }
-	GlobalParams::channel_selection = CHSEL_RANDOM;
-	// out of yaml configuration (experimental features)
-	//GlobalParams::channel_selection = CHSEL_FIRST_FREE;
+	if (GlobalParams::use_winoc)
+	    buildWirelessPaths();
 
 	if (GlobalParams::ascii_monitor)
 	{
@@ -117,6 +126,26 @@ SC_MODULE(NoC)
 	    sensitive << clock.pos();
 	}
 
+	if (GlobalParams::profiling)
+	{
+	    SC_METHOD(profileMonitor);
+	    sensitive << clock.pos();
+	}
+
+	if (GlobalParams::power_trace_mode || GlobalParams::thermal_model)
+	{
+	    buildPowerTrace();
+	    SC_METHOD(powerTraceMonitor);
+	    sensitive << clock.pos();
+	}
+
+	if (GlobalParams::dvfs_mode)
+	{
+	    buildDVFS();
+	    SC_METHOD(dvfsMonitor);
+	    sensitive << clock.pos();
+	}
+
     }
 
     // Support methods
@@ -129,7 +158,13 @@ SC_MODULE(NoC)
     void buildBaseline();
     void buildOmega();
     void buildCommon();
+    void buildWirelessPaths();
     void asciiMonitor();
+    void profileMonitor();
+    void buildPowerTrace();
+    void powerTraceMonitor();
+    void buildDVFS();
+    void dvfsMonitor();
     int * hub_connected_ports;
 };
 
@@ -9,6 +9,7 @@
  */
 
 #include <iostream>
+#include <cmath>
 #include "Power.h"
 #include "Utils.h"
 #include "systemc.h"
@@ -17,6 +18,65 @@
 
 using namespace std;
 
+// Linear interpolation of a table, extrapolated from its two closest
+// points outside of the characterized range
+template <typename K>
+static double interpolate(const map<K, double> & table, double x)
+{
+    assert(!table.empty());
+
+    typename map<K, double>::const_iterator hi = table.begin();
+
+    while (hi != table.end() && hi->first < x)
+	hi++;
+
+    if (hi != table.end() && hi->first == x)
+	return hi->second;
+    if (table.size() == 1)
+	return table.begin()->second;
+
+    if (hi == table.end())
+	hi--;
+    if (hi == table.begin())
+	hi++;
+
+    typename map<K, double>::const_iterator lo = hi;
+    lo--;
+
+    double y = lo->second + (hi->second - lo->second) * (x - lo->first) / (hi->first - lo->first);
+
+    return max(y, 0.0);
+}
+
+// Interpolation of a table indexed by (x, y): along x within each row
+// of equal y, then along y
+template <typename K>
+static double interpolate(const map<pair <K, K>, double> & table, double x, double y)
+{
+    map<K, map<K, double> > rows;
+    map<K, double> column;
+
+    for (typename map<pair <K, K>, double>::const_iterator it = table.begin(); it != table.end(); it++)
+	rows[it->first.second][it->first.first] = it->second;
+
+    for (typename map<K, map<K, double> >::iterator it = rows.begin(); it != rows.end(); it++)
+	column[it->first] = interpolate(it->second, x);
+
+    return interpolate(column, y);
+}
+
+// One of the two values of a table of (static, dynamic) pairs
+template <typename K>
+static map<K, double> component(const map<K, pair <double, double> > & table, bool first)
+{
+    map<K, double> values;
+
+    for (typename map<K, pair <double, double> >::const_iterator it = table.begin(); it != table.end(); it++)
+	values[it->first] = first ? it->second.first : it->second.second;
+
+    return values;
+}
+
 
 Power::Power()
 {
@@ -72,6 +132,14 @@ Power::Power()
     sleep_end_cycle = NOT_VALID;
 
     initPowerBreakdown();
+
+    for (int i = 0; i < NO_BREAKDOWN_ENTRIES_D; i++)
+	dynamic_events[i] = 0;
+    for (int i = 0; i < NO_BREAKDOWN_ENTRIES_S; i++)
+	static_cycles[i] = 0;
+    leakage_scale = 1.0;
+    voltage_scale = 1.0;
+    initEnergyTables();
 }
 
 void Power::configureRouter(int link_width,
@@ -83,20 +151,15 @@ void Power::configureRouter(int link_width,
 // (s)tatic, (d)ynamic power
 
     // Buffer 
-    pair<int,int> key = pair<int,int>(buffer_depth, buffer_item_size);
-    
-    assert(GlobalParams::power_configuration.bufferPowerConfig.leakage.find(key) != GlobalParams::power_configuration.bufferPowerConfig.leakage.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.push.find(key) != GlobalParams::power_configuration.bufferPowerConfig.push.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.front.find(key) != GlobalParams::power_configuration.bufferPowerConfig.front.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.pop.find(key) != GlobalParams::power_configuration.bufferPowerConfig.pop.end());
+    BufferPowerConfig & bpc = GlobalParams::power_configuration.bufferPowerConfig;
 
     // Dynamic values are expressed in Joule
     // Static/Leakage values must be converted from Watt to Joule
 
-    buffer_router_pwr_s = W2J(GlobalParams::power_configuration.bufferPowerConfig.leakage[key]);
-    buffer_router_push_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.push[key];
-    buffer_router_front_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.front[key];
-    buffer_router_pop_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.pop[key];
+    buffer_router_pwr_s = W2J(interpolate(bpc.leakage, buffer_depth, buffer_item_size));
+    buffer_router_push_pwr_d = interpolate(bpc.push, buffer_depth, buffer_item_size);
+    buffer_router_front_pwr_d = interpolate(bpc.front, buffer_depth, buffer_item_size);
+    buffer_router_pop_pwr_d = interpolate(bpc.pop, buffer_depth, buffer_item_size);
 
     // Routing 
     assert(GlobalParams::power_configuration.routerPowerConfig.routing_algorithm_pm.find(routing_function) != GlobalParams::power_configuration.routerPowerConfig.routing_algorithm_pm.end());
@@ -112,31 +175,31 @@ void Power::configureRouter(int link_width,
 
     // CrossBar
     // TODO future work: tuning of crossbar radix
-    pair<int,int> xbar_k = pair<int,int>(5,GlobalParams::flit_size);
-    assert(GlobalParams::power_configuration.routerPowerConfig.crossbar_pm.find(xbar_k) != GlobalParams::power_configuration.routerPowerConfig.crossbar_pm.end());
-    crossbar_pwr_s = W2J(GlobalParams::power_configuration.routerPowerConfig.crossbar_pm[xbar_k].first);
-    crossbar_pwr_d = GlobalParams::power_configuration.routerPowerConfig.crossbar_pm[xbar_k].second;
+    RouterPowerConfig & rpc = GlobalParams::power_configuration.routerPowerConfig;
+
+    crossbar_pwr_s = W2J(interpolate(component(rpc.crossbar_pm, true), 5, GlobalParams::flit_size));
+    crossbar_pwr_d = interpolate(component(rpc.crossbar_pm, false), 5, GlobalParams::flit_size);
     
     // NetworkInterface
-    ni_pwr_s = W2J(GlobalParams::power_configuration.routerPowerConfig.network_interface[GlobalParams::flit_size].first);
-    ni_pwr_d = GlobalParams::power_configuration.routerPowerConfig.network_interface[GlobalParams::flit_size].second;
+    ni_pwr_s = W2J(interpolate(component(rpc.network_interface, true), GlobalParams::flit_size));
+    ni_pwr_d = interpolate(component(rpc.network_interface, false), GlobalParams::flit_size);
 
     // Link 
     // Router has both type of links
+    LinkBitLinePowerConfig & lpc = GlobalParams::power_configuration.linkBitLinePowerConfig;
     double length_r2h = GlobalParams::r2h_link_length;
     double length_r2r = GlobalParams::r2r_link_length;
-    
-    assert(GlobalParams::power_configuration.linkBitLinePowerConfig.find(length_r2r)!=GlobalParams::power_configuration.linkBitLinePowerConfig.end());
-    assert(GlobalParams::power_configuration.linkBitLinePowerConfig.find(length_r2h)!=GlobalParams::power_configuration.linkBitLinePowerConfig.end());
 
+    link_r2r_pwr_s= W2J(link_width * interpolate(component(lpc, true), length_r2r));
+    link_r2r_pwr_d= link_width * interpolate(component(lpc, false), length_r2r);
+    link_r2h_pwr_s= W2J(link_width * interpolate(component(lpc, true), length_r2h));
+    link_r2h_pwr_d= link_width * interpolate(component(lpc, false), length_r2h);
 
-    link_r2r_pwr_s= W2J(link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2r].first);
-    link_r2r_pwr_d= link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2r].second;
-    link_r2h_pwr_s= W2J(link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2h].first);
-    link_r2h_pwr_d= link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2h].second;
+    initEnergyTables();
 }
 
-void Power::configureHub(int link_width,
+void Power::configureHub(int hub_id,
+	int link_width,
 	int buffer_to_tile_depth, // buffer to tile
 	int buffer_from_tile_depth, // buffer from tile
 	int buffer_item_size,
@@ -148,68 +211,49 @@ void Power::configureHub(int link_width,
 // (s)tatic, (d)ynamic power
 
     // Buffer 
-    pair<int,int> key_to_tile = pair<int,int>(buffer_to_tile_depth, buffer_item_size);
-    pair<int,int> key_from_tile = pair<int,int>(buffer_from_tile_depth, buffer_item_size);
-    
-    assert(GlobalParams::power_configuration.bufferPowerConfig.leakage.find(key_to_tile) != GlobalParams::power_configuration.bufferPowerConfig.leakage.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.push.find(key_to_tile) != GlobalParams::power_configuration.bufferPowerConfig.push.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.front.find(key_to_tile) != GlobalParams::power_configuration.bufferPowerConfig.front.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.pop.find(key_to_tile) != GlobalParams::power_configuration.bufferPowerConfig.pop.end());
-
-    assert(GlobalParams::power_configuration.bufferPowerConfig.leakage.find(key_from_tile) != GlobalParams::power_configuration.bufferPowerConfig.leakage.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.push.find(key_from_tile) != GlobalParams::power_configuration.bufferPowerConfig.push.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.front.find(key_from_tile) != GlobalParams::power_configuration.bufferPowerConfig.front.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.pop.find(key_from_tile) != GlobalParams::power_configuration.bufferPowerConfig.pop.end());
-
-    buffer_to_tile_pwr_s = W2J(GlobalParams::power_configuration.bufferPowerConfig.leakage[key_to_tile]);
-    buffer_to_tile_push_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.push[key_to_tile];
-    buffer_to_tile_front_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.front[key_to_tile];
-    buffer_to_tile_pop_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.pop[key_to_tile];
-
-    buffer_from_tile_pwr_s = W2J(GlobalParams::power_configuration.bufferPowerConfig.leakage[key_from_tile]);
-    buffer_from_tile_push_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.push[key_from_tile];
-    buffer_from_tile_front_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.front[key_from_tile];
-    buffer_from_tile_pop_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.pop[key_from_tile];
-   
-    // Buffer Antenna RX
-    pair<int,int> akey = pair<int,int>(antenna_buffer_rx_depth,antenna_buffer_item_size);
-    
-    assert(GlobalParams::power_configuration.bufferPowerConfig.leakage.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.leakage.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.push.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.push.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.front.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.front.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.pop.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.pop.end());
-
-    antenna_buffer_pwr_s = W2J(GlobalParams::power_configuration.bufferPowerConfig.leakage[akey]);
-    antenna_buffer_push_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.push[akey];
-    antenna_buffer_front_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.front[akey];
-    antenna_buffer_pop_pwr_d = GlobalParams::power_configuration.bufferPowerConfig.pop[akey];
-
-    // Buffer Antenna TX
-    akey = pair<int,int>(antenna_buffer_tx_depth,antenna_buffer_item_size);
-    
-    assert(GlobalParams::power_configuration.bufferPowerConfig.leakage.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.leakage.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.push.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.push.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.front.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.front.end());
-    assert(GlobalParams::power_configuration.bufferPowerConfig.pop.find(akey) != GlobalParams::power_configuration.bufferPowerConfig.pop.end());
-
-    // TODO: currently both RX/RX values are aggregated and then an average is returned 
-    antenna_buffer_pwr_s += W2J(GlobalParams::power_configuration.bufferPowerConfig.leakage[akey]);
-    antenna_buffer_push_pwr_d += GlobalParams::power_configuration.bufferPowerConfig.push[akey];
-    antenna_buffer_front_pwr_d += GlobalParams::power_configuration.bufferPowerConfig.front[akey];
-    antenna_buffer_pop_pwr_d += GlobalParams::power_configuration.bufferPowerConfig.pop[akey];
+    BufferPowerConfig & bpc = GlobalParams::power_configuration.bufferPowerConfig;
 
-    antenna_buffer_pwr_s = antenna_buffer_pwr_s/2;
-    antenna_buffer_push_pwr_d = antenna_buffer_push_pwr_d/2; 
-    antenna_buffer_front_pwr_d = antenna_buffer_front_pwr_d/2;
-    antenna_buffer_pop_pwr_d = antenna_buffer_pop_pwr_d/2;
-
-    attenuation_map = GlobalParams::power_configuration.hubPowerConfig.transmitter_attenuation_map;
+    buffer_to_tile_pwr_s = W2J(interpolate(bpc.leakage, buffer_to_tile_depth, buffer_item_size));
+    buffer_to_tile_push_pwr_d = interpolate(bpc.push, buffer_to_tile_depth, buffer_item_size);
+    buffer_to_tile_front_pwr_d = interpolate(bpc.front, buffer_to_tile_depth, buffer_item_size);
+    buffer_to_tile_pop_pwr_d = interpolate(bpc.pop, buffer_to_tile_depth, buffer_item_size);
 
+    buffer_from_tile_pwr_s = W2J(interpolate(bpc.leakage, buffer_from_tile_depth, buffer_item_size));
+    buffer_from_tile_push_pwr_d = interpolate(bpc.push, buffer_from_tile_depth, buffer_item_size);
+    buffer_from_tile_front_pwr_d = interpolate(bpc.front, buffer_from_tile_depth, buffer_item_size);
+    buffer_from_tile_pop_pwr_d = interpolate(bpc.pop, buffer_from_tile_depth, buffer_item_size);
+   
+    // Buffer Antenna RX/TX
+    // TODO: currently both RX/RX values are aggregated and then an average is returned 
+    antenna_buffer_pwr_s = (W2J(interpolate(bpc.leakage, antenna_buffer_rx_depth, antenna_buffer_item_size)) +
+			    W2J(interpolate(bpc.leakage, antenna_buffer_tx_depth, antenna_buffer_item_size))) / 2;
+    antenna_buffer_push_pwr_d = (interpolate(bpc.push, antenna_buffer_rx_depth, antenna_buffer_item_size) +
+				 interpolate(bpc.push, antenna_buffer_tx_depth, antenna_buffer_item_size)) / 2;
+    antenna_buffer_front_pwr_d = (interpolate(bpc.front, antenna_buffer_rx_depth, antenna_buffer_item_size) +
+				  interpolate(bpc.front, antenna_buffer_tx_depth, antenna_buffer_item_size)) / 2;
+    antenna_buffer_pop_pwr_d = (interpolate(bpc.pop, antenna_buffer_rx_depth, antenna_buffer_item_size) +
+				interpolate(bpc.pop, antenna_buffer_tx_depth, antenna_buffer_item_size)) / 2;
 
     // TX
     // Joule
     default_tx_energy = (GlobalParams::power_configuration.hubPowerConfig.default_tx_energy / (1e9*data_rate_gbs) )* antenna_buffer_item_size;
 
+    // energy of a flit towards each destination hub, scaled by the
+    // attenuation of the path when enabled (missing pairs: no attenuation)
+    map<pair <int, int>, double> & attenuation_map = GlobalParams::power_configuration.hubPowerConfig.transmitter_attenuation_map;
+    int n_hubs = GlobalParams::hub_configuration.empty() ? 0 : GlobalParams::hub_configuration.rbegin()->first + 1;
+
+    tx_energy.assign(n_hubs, default_tx_energy);
+    tx_events.assign(n_hubs, 0);
+    if (GlobalParams::winoc_tx_attenuation)
+	for (int dst = 0; dst < n_hubs; dst++)
+	{
+	    map<pair <int, int>, double>::iterator it = attenuation_map.find(make_pair(hub_id, dst));
+
+	    if (it != attenuation_map.end())
+		tx_energy[dst] = default_tx_energy * attenuation2power(it->second);
+	}
+
     // RX Dynamic
     wireless_rx_pwr = antenna_buffer_item_size * GlobalParams::power_configuration.hubPowerConfig.rx_dynamic;
     
@@ -227,117 +271,109 @@ void Power::configureHub(int link_width,
     transceiver_tx_pwr_biasing = W2J(GlobalParams::power_configuration.hubPowerConfig.transceiver_biasing.second);
     // Link 
     // Hub has only Router/Hub link connections
+    LinkBitLinePowerConfig & lpc = GlobalParams::power_configuration.linkBitLinePowerConfig;
     double length_r2h = GlobalParams::r2h_link_length;
-    assert(GlobalParams::power_configuration.linkBitLinePowerConfig.find(length_r2h)!=GlobalParams::power_configuration.linkBitLinePowerConfig.end());
-
-    link_r2h_pwr_s= W2J(link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2h].first);
-    link_r2h_pwr_d= link_width * GlobalParams::power_configuration.linkBitLinePowerConfig[length_r2h].second;
-
-}
-
-
-// Router buffer
-void Power::bufferRouterPush()
-{
-    power_dynamic.breakdown[BUFFER_PUSH_PWR_D].value += buffer_router_push_pwr_d;
-}
-
-void Power::bufferRouterPop()
-{
-    power_dynamic.breakdown[BUFFER_POP_PWR_D].value += buffer_router_pop_pwr_d;
-}
-
-void Power::bufferRouterFront()
-{
-    power_dynamic.breakdown[BUFFER_FRONT_PWR_D].value += buffer_router_front_pwr_d;
-}
-
-// Hub to tile
-void Power::bufferToTilePush()
-{
-    power_dynamic.breakdown[BUFFER_TO_TILE_PUSH_PWR_D].value += buffer_to_tile_push_pwr_d;
-}
-
-void Power::bufferToTilePop()
-{
-    power_dynamic.breakdown[BUFFER_TO_TILE_POP_PWR_D].value += buffer_to_tile_pop_pwr_d;
-}
-
-void Power::bufferToTileFront()
-{
-
-    power_dynamic.breakdown[BUFFER_TO_TILE_FRONT_PWR_D].value += buffer_to_tile_front_pwr_d;
-}
-
-// Hub from tile
-void Power::bufferFromTilePush()
-{
-    power_dynamic.breakdown[BUFFER_FROM_TILE_PUSH_PWR_D].value += buffer_from_tile_push_pwr_d;
-}
-
-void Power::bufferFromTilePop()
-{
-    power_dynamic.breakdown[BUFFER_FROM_TILE_POP_PWR_D].value += buffer_from_tile_pop_pwr_d;
-}
-
-void Power::bufferFromTileFront()
-{
-
-    power_dynamic.breakdown[BUFFER_FROM_TILE_FRONT_PWR_D].value += buffer_from_tile_front_pwr_d;
-}
-
-
-// Antenna buffers (RX/TX)
-void Power::antennaBufferPush()
-{
-    power_dynamic.breakdown[ANTENNA_BUFFER_PUSH_PWR_D].value += antenna_buffer_push_pwr_d;
-}
 
-void Power::antennaBufferPop()
-{
-    power_dynamic.breakdown[ANTENNA_BUFFER_POP_PWR_D].value += antenna_buffer_pop_pwr_d;
-}
+    link_r2h_pwr_s= W2J(link_width * interpolate(component(lpc, true), length_r2h));
+    link_r2h_pwr_d= link_width * interpolate(component(lpc, false), length_r2h);
+
+    initEnergyTables();
+}
+
+
+// Maps the coefficients loaded by configureRouter/configureHub to the
+// breakdown entries (those not configured are zero)
+void Power::initEnergyTables()
+{
+    dynamic_energy[BUFFER_PUSH_PWR_D] = buffer_router_push_pwr_d;
+    dynamic_energy[BUFFER_POP_PWR_D] = buffer_router_pop_pwr_d;
+    dynamic_energy[BUFFER_FRONT_PWR_D] = buffer_router_front_pwr_d;
+    dynamic_energy[BUFFER_TO_TILE_PUSH_PWR_D] = buffer_to_tile_push_pwr_d;
+    dynamic_energy[BUFFER_TO_TILE_POP_PWR_D] = buffer_to_tile_pop_pwr_d;
+    dynamic_energy[BUFFER_TO_TILE_FRONT_PWR_D] = buffer_to_tile_front_pwr_d;
+    dynamic_energy[BUFFER_FROM_TILE_PUSH_PWR_D] = buffer_from_tile_push_pwr_d;
+    dynamic_energy[BUFFER_FROM_TILE_POP_PWR_D] = buffer_from_tile_pop_pwr_d;
+    dynamic_energy[BUFFER_FROM_TILE_FRONT_PWR_D] = buffer_from_tile_front_pwr_d;
+    dynamic_energy[ANTENNA_BUFFER_PUSH_PWR_D] = antenna_buffer_push_pwr_d;
+    dynamic_energy[ANTENNA_BUFFER_POP_PWR_D] = antenna_buffer_pop_pwr_d;
+    dynamic_energy[ANTENNA_BUFFER_FRONT_PWR_D] = antenna_buffer_front_pwr_d;
+    dynamic_energy[ROUTING_PWR_D] = routing_pwr_d;
+    dynamic_energy[SELECTION_PWR_D] = selection_pwr_d;
+    dynamic_energy[CROSSBAR_PWR_D] = crossbar_pwr_d;
+    dynamic_energy[LINK_R2R_PWR_D] = link_r2r_pwr_d;
+    dynamic_energy[LINK_R2H_PWR_D] = link_r2h_pwr_d;
+    dynamic_energy[NI_PWR_D] = ni_pwr_d;
+    dynamic_energy[WIRELESS_TX] = 0.0;	// per destination hub, see tx_energy
+    dynamic_energy[WIRELESS_DYNAMIC_RX_PWR] = wireless_rx_pwr;
+    dynamic_energy[WIRELESS_SNOOPING] = wireless_snooping;
+    dynamic_energy[PG_WAKEUP_PWR_D] = GlobalParams::pg_wakeup_energy;
+    dynamic_energy[WIRELESS_WAKEUP_PWR_D] = GlobalParams::wireless_wakeup_energy;
+
+    // the characterized energy of a flit assumes random data, i.e. half
+    // of its bits toggling: with payloads it is spent per toggling bit
+    if (GlobalParams::payload_energy)
+    {
+	dynamic_energy[BUFFER_PUSH_PWR_D] /= GlobalParams::flit_size / 2.0;
+	dynamic_energy[LINK_R2R_PWR_D] /= GlobalParams::flit_size / 2.0;
+	dynamic_energy[LINK_R2H_PWR_D] /= GlobalParams::flit_size / 2.0;
+    }
 
-void Power::antennaBufferFront()
-{
-    power_dynamic.breakdown[ANTENNA_BUFFER_FRONT_PWR_D].value += antenna_buffer_front_pwr_d;
-}
+    static_energy[TRANSCEIVER_RX_PWR_BIASING] = transceiver_rx_pwr_biasing;
+    static_energy[TRANSCEIVER_TX_PWR_BIASING] = transceiver_tx_pwr_biasing;
+    // Router: input buffers leakage, Hub: buffer_from_tile/to_tile leakage
+    static_energy[BUFFER_ROUTER_PWR_S] = buffer_router_pwr_s;
+    static_energy[BUFFER_TO_TILE_PWR_S] = buffer_to_tile_pwr_s;
+    static_energy[BUFFER_FROM_TILE_PWR_S] = buffer_from_tile_pwr_s;
+    // each buffer_rx (Targets) or buffer_tx (Initiators)
+    static_energy[ANTENNA_BUFFER_PWR_S] = antenna_buffer_pwr_s;
+    static_energy[LINK_R2H_PWR_S] = link_r2h_pwr_s;
+    static_energy[ROUTING_PWR_S] = routing_pwr_s;
+    static_energy[SELECTION_PWR_S] = selection_pwr_s;
+    static_energy[CROSSBAR_PWR_S] = crossbar_pwr_s;
+    static_energy[NI_PWR_S] = ni_pwr_s;
+    static_energy[TRANSCEIVER_RX_PWR_S] = transceiver_rx_pwr_s;
+    static_energy[TRANSCEIVER_TX_PWR_S] = transceiver_tx_pwr_s;
+}
+
+void Power::accumulate()
+{
+    for (int i = 0; i < NO_BREAKDOWN_ENTRIES_D; i++)
+    {
+	power_dynamic.breakdown[i].value += dynamic_events[i] * dynamic_energy[i] * voltage_scale * voltage_scale;
+	dynamic_events[i] = 0;
+    }
 
+    for (unsigned int dst = 0; dst < tx_events.size(); dst++)
+    {
+	power_dynamic.breakdown[WIRELESS_TX].value += tx_events[dst] * tx_energy[dst] * voltage_scale * voltage_scale;
+	tx_events[dst] = 0;
+    }
 
-void Power::routing()
-{
-    power_dynamic.breakdown[ROUTING_PWR_D].value += routing_pwr_d;
-}
+    for (int i = 0; i < NO_BREAKDOWN_ENTRIES_S; i++)
+    {
+	double scale = (i == TRANSCEIVER_RX_PWR_BIASING || i == TRANSCEIVER_TX_PWR_BIASING) ? 1.0 : leakage_scale * voltage_scale;
 
-void Power::selection()
-{
-    power_dynamic.breakdown[SELECTION_PWR_D].value +=selection_pwr_d ;
+	power_static.breakdown[i].value += static_cycles[i] * static_energy[i] * scale;
+	static_cycles[i] = 0;
+    }
 }
 
-void Power::crossBar()
+void Power::wirelessTx(const vector<int> & dsts)
 {
-    power_dynamic.breakdown[CROSSBAR_PWR_D].value +=crossbar_pwr_d;
-}
+    int farthest = dsts[0];
 
-void Power::r2rLink()
-{
-    power_dynamic.breakdown[LINK_R2R_PWR_D].value +=link_r2r_pwr_d;
-}
+    for (unsigned int i = 1; i < dsts.size(); i++)
+	if (tx_energy[dsts[i]] > tx_energy[farthest])
+	    farthest = dsts[i];
 
-void Power::r2hLink()
-{
-    power_dynamic.breakdown[LINK_R2H_PWR_D].value +=link_r2h_pwr_d;
+    tx_events[farthest]++;
 }
 
-void Power::networkInterface()
-{
-    power_dynamic.breakdown[NI_PWR_D].value +=ni_pwr_d;
-}
-
-
 double Power::getDynamicPower()
 {
     double power = 0.0;
+
+    accumulate();
     for (int i = 0; i<power_dynamic.size; i++)
     {
 	power+= power_dynamic.breakdown[i].value;
@@ -349,6 +385,8 @@ double Power::getDynamicPower()
 double Power::getStaticPower()
 {
     double power = 0.0;
+
+    accumulate();
     for (int i = 0; i<power_static.size; i++)
 	power+= power_static.breakdown[i].value;
 
@@ -356,108 +394,24 @@ double Power::getStaticPower()
 }
 
 
+// Transmit power needed to compensate an attenuation [dB]
 double Power::attenuation2power(double attenuation)
 {
-    // TODO
-    return attenuation;
-}
-
-
-
-void Power::wirelessTx(int src,int dst,int length)
-{
-    power_dynamic.breakdown[WIRELESS_TX].value += default_tx_energy;
-    return;
-
-    // TODO enable attenuation_map
-
-    pair<int,int> key = pair<int,int>(src,dst);
-    assert(attenuation_map.find(key)!=attenuation_map.end());
-
-    power_dynamic.breakdown[WIRELESS_TX].value += attenuation2power(attenuation_map[key]) * length;
-}
-
-void Power::wirelessDynamicRx()
-{
-    power_dynamic.breakdown[WIRELESS_DYNAMIC_RX_PWR].value += wireless_rx_pwr;
-}
-
-void Power::wirelessSnooping()
-{
-    power_dynamic.breakdown[WIRELESS_SNOOPING].value += wireless_snooping;
-}
-
-
-void Power::biasingRx()
-{
-    power_static.breakdown[TRANSCEIVER_RX_PWR_BIASING].value += transceiver_rx_pwr_biasing;
-}
-
-void Power::biasingTx()
-{
-    power_static.breakdown[TRANSCEIVER_TX_PWR_BIASING].value += transceiver_tx_pwr_biasing;
-
-}
-
-// Note: In the following 3 functions buffer_pwr_s 
-// is assumed as loaded with the proper values from configuration file:
-// - Router: takes the value of input buffers leakage
-// - Hub: takes the leakage value of buffer_from_tile/to_tile
-void Power::leakageBufferRouter()
-{
-    power_static.breakdown[BUFFER_ROUTER_PWR_S].value +=buffer_router_pwr_s;
-}
-
-void Power::leakageBufferToTile()
-{
-    power_static.breakdown[BUFFER_TO_TILE_PWR_S].value +=buffer_to_tile_pwr_s;
-}
-
-void Power::leakageBufferFromTile()
-{
-    power_static.breakdown[BUFFER_FROM_TILE_PWR_S].value +=buffer_from_tile_pwr_s;
-}
-
-// Account for each buffer_rx (Targets) or buffer_tx (Initiators)
-void Power::leakageAntennaBuffer()
-{
-    power_static.breakdown[ANTENNA_BUFFER_PWR_S].value +=(antenna_buffer_pwr_s);
-}
-
-void Power::leakageLinkRouter2Router()
-{
-    //power_static.breakdown[LINK_R2R_PWR_S].value +=link_r2r_pwr_s;
-}
-
-void Power::leakageLinkRouter2Hub()
-{
-    power_static.breakdown[LINK_R2H_PWR_S].value +=link_r2h_pwr_s;
+    return pow(10.0, attenuation / 10.0);
 }
 
 void Power::leakageRouter()
 {
     // note: leakage contributions depending on instance number are 
     // accounted in specific separate leakage functions
-    power_static.breakdown[ROUTING_PWR_S].value +=routing_pwr_s;
-    power_static.breakdown[SELECTION_PWR_S].value +=selection_pwr_s;
-    power_static.breakdown[CROSSBAR_PWR_S].value +=crossbar_pwr_s;
-    power_static.breakdown[NI_PWR_S].value +=ni_pwr_s;
+    static_cycles[ROUTING_PWR_S]++;
+    static_cycles[SELECTION_PWR_S]++;
+    static_cycles[CROSSBAR_PWR_S]++;
+    static_cycles[NI_PWR_S]++;
 }
 
 
 
-void Power::leakageTransceiverRx()
-{
-
-    power_static.breakdown[TRANSCEIVER_RX_PWR_S].value +=transceiver_rx_pwr_s;
-}
-
-void Power::leakageTransceiverTx()
-{
-
-    power_static.breakdown[TRANSCEIVER_TX_PWR_S].value +=transceiver_tx_pwr_s;
-}
-
 void Power::printBreakDown(std::ostream & out)
 {
     assert(false);
@@ -518,6 +472,8 @@ void Power::initPowerBreakdown()
     initPowerBreakdownEntry(&power_dynamic.breakdown[WIRELESS_TX],"wireless_tx");
     initPowerBreakdownEntry(&power_dynamic.breakdown[WIRELESS_DYNAMIC_RX_PWR],"wireless_dynamic_rx_pwr");
     initPowerBreakdownEntry(&power_dynamic.breakdown[WIRELESS_SNOOPING],"wireless_snooping");
+    initPowerBreakdownEntry(&power_dynamic.breakdown[PG_WAKEUP_PWR_D],"pg_wakeup_pwr_d");
+    initPowerBreakdownEntry(&power_dynamic.breakdown[WIRELESS_WAKEUP_PWR_D],"wireless_wakeup_pwr_d");
 
     initPowerBreakdownEntry(&power_static.breakdown[TRANSCEIVER_RX_PWR_BIASING],"transceiver_rx_pwr_biasing");
     initPowerBreakdownEntry(&power_static.breakdown[TRANSCEIVER_TX_PWR_BIASING],"transceiver_tx_pwr_biasing");
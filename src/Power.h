@@ -13,6 +13,7 @@
 
 #include <cassert>
 #include <map>
+#include <vector>
 #include "DataStructs.h"
 
 #include "yaml-cpp/yaml.h"
@@ -34,7 +35,8 @@ class Power {
 			 string routing_function,
 			 string selection_function);
 
-    void configureHub(int link_width, 
+    void configureHub(int hub_id,
+	              int link_width, 
 	              int buffer_to_tile_depth, 
 	              int buffer_from_tile_depth, 
 		      int buffer_item_size, 
@@ -43,41 +45,73 @@ class Power {
 		      int antenna_buffer_item_size, 
 		      int data_rate_gbs);
 
-    void bufferRouterPush(); 
-    void bufferRouterPop(); 
-    void bufferRouterFront(); 
-    void bufferToTilePush(); 
-    void bufferToTilePop(); 
-    void bufferToTileFront(); 
-    void bufferFromTilePush(); 
-    void bufferFromTilePop(); 
-    void bufferFromTileFront(); 
-    void antennaBufferPush();
-    void antennaBufferPop();
-
-    void antennaBufferFront(); 
-    void wirelessTx(int src,int dst,int length);
-    void wirelessDynamicRx();
-    void wirelessSnooping();
-
-    void routing();
-    void selection(); 
-    void crossBar(); 
-    void r2hLink(); 
-    void r2rLink(); 
-    void networkInterface();
-
-    void leakageBufferRouter();
-    void leakageBufferToTile();
-    void leakageBufferFromTile();
-    void leakageAntennaBuffer();
-    void leakageLinkRouter2Router();
-    void leakageLinkRouter2Hub();
+    // Dynamic contributions are counted as events and static ones as
+    // powered-on cycles; energy is evaluated from the power.yaml
+    // coefficients only when accumulate() is called (on reporting)
+    void bufferRouterPush() { dynamic_events[BUFFER_PUSH_PWR_D]++; }
+    void bufferRouterPop() { dynamic_events[BUFFER_POP_PWR_D]++; }
+    void bufferRouterFront() { dynamic_events[BUFFER_FRONT_PWR_D]++; }
+    void bufferToTilePush() { dynamic_events[BUFFER_TO_TILE_PUSH_PWR_D]++; }
+    void bufferToTilePop() { dynamic_events[BUFFER_TO_TILE_POP_PWR_D]++; }
+    void bufferToTileFront() { dynamic_events[BUFFER_TO_TILE_FRONT_PWR_D]++; }
+    void bufferFromTilePush() { dynamic_events[BUFFER_FROM_TILE_PUSH_PWR_D]++; }
+    void bufferFromTilePop() { dynamic_events[BUFFER_FROM_TILE_POP_PWR_D]++; }
+    void bufferFromTileFront() { dynamic_events[BUFFER_FROM_TILE_FRONT_PWR_D]++; }
+    void antennaBufferPush() { dynamic_events[ANTENNA_BUFFER_PUSH_PWR_D]++; }
+    void antennaBufferPop() { dynamic_events[ANTENNA_BUFFER_POP_PWR_D]++; }
+
+    void antennaBufferFront() { dynamic_events[ANTENNA_BUFFER_FRONT_PWR_D]++; }
+    void wirelessTx(int dst) { tx_events[dst]++; }
+    void wirelessTx(const vector<int> & dsts);	// multicast, reaching the farthest hub
+    void wirelessDynamicRx() { dynamic_events[WIRELESS_DYNAMIC_RX_PWR]++; }
+    void wirelessSnooping() { dynamic_events[WIRELESS_SNOOPING]++; }
+
+    void routing() { dynamic_events[ROUTING_PWR_D]++; }
+    void selection() { dynamic_events[SELECTION_PWR_D]++; }
+    void crossBar() { dynamic_events[CROSSBAR_PWR_D]++; }
+    void r2hLink() { dynamic_events[LINK_R2H_PWR_D]++; }
+    void r2rLink() { dynamic_events[LINK_R2R_PWR_D]++; }
+
+    // Data-dependent variants (payload_energy): the events are the bits
+    // toggling with respect to the previous flit on the same wires
+    void bufferRouterPush(int toggles) { dynamic_events[BUFFER_PUSH_PWR_D] += toggles; }
+    void r2hLink(int toggles) { dynamic_events[LINK_R2H_PWR_D] += toggles; }
+    void r2rLink(int toggles) { dynamic_events[LINK_R2R_PWR_D] += toggles; }
+    void networkInterface() { dynamic_events[NI_PWR_D]++; }
+    void powerGatingWakeup() { dynamic_events[PG_WAKEUP_PWR_D]++; }
+    void wirelessWakeup() { dynamic_events[WIRELESS_WAKEUP_PWR_D]++; }
+
+    // Leakage of n instances for one cycle
+    void leakageBufferRouter(int n = 1) { static_cycles[BUFFER_ROUTER_PWR_S] += n; }
+    void leakageBufferToTile(int n = 1) { static_cycles[BUFFER_TO_TILE_PWR_S] += n; }
+    void leakageBufferFromTile(int n = 1) { static_cycles[BUFFER_FROM_TILE_PWR_S] += n; }
+    void leakageAntennaBuffer(int n = 1) { static_cycles[ANTENNA_BUFFER_PWR_S] += n; }
+    void leakageLinkRouter2Router(int n = 1) { /* not accounted */ }
+    void leakageLinkRouter2Hub() { static_cycles[LINK_R2H_PWR_S]++; }
     void leakageRouter();
-    void leakageTransceiverRx();
-    void leakageTransceiverTx();
-    void biasingRx();
-    void biasingTx();
+    void leakageTransceiverRx() { static_cycles[TRANSCEIVER_RX_PWR_S]++; }
+    void leakageTransceiverTx() { static_cycles[TRANSCEIVER_TX_PWR_S]++; }
+    void biasingRx() { static_cycles[TRANSCEIVER_RX_PWR_BIASING]++; }
+    void biasingTx() { static_cycles[TRANSCEIVER_TX_PWR_BIASING]++; }
+
+    // Converts the events and cycles counted so far into energy, to be
+    // called at the end of an epoch or before the coefficients change
+    void accumulate();
+
+    // Scales the leakage (static contributions but transceiver biasing)
+    // accounted from now on, e.g. to follow the temperature of the unit
+    void setLeakageScale(double scale) { accumulate(); leakage_scale = scale; }
+    double getLeakageScale() const { return leakage_scale; }
+
+    // Scales the supply voltage (relative to the nominal one) from now on:
+    // dynamic energy goes with its square, leakage linearly
+    void setVoltageScale(double scale) { accumulate(); voltage_scale = scale; }
+
+    // Energy [J] of one cycle of a static breakdown entry
+    double getStaticEnergy(int entry) const { return static_energy[entry] * leakage_scale * voltage_scale; }
+
+    // Energy [J] of the transmission of a flit to a hub
+    double getWirelessTxEnergy(int dst) const { return tx_energy[dst] * voltage_scale * voltage_scale; }
 
     double getDynamicPower();
     double getStaticPower();
@@ -90,8 +124,8 @@ class Power {
     void printBreakDown(std::ostream & out);
 
 
-    PowerBreakdown* getDynamicPowerBreakDown(){ return &power_dynamic;}
-    PowerBreakdown* getStaticPowerBreakDown(){ return &power_static;}
+    PowerBreakdown* getDynamicPowerBreakDown(){ accumulate(); return &power_dynamic;}
+    PowerBreakdown* getStaticPowerBreakDown(){ accumulate(); return &power_static;}
 
     void rxSleep(int cycles);
     bool isSleeping();
@@ -146,15 +180,28 @@ class Power {
     double ni_pwr_d;
     double ni_pwr_s;
 
-    map< pair<int, int> , double>  attenuation_map;
     double attenuation2power(double);
 
+    // Wireless flits sent to each destination hub, and their energy [J]
+    vector<unsigned long> tx_events;
+    vector<double> tx_energy;
+
 
     void printBreakDown(string label, const map<string,double> & m,std::ostream & out) const;
 
     PowerBreakdown power_dynamic;
     PowerBreakdown power_static;
 
+    // Events and powered-on cycles not yet converted into energy, and
+    // the energy (J) of a single event/cycle of each breakdown entry
+    unsigned long dynamic_events[NO_BREAKDOWN_ENTRIES_D];
+    unsigned long static_cycles[NO_BREAKDOWN_ENTRIES_S];
+    double dynamic_energy[NO_BREAKDOWN_ENTRIES_D];
+    double static_energy[NO_BREAKDOWN_ENTRIES_S];
+    double leakage_scale;
+    double voltage_scale;
+    void initEnergyTables();
+
     void initPowerBreakdownEntry(PowerBreakdownEntry* pbe,string label);
     void initPowerBreakdown();
 
@@ -0,0 +1,180 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the per-epoch power trace
+ */
+
+#include "PowerTrace.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// Category of each dynamic/static power breakdown entry
+static const int dynamic_category[NO_BREAKDOWN_ENTRIES_D] = {
+    PT_BUFFER,		// BUFFER_PUSH_PWR_D
+    PT_BUFFER,		// BUFFER_POP_PWR_D
+    PT_BUFFER,		// BUFFER_FRONT_PWR_D
+    PT_BUFFER,		// BUFFER_TO_TILE_PUSH_PWR_D
+    PT_BUFFER,		// BUFFER_TO_TILE_POP_PWR_D
+    PT_BUFFER,		// BUFFER_TO_TILE_FRONT_PWR_D
+    PT_BUFFER,		// BUFFER_FROM_TILE_PUSH_PWR_D
+    PT_BUFFER,		// BUFFER_FROM_TILE_POP_PWR_D
+    PT_BUFFER,		// BUFFER_FROM_TILE_FRONT_PWR_D
+    PT_BUFFER,		// ANTENNA_BUFFER_PUSH_PWR_D
+    PT_BUFFER,		// ANTENNA_BUFFER_POP_PWR_D
+    PT_BUFFER,		// ANTENNA_BUFFER_FRONT_PWR_D
+    PT_LOGIC,		// ROUTING_PWR_D
+    PT_LOGIC,		// SELECTION_PWR_D
+    PT_LOGIC,		// CROSSBAR_PWR_D
+    PT_LINK,		// LINK_R2R_PWR_D
+    PT_LINK,		// LINK_R2H_PWR_D
+    PT_NI,		// NI_PWR_D
+    PT_WIRELESS,	// WIRELESS_TX
+    PT_WIRELESS,	// WIRELESS_DYNAMIC_RX_PWR
+    PT_WIRELESS,	// WIRELESS_SNOOPING
+    PT_LOGIC,		// PG_WAKEUP_PWR_D
+    PT_WIRELESS		// WIRELESS_WAKEUP_PWR_D
+};
+
+static const int static_category[NO_BREAKDOWN_ENTRIES_S] = {
+    PT_WIRELESS,	// TRANSCEIVER_RX_PWR_BIASING
+    PT_WIRELESS,	// TRANSCEIVER_TX_PWR_BIASING
+    PT_BUFFER,		// BUFFER_ROUTER_PWR_S
+    PT_BUFFER,		// BUFFER_TO_TILE_PWR_S
+    PT_BUFFER,		// BUFFER_FROM_TILE_PWR_S
+    PT_BUFFER,		// ANTENNA_BUFFER_PWR_S
+    PT_LINK,		// LINK_R2H_PWR_S
+    PT_LOGIC,		// ROUTING_PWR_S
+    PT_LOGIC,		// SELECTION_PWR_S
+    PT_LOGIC,		// CROSSBAR_PWR_S
+    PT_NI,		// NI_PWR_S
+    PT_WIRELESS,	// TRANSCEIVER_RX_PWR_S
+    PT_WIRELESS		// TRANSCEIVER_TX_PWR_S
+};
+
+// Energy accounted so far by power, per category
+static void getCategoryEnergy(Power * power, double energy[PT_NO_CATEGORIES])
+{
+    for (int c = 0; c < PT_NO_CATEGORIES; c++)
+	energy[c] = 0.0;
+
+    PowerBreakdown * d = power->getDynamicPowerBreakDown();
+    for (int i = 0; i < d->size; i++)
+	energy[dynamic_category[i]] += d->breakdown[i].value;
+
+    PowerBreakdown * s = power->getStaticPowerBreakDown();
+    for (int i = 0; i < s->size; i++)
+	energy[static_category[i]] += s->breakdown[i].value;
+}
+
+const char * PowerTrace::getCategoryLabel(const int category)
+{
+    static const char * labels[PT_NO_CATEGORIES] = {
+	"buffer",
+	"logic",
+	"link",
+	"ni",
+	"wireless"
+    };
+
+    return labels[category];
+}
+
+void PowerTrace::addUnit(const string & name, Power * power, int categories)
+{
+    Unit u;
+
+    u.name = name;
+    u.power = power;
+    u.categories = categories;
+    for (int c = 0; c < PT_NO_CATEGORIES; c++)
+	u.energy[c] = 0.0;
+
+    units.push_back(u);
+    unit_power.push_back(0.0);
+}
+
+void PowerTrace::open(const string & filename, bool _breakdown)
+{
+    breakdown = _breakdown;
+    out.open(filename.c_str());
+
+    if (!out) {
+	cerr << "Error: cannot open power trace file " << filename << endl;
+	exit(1);
+    }
+
+    // header: one column per floorplan unit (or unit category)
+    for (unsigned int i = 0; i < units.size(); i++)
+    {
+	if (!breakdown)
+	    out << (i ? "\t" : "") << units[i].name;
+	else
+	    for (int c = 0; c < PT_NO_CATEGORIES; c++)
+		if (units[i].categories & (1 << c))
+		    out << (out.tellp() > 0 ? "\t" : "") << units[i].name << "_" << getCategoryLabel(c);
+    }
+    out << endl;
+}
+
+bool PowerTrace::cycle(int epoch)
+{
+    if (++epoch_cycles < epoch)
+	return false;
+
+    sample();
+    return true;
+}
+
+void PowerTrace::close()
+{
+    if (!out.is_open())
+	return;
+
+    if (epoch_cycles > 0)
+	sample();
+
+    out.close();
+}
+
+void PowerTrace::sample()
+{
+    double seconds = epoch_cycles * GlobalParams::clock_period_ps * 1.0e-12;
+    bool first = true;
+
+    for (unsigned int i = 0; i < units.size(); i++)
+    {
+	double energy[PT_NO_CATEGORIES];
+
+	getCategoryEnergy(units[i].power, energy);
+
+	unit_power[i] = 0.0;
+	for (int c = 0; c < PT_NO_CATEGORIES; c++)
+	{
+	    double pwr = (energy[c] - units[i].energy[c]) / seconds;
+
+	    units[i].energy[c] = energy[c];
+	    unit_power[i] += pwr;
+
+	    if (breakdown && out.is_open() && (units[i].categories & (1 << c)))
+	    {
+		out << (first ? "" : "\t") << pwr;
+		first = false;
+	    }
+	}
+
+	if (!breakdown && out.is_open())
+	{
+	    out << (first ? "" : "\t") << unit_power[i];
+	    first = false;
+	}
+    }
+    if (out.is_open())
+	out << endl;
+
+    epoch_cycles = 0;
+}
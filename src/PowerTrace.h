@@ -0,0 +1,81 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the per-epoch power trace, written
+ * in the ptrace format accepted by grid-based thermal simulators
+ */
+
+#ifndef __NOXIMPOWERTRACE_H__
+#define __NOXIMPOWERTRACE_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Power.h"
+
+using namespace std;
+
+// Categories the power breakdown entries are grouped into
+enum {
+    PT_BUFFER,
+    PT_LOGIC,		// routing, selection and crossbar
+    PT_LINK,
+    PT_NI,
+    PT_WIRELESS,	// transmitter, receiver and transceivers
+    PT_NO_CATEGORIES
+};
+
+class PowerTrace {
+
+  public:
+
+    PowerTrace() : breakdown(false), epoch_cycles(0) {}
+
+    // Adds a floorplan unit, whose power is the one accounted by power.
+    // categories is a bitmask (1 << PT_*) of the categories of the
+    // unit, which become separate columns when the breakdown is enabled
+    void addUnit(const string & name, Power * power, int categories);
+
+    // Opens the trace file and writes the header
+    void open(const string & filename, bool breakdown);
+
+    // Accounts one cycle; the power of the units is sampled (and a row
+    // written, if the trace file is open) every epoch cycles, in which
+    // case true is returned
+    bool cycle(int epoch);
+
+    // Writes the last (partial) epoch and closes the trace file
+    void close();
+
+    // Returns the number of units
+    unsigned int size() const { return units.size(); }
+
+    // Returns the average power [W] of each unit in the last epoch
+    const vector <double> & getUnitPower() const { return unit_power; }
+
+    static const char * getCategoryLabel(const int category);
+
+  private:
+
+    struct Unit {
+	string name;
+	Power * power;
+	int categories;
+	double energy[PT_NO_CATEGORIES];	// energy at the end of the last epoch [J]
+    };
+
+    vector <Unit> units;
+    vector <double> unit_power;
+    ofstream out;
+    bool breakdown;
+    int epoch_cycles;
+
+    void sample();
+};
+
+#endif
@@ -9,6 +9,11 @@
  */
 
 #include "ProcessingElement.h"
+#include "Profiler.h"
+
+#include <fstream>
+
+vector < Payload > ProcessingElement::payload_trace;
 
 int ProcessingElement::randInt(int min, int max)
 {
@@ -18,6 +23,8 @@ int ProcessingElement::randInt(int min, int max)
 
 void ProcessingElement::rxProcess()
 {
+    PROFILE(PROF_PE_RX_PROCESS);
+
     if (reset.read()) {
 	ack_rx.write(0);
 	current_level_rx = 0;
@@ -32,15 +39,27 @@ void ProcessingElement::rxProcess()
 
 void ProcessingElement::txProcess()
 {
+    PROFILE(PROF_PE_TX_PROCESS);
+
     if (reset.read()) {
 	req_tx.write(0);
 	current_level_tx = 0;
 	transmittedAtPreviousCycle = false;
+	// drops what the initialization run, before the reset, generated
+	packet_queue = queue < Packet >();
+	payload_seed = GlobalParams::rnd_generator_seed + local_id;
+	payload_trace_pos = local_id;
     } else {
 	Packet packet;
 
 	if (canShot(packet)) {
-	    packet_queue.push(packet);
+	    if (GlobalParams::multicast_probability > 0 &&
+		rand() < GlobalParams::multicast_probability * (RAND_MAX + 1.0))
+		queueMulticast(packet);
+	    else {
+		packet_queue.push(packet);
+		source_stats.generatedPacket(packet);
+	    }
 	    transmittedAtPreviousCycle = true;
 	} else
 	    transmittedAtPreviousCycle = false;
@@ -50,10 +69,13 @@ void ProcessingElement::txProcess()
 	    if (!packet_queue.empty()) {
 		Flit flit = nextFlit();	// Generate a new flit
 		flit_tx->write(flit);	// Send the generated flit
+		source_stats.injectedFlit();
 		current_level_tx = 1 - current_level_tx;	// Negate the old value for Alternating Bit Protocol (ABP)
 		req_tx.write(current_level_tx);
 	    }
 	}
+
+	source_stats.sampleBacklog();
     }
 }
 
@@ -64,14 +86,18 @@ Flit ProcessingElement::nextFlit()
 
     flit.src_id = packet.src_id;
     flit.dst_id = packet.dst_id;
+    flit.multicast = packet.multicast;
     flit.vc_id = packet.vc_id;
     flit.timestamp = packet.timestamp;
     flit.sequence_no = packet.size - packet.flit_left;
     flit.sequence_length = packet.size;
     flit.hop_no = 0;
-    //  flit.payload     = DEFAULT_PAYLOAD;
+    if (GlobalParams::payload_energy)
+	fillPayload(flit.payload);
 
     flit.hub_relay_node = NOT_VALID;
+    flit.bond_id = NOT_VALID;
+    flit.hop_time = packet.timestamp;
 
     if (packet.size == packet.flit_left)
 	flit.flit_type = FLIT_TYPE_HEAD;
@@ -87,6 +113,150 @@ Flit ProcessingElement::nextFlit()
     return flit;
 }
 
+// The destinations reached by the radio hub of the tile on a same channel
+// are sent a single multicast packet, which the hub transmits once and
+// the receiving hubs replicate to their tiles. The other destinations
+// are sent a unicast copy each
+void ProcessingElement::queueMulticast(Packet packet)
+{
+    int n_nodes = (GlobalParams::topology == TOPOLOGY_MESH) ?
+	GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y : GlobalParams::n_delta_tiles;
+
+    // multicast_size distinct random nodes, other than the source
+    vector<int> nodes;
+    for (int i = 0; i < n_nodes; i++)
+	if (i != local_id)
+	    nodes.push_back(i);
+    for (int i = 0; i < GlobalParams::multicast_size; i++)
+	swap(nodes[i], nodes[randInt(i, nodes.size() - 1)]);
+    nodes.resize(GlobalParams::multicast_size);
+    sort(nodes.begin(), nodes.end());
+
+    DestinationSet wireless = wirelessMulticast(nodes);
+    if (wireless.size() < 2)
+	wireless.clear();
+
+    source_stats.multicastPacket(nodes.size(), wireless.size());
+
+    if (!wireless.empty())
+    {
+	packet.multicast = wireless;
+	packet.dst_id = wireless.nodes()[0];
+	packet_queue.push(packet);
+	source_stats.generatedPacket(packet);
+	packet.multicast.clear();
+    }
+
+    for (unsigned int i = 0; i < nodes.size(); i++)
+	if (!wireless.contains(nodes[i]))
+	{
+	    packet.dst_id = nodes[i];
+	    packet_queue.push(packet);
+	    source_stats.generatedPacket(packet);
+	}
+}
+
+// The nodes of other hubs receiving on the channel of the hub of the
+// tile reaching most of them
+DestinationSet ProcessingElement::wirelessMulticast(const vector<int> & nodes)
+{
+    DestinationSet best;
+
+    if (!GlobalParams::use_winoc || !hasRadioHub(local_id))
+	return best;
+
+    int src_hub = tile2Hub(local_id);
+    const vector<int> & channels = GlobalParams::hub_configuration[src_hub].txChannels;
+
+    for (unsigned int c = 0; c < channels.size(); c++)
+    {
+	DestinationSet reached;
+
+	for (unsigned int i = 0; i < nodes.size(); i++)
+	{
+	    if (!hasRadioHub(nodes[i]) || tile2Hub(nodes[i]) == src_hub)
+		continue;
+
+	    const vector<int> & rx = GlobalParams::hub_configuration[tile2Hub(nodes[i])].rxChannels;
+	    if (find(rx.begin(), rx.end(), channels[c]) != rx.end())
+		reached.add(nodes[i]);
+	}
+
+	if (reached.size() > best.size())
+	    best = reached;
+    }
+
+    return best;
+}
+
+void ProcessingElement::fillPayload(Payload & payload)
+{
+    if (GlobalParams::payload_mode == PAYLOAD_TRACE)
+    {
+	if (payload_trace.empty())
+	    loadPayloadTrace();
+	payload = payload_trace[payload_trace_pos++ % payload_trace.size()];
+	return;
+    }
+
+    double p = (GlobalParams::payload_mode == PAYLOAD_RANDOM) ?
+	GlobalParams::payload_bit_probability : GlobalParams::payload_toggle_probability;
+
+    payload = last_payload;
+    for (int b = 0; b < GlobalParams::flit_size; b++)
+    {
+	uint64_t mask = (uint64_t) 1 << (b % 64);
+	bool hit = rand_r(&payload_seed) < p * (RAND_MAX + 1.0);
+
+	if (GlobalParams::payload_mode == PAYLOAD_RANDOM)
+	    payload.data[b / 64] = hit ? (payload.data[b / 64] | mask) : (payload.data[b / 64] & ~mask);
+	else if (hit)
+	    payload.data[b / 64] ^= mask;
+    }
+    last_payload = payload;
+}
+
+// One flit per line, as a hexadecimal word of up to flit_size bits
+void ProcessingElement::loadPayloadTrace()
+{
+    ifstream fin(GlobalParams::payload_trace_filename.c_str());
+    string line;
+
+    if (!fin)
+    {
+	cerr << "Error: cannot open payload trace " << GlobalParams::payload_trace_filename << endl;
+	exit(1);
+    }
+
+    while (getline(fin, line))
+    {
+	Payload payload;
+
+	if (line.compare(0, 2, "0x") == 0 || line.compare(0, 2, "0X") == 0)
+	    line = line.substr(2);
+	if (line.empty() || line[0] == '%' || line[0] == '#')
+	    continue;
+
+	// 16 hex digits per word, starting from the least significant ones
+	for (int w = 0, end = line.size(); w < PAYLOAD_WORDS && end > 0; w++, end -= 16)
+	{
+	    int begin = max(0, end - 16);
+	    payload.data[w] = strtoull(line.substr(begin, end - begin).c_str(), NULL, 16);
+	}
+
+	for (int b = GlobalParams::flit_size; b < MAX_FLIT_SIZE; b++)
+	    payload.data[b / 64] &= ~((uint64_t) 1 << (b % 64));
+
+	payload_trace.push_back(payload);
+    }
+
+    if (payload_trace.empty())
+    {
+	cerr << "Error: empty payload trace " << GlobalParams::payload_trace_filename << endl;
+	exit(1);
+    }
+}
+
 bool ProcessingElement::canShot(Packet & packet)
 {
    // assert(false);
@@ -16,6 +16,7 @@
 
 #include "DataStructs.h"
 #include "GlobalTrafficTable.h"
+#include "Stats.h"
 #include "Utils.h"
 
 using namespace std;
@@ -45,12 +46,23 @@ SC_MODULE(ProcessingElement)
     bool current_level_tx;	// Current level for Alternating Bit Protocol (ABP)
     queue < Packet > packet_queue;	// Local queue of packets
     bool transmittedAtPreviousCycle;	// Used for distributions with memory
+    SourceStats source_stats;	// Offered load and source backlog
+
+    // Payload generation (payload_energy)
+    Payload last_payload;	// Payload of the last flit generated
+    unsigned int payload_seed;	// Own random stream, so that the traffic does not change
+    unsigned int payload_trace_pos;	// Next flit of the payload trace
+    static vector < Payload > payload_trace;
 
     // Functions
     void rxProcess();		// The receiving process
     void txProcess();		// The transmitting process
     bool canShot(Packet & packet);	// True when the packet must be shot
+    void queueMulticast(Packet packet);	// Queues a packet to multicast_size random nodes
+    DestinationSet wirelessMulticast(const vector<int> & nodes);	// Nodes reached by one radio transmission
     Flit nextFlit();	// Take the next flit of the current packet
+    void fillPayload(Payload & payload);	// Data of the next flit
+    static void loadPayloadTrace();
     Packet trafficTest();	// used for testing traffic
     Packet trafficRandom();	// Random destination distribution
     Packet trafficTranspose1();	// Transpose 1 destination distribution
@@ -85,6 +97,9 @@ SC_MODULE(ProcessingElement)
 	SC_METHOD(txProcess);
 	sensitive << reset;
 	sensitive << clock.pos();
+
+	// the processes also run at the initialization, before the reset
+	current_level_rx = current_level_tx = 0;
     }
 
 };
@@ -0,0 +1,111 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the host-side profiler
+ */
+
+#include "Profiler.h"
+
+#include <systemc.h>
+#include <sys/resource.h>
+
+unsigned long Profiler::activations[PROF_NO_ENTRIES];
+double Profiler::elapsed[PROF_NO_ENTRIES];
+double Profiler::start_time;
+double Profiler::last_sample_time;
+double Profiler::last_sample_cycle;
+vector < pair <double, double> > Profiler::speed_samples;
+
+static const char * profiler_labels[PROF_NO_ENTRIES] = {
+    "Router::process",
+    "Router::perCycleUpdate",
+    "ProcessingElement::txProcess",
+    "ProcessingElement::rxProcess",
+    "Hub::tileToAntennaProcess",
+    "Hub::antennaToTileProcess",
+    "TokenRing::updateTokens",
+    "Initiator::transmitProcess",
+    "Stats::receivedFlit"
+};
+
+void Profiler::start()
+{
+    start_time = now();
+    last_sample_time = start_time;
+    last_sample_cycle = 0;
+}
+
+void Profiler::sample(double cycle)
+{
+    double t = now();
+
+    if (t > last_sample_time)
+	speed_samples.push_back(make_pair(cycle, (cycle - last_sample_cycle) / (t - last_sample_time)));
+
+    last_sample_time = t;
+    last_sample_cycle = cycle;
+}
+
+double Profiler::getWallTime()
+{
+    return now() - start_time;
+}
+
+double Profiler::getSimulationSpeed()
+{
+    double cycles = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+    double wall_time = getWallTime();
+
+    return wall_time > 0 ? cycles / wall_time : 0;
+}
+
+long Profiler::getPeakRSS()
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+	return 0;
+
+    // ru_maxrss is in kilobytes on Linux
+    return usage.ru_maxrss;
+}
+
+void Profiler::showStats(std::ostream & out)
+{
+    double wall_time = getWallTime();
+
+    out << "% Simulation wall time (s): " << wall_time << endl;
+    out << "% Simulation speed (cycles/s): " << getSimulationSpeed() << endl;
+    out << "% Peak resident set size (KB): " << getPeakRSS() << endl;
+
+    if (!GlobalParams::profiling)
+	return;
+
+    std::streamsize p = out.precision();
+    out.precision(4);
+
+    // Stats::receivedFlit is called from Router::process, so its time
+    // is also included in that entry
+    out << "profile = [" << endl;
+    out << "%\tactivations\ttime(s)\ttime/activation(us)\twall time fraction" << endl;
+    for (int i = 0; i < PROF_NO_ENTRIES; i++)
+    {
+	out << "\t" << activations[i] << "\t" << elapsed[i] << "\t"
+	    << (activations[i] ? elapsed[i] / activations[i] * 1e6 : 0) << "\t"
+	    << (wall_time > 0 ? elapsed[i] / wall_time : 0)
+	    << "\t % " << profiler_labels[i] << endl;
+    }
+    out << "];" << endl;
+
+    out << "profile_speed = [" << endl;
+    out << "%\tcycle\tcycles/s" << endl;
+    for (unsigned int i = 0; i < speed_samples.size(); i++)
+	out << "\t" << (long)speed_samples[i].first << "\t" << speed_samples[i].second << endl;
+    out << "];" << endl;
+
+    out.precision(p);
+}
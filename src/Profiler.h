@@ -0,0 +1,116 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the host-side profiler, which
+ * measures how much wall time each kind of simulation process takes
+ */
+
+#ifndef __NOXIMPROFILER_H__
+#define __NOXIMPROFILER_H__
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <time.h>
+
+#include "GlobalParams.h"
+
+using namespace std;
+
+// Profiled process types
+enum {
+    PROF_ROUTER_PROCESS,
+    PROF_ROUTER_PER_CYCLE_UPDATE,
+    PROF_PE_TX_PROCESS,
+    PROF_PE_RX_PROCESS,
+    PROF_HUB_TILE_TO_ANTENNA,
+    PROF_HUB_ANTENNA_TO_TILE,
+    PROF_TOKEN_RING_UPDATE,
+    PROF_INITIATOR_TRANSMIT,
+    PROF_STATS_RECEIVED_FLIT,
+    PROF_NO_ENTRIES
+};
+
+class Profiler {
+
+  public:
+
+    // Marks the beginning of the simulation (wall time origin)
+    static void start();
+
+    // Records a (cycle, cycles per second) sample of the simulation speed
+    // measured since the previous sample
+    static void sample(double cycle);
+
+    // Wall time elapsed since start() [s]
+    static double getWallTime();
+
+    // Simulated cycles per wall second since start()
+    static double getSimulationSpeed();
+
+    // Peak resident set size of the process [KB]
+    static long getPeakRSS();
+
+    // Shows the profiling results (per process breakdown only when
+    // profiling is enabled)
+    static void showStats(std::ostream & out);
+
+    static inline double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    static unsigned long activations[PROF_NO_ENTRIES];
+    static double elapsed[PROF_NO_ENTRIES];
+
+  private:
+
+    static double start_time;
+    static double last_sample_time;
+    static double last_sample_cycle;
+    static vector < pair <double, double> > speed_samples;
+};
+
+// Accounts one activation and the wall time spent in the enclosing
+// scope to a profiled process type
+class ProfileScope {
+
+  public:
+
+    ProfileScope(int _entry) : entry(_entry), t0(0) {
+	if (GlobalParams::profiling) {
+	    Profiler::activations[entry]++;
+	    t0 = Profiler::now();
+	}
+    }
+
+    ~ProfileScope() {
+	suspend();
+    }
+
+    // Excludes a part of the scope (e.g. a blocking call that lets
+    // other processes run) from the accounted time
+    void suspend() {
+	if (GlobalParams::profiling)
+	    Profiler::elapsed[entry] += Profiler::now() - t0;
+    }
+
+    void resume() {
+	if (GlobalParams::profiling)
+	    t0 = Profiler::now();
+    }
+
+  private:
+
+    int entry;
+    double t0;
+};
+
+#define PROFILE(entry) ProfileScope profile_scope(entry)
+
+#endif
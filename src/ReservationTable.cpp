@@ -32,6 +32,15 @@ bool ReservationTable::isNotReserved(const int port_out)
     return (rtable[port_out].reservations.size()==0);
 }
 
+bool ReservationTable::isNotReserved(const int port_out, const int vc)
+{
+    assert(port_out<n_outputs);
+    for (unsigned int i=0;i<rtable[port_out].reservations.size();i++)
+	if (rtable[port_out].reservations[i].vc == vc)
+	    return false;
+    return true;
+}
+
 /* For a given input, returns the set of output/vc reserved from that input.
  * An index is required for each output entry, to avoid that multiple invokations
  * with different inputs returns the same output in the same clock cycle. */
@@ -100,13 +109,14 @@ void ReservationTable::print()
 }
 
 
-void ReservationTable::reserve(const TReservation r, const int port_out)
+void ReservationTable::reserve(const TReservation r, const int port_out, const bool multicast)
 {
     // IMPORTANT: problem when used by Hub with more connections
     //
     // reservation of reserved/not valid ports is illegal. Correctness
     // should be assured by ReservationTable users
-    assert(checkReservation(r, port_out)==RT_AVAILABLE);
+    int rt_status = checkReservation(r, port_out);
+    assert(rt_status==RT_AVAILABLE || (multicast && rt_status==RT_ALREADY_OTHER_OUT));
 
     // TODO: a better policy could insert in a specific position as far a possible
     // from the current index
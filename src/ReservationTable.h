@@ -44,8 +44,9 @@ class ReservationTable {
     // check if the input/vc/output is a
     int checkReservation(const TReservation r, const int port_out);
 
-    // Connects port_in with port_out. Asserts if port_out is reserved
-    void reserve(const TReservation r, const int port_out);
+    // Connects port_in with port_out. Asserts if port_out is reserved,
+    // unless by another branch of the same multicast packet
+    void reserve(const TReservation r, const int port_out, const bool multicast = false);
 
     // Releases port_out connection. 
     // Asserts if port_out is not reserved or not valid
@@ -60,6 +61,9 @@ class ReservationTable {
     // check whether port_out has no reservations
     bool isNotReserved(const int port_out);
 
+    // check whether the vc of port_out has no reservations
+    bool isNotReserved(const int port_out, const int vc);
+
     void setSize(const int n_outputs);
 
     void print();
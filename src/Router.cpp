@@ -9,6 +9,7 @@
  */
 
 #include "Router.h"
+#include "Profiler.h"
 
 
 inline int toggleKthBit(int n, int k)
@@ -18,6 +19,13 @@ inline int toggleKthBit(int n, int k)
 
 void Router::process()
 {
+    PROFILE(PROF_ROUTER_PROCESS);
+
+    // a scaled router skips the cycles of the global clock its own
+    // clock does not tick in
+    if (GlobalParams::dvfs_mode && !reset.read() && !dvfsTick())
+	return;
+
     txProcess();
     rxProcess();
 }
@@ -27,7 +35,7 @@ void Router::rxProcess()
     if (reset.read()) {
 	TBufferFullStatus bfs;
 	// Clear outputs and indexes of receiving protocol
-	for (int i = 0; i < DIRECTIONS + 2; i++) {
+	for (int i = 0; i < n_ports; i++) {
 	    ack_rx[i].write(0);
 	    current_level_rx[i] = 0;
 	    buffer_full_status_rx[i].write(bfs);
@@ -40,13 +48,15 @@ void Router::rxProcess()
 	// This process simply sees a flow of incoming flits. All arbitration
 	// and wormhole related issues are addressed in the txProcess()
 	//assert(false);
-	for (int i = 0; i < DIRECTIONS + 2; i++) {
+	for (int i = 0; i < n_ports; i++) {
 	    // To accept a new flit, the following conditions must match:
 	    // 1) there is an incoming request
 	    // 2) there is a free slot in the input buffer of direction i
 	    //LOG<<"****RX****DIRECTION ="<<i<<  endl;
 
-	    if (req_rx[i].read() == 1 - current_level_rx[i])
+	    // 3) the input port is not power gated
+	    // 4) the request crossed the synchronizer of a frequency boundary
+	    if (req_rx[i].read() == 1 - current_level_rx[i] && !isGated(i) && isSynchronized(i))
 	    { 
 		Flit received_flit = flit_rx[i].read();
 		//LOG<<"request opposite to the current_level, reading flit "<<received_flit<<endl;
@@ -55,12 +65,33 @@ void Router::rxProcess()
 
 		if (!buffer[i][vc].IsFull()) 
 		{
+		    if (GlobalParams::latency_breakdown && received_flit.flit_type == FLIT_TYPE_HEAD)
+		    {
+			double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+			if (i == DIRECTION_LOCAL)
+			    latency_stats.account(received_flit, LAT_SOURCE_QUEUEING, now - received_flit.timestamp);
+			else
+			    latency_stats.account(received_flit, LAT_LINK, now - received_flit.hop_time);
+			received_flit.hop_time = now;
+		    }
 
 		    // Store the incoming flit in the circular buffer
 		    buffer[i][vc].Push(received_flit);
 		    LOG << " Flit " << received_flit << " collected from Input[" << i << "][" << vc <<"]" << endl;
 
-		    power.bufferRouterPush();
+		    // a gated router forwards transit flits through its buffers
+		    // and crossbar, powered while they cross it
+		    if (isBypassing(i))
+			pg_stats.bypassed_flits++;
+
+		    if (GlobalParams::payload_energy)
+		    {
+			power.bufferRouterPush(received_flit.payload.toggles(last_rx_payload[i]));
+			last_rx_payload[i] = received_flit.payload;
+		    }
+		    else
+			power.bufferRouterPush();
 
 		    // Negate the old value for Alternating Bit Protocol (ABP)
 		    //LOG<<"INVERTING CL FROM "<< current_level_rx[i]<< " TO "<<  1 - current_level_rx[i]<<endl;
@@ -96,18 +127,20 @@ void Router::txProcess()
   if (reset.read()) 
     {
       // Clear outputs and indexes of transmitting protocol
-      for (int i = 0; i < DIRECTIONS + 2; i++) 
+      for (int i = 0; i < n_ports; i++) 
 	{
 	  req_tx[i].write(0);
 	  current_level_tx[i] = 0;
+	  for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+	    route_time[i][vc] = grant_time[i][vc] = NOT_VALID;
 	}
     } 
   else 
     { 
       // 1st phase: Reservation
-      for (int j = 0; j < DIRECTIONS + 2; j++) 
+      for (int j = 0; j < n_ports; j++) 
 	{
-	  int i = (start_from_port + j) % (DIRECTIONS + 2);
+	  int i = (start_from_port + j) % n_ports;
 
 	  for (int k = 0;k < GlobalParams::n_virtual_channels; k++)
 	  {
@@ -132,9 +165,12 @@ void Router::txProcess()
 		      route_data.dst_id = flit.dst_id;
 		      route_data.dir_in = i;
 		      route_data.vc_id = flit.vc_id;
+		      route_data.sequence_length = flit.sequence_length;
+		      route_data.multicast = !flit.multicast.empty();
 
 		      // TODO: see PER POSTERI (adaptive routing should not recompute route if already reserved)
 		      int o = route(route_data);
+		      int target = flit.dst_id;
 
 		      // manage special case of target hub not directly connected to destination
 		      if (o>=DIRECTION_HUB_RELAY)
@@ -142,9 +178,15 @@ void Router::txProcess()
 		      	Flit f = buffer[i][vc].Pop();
 		      	f.hub_relay_node = o-DIRECTION_HUB_RELAY;
 		      	buffer[i][vc].Push(f);
+		      	target = f.hub_relay_node;
 		      	o = DIRECTION_HUB;
 			  }
 
+		      // a node attached to several hubs picks the r2h link of
+		      // one of them
+		      if (o == DIRECTION_HUB && !route_data.multicast && n_hub_links > 1)
+			  o = DIRECTION_HUB + WirelessPaths::selectLink(local_id, target, flit.sequence_length);
+
 		      TReservation r;
 		      r.input = i;
 		      r.vc = vc;
@@ -153,10 +195,22 @@ void Router::txProcess()
 
 		      int rt_status = reservation_table.checkReservation(r,o);
 
+		      if (GlobalParams::show_allocator_stats)
+			  allocator_stats.reservation(i, rt_status);
+
+		      if (GlobalParams::latency_breakdown && route_time[i][vc] == NOT_VALID)
+			  route_time[i][vc] = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
 		      if (rt_status == RT_AVAILABLE) 
 		      {
 			  LOG << " reserving direction " << o << " for flit " << flit << endl;
 			  reservation_table.reserve(r, o);
+			  if (wireless_candidate)
+			      WirelessPaths::account(local_id, o >= DIRECTION_HUB);
+			  if (o >= DIRECTION_HUB && n_hub_links > 1)
+			      WirelessPaths::accountLink(local_id, o - DIRECTION_HUB);
+			  if (GlobalParams::latency_breakdown)
+			      grant_time[i][vc] = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
 		      }
 		      else if (rt_status == RT_ALREADY_SAME)
 		      {
@@ -177,12 +231,13 @@ void Router::txProcess()
 	    start_from_vc[i] = (start_from_vc[i]+1)%GlobalParams::n_virtual_channels;
 	}
 
-      start_from_port = (start_from_port + 1) % (DIRECTIONS + 2);
+      start_from_port = (start_from_port + 1) % n_ports;
 
       // 2nd phase: Forwarding
       //if (local_id==6) LOG<<"*TX*****local_id="<<local_id<<"__ack_tx[0]= "<<ack_tx[0].read()<<endl;
-      for (int i = 0; i < DIRECTIONS + 2; i++) 
+      for (int i = 0; i < n_ports; i++) 
       { 
+	  int forwarded_vc = NOT_VALID;
 	  vector<pair<int,int> > reservations = reservation_table.getReservations(i);
 	  
 	  if (reservations.size()!=0)
@@ -207,10 +262,24 @@ void Router::txProcess()
 		      //if (GlobalParams::verbose_mode > VERBOSE_OFF) 
 		      LOG << "Input[" << i << "][" << vc << "] forwarded to Output[" << o << "], flit: " << flit << endl;
 
+		      if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+		      {
+			  double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+			  latency_stats.account(flit, LAT_ROUTING, route_time[i][vc] - flit.hop_time);
+			  latency_stats.account(flit, LAT_VC_ALLOCATION, grant_time[i][vc] - route_time[i][vc]);
+			  latency_stats.account(flit, LAT_SWITCH_ALLOCATION, now - grant_time[i][vc]);
+			  if (o == DIRECTION_LOCAL)
+			      latency_stats.delivered(flit);
+			  flit.hop_time = now;
+			  route_time[i][vc] = grant_time[i][vc] = NOT_VALID;
+		      }
+
 		      flit_tx[o].write(flit);
 		      current_level_tx[o] = 1 - current_level_tx[o];
 		      req_tx[o].write(current_level_tx[o]);
 		      buffer[i][vc].Pop();
+		      forwarded_vc = vc;
 
 		      if (flit.flit_type == FLIT_TYPE_TAIL)
 		      {
@@ -221,13 +290,25 @@ void Router::txProcess()
 		      }
 
 		      /* Power & Stats ------------------------------------------------- */
-		      if (o == DIRECTION_HUB) power.r2hLink();
+		      if (GlobalParams::payload_energy)
+		      {
+			  int toggles = flit.payload.toggles(last_tx_payload[o]);
+
+			  if (o >= DIRECTION_HUB) power.r2hLink(toggles);
+			  else
+			      power.r2rLink(toggles);
+			  last_tx_payload[o] = flit.payload;
+		      }
+		      else if (o >= DIRECTION_HUB) power.r2hLink();
 		      else
 			  power.r2rLink();
 
 		      power.bufferRouterPop();
 		      power.crossBar();
 
+		      if (GlobalParams::dvfs_mode)
+			  dvfs_forwarded++;
+
 		      if (o == DIRECTION_LOCAL) 
 		      {
 			  power.networkInterface();
@@ -252,6 +333,9 @@ void Router::txProcess()
 		  else
 		  {
 		      LOG << " Cannot forward Input[" << i << "][" << vc << "] to Output[" << o << "], flit: " << flit << endl;
+
+		      if (GlobalParams::show_allocator_stats)
+			  allocator_stats.stall(i, current_level_tx[o] != ack_tx[o].read());
 		      //LOG << " **DEBUG APB: current_level_tx: " << current_level_tx[o] << " ack_tx: " << ack_tx[o].read() << endl;
 		      LOG << " **DEBUG buffer_full_status_tx " << buffer_full_status_tx[o].read().mask[vc] << endl;
 
@@ -264,6 +348,10 @@ void Router::txProcess()
 	      }
 	  } // if not reserved 
 	 // else LOG<<"we have no reservation for direction "<<i<< endl;
+
+	  if (GlobalParams::show_allocator_stats)
+	      for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		  allocator_stats.sampleWait(i, vc, vc != forwarded_vc && !buffer[i][vc].IsEmpty());
       } // for loop directions
 
       if ((int)(sc_time_stamp().to_double() / GlobalParams::clock_period_ps)%2==0)
@@ -294,24 +382,257 @@ NoP_data Router::getCurrentNoPData()
 
 void Router::perCycleUpdate()
 {
+    PROFILE(PROF_ROUTER_PER_CYCLE_UPDATE);
+
     if (reset.read()) {
 	for (int i = 0; i < DIRECTIONS + 1; i++)
+	{
 	    free_slots[i].write(buffer[i][DEFAULT_VC].GetMaxBufferSize());
+	    pg_state[i] = PG_ON;
+	    pg_idle[i] = 0;
+	}
+	pg_router_state = PG_ON;
+	dvfs_phase = 0.0;
+	for (int i = 0; i < n_ports; i++)
+	    dvfs_sync[i] = 0;
     } else {
         selectionStrategy->perCycleUpdate(this);
 
-	power.leakageRouter();
-	for (int i = 0; i < DIRECTIONS + 1; i++)
+	// the wired latency estimate needs the occupancy whatever the
+	// selection strategy
+	if (GlobalParams::use_winoc && GlobalParams::winoc_path_selection == WINOC_PATH_ADAPTIVE)
+	    for (int i = 0; i < DIRECTIONS + 1; i++)
+		free_slots[i].write(advertisedFreeSlots(i));
+
+	if (GlobalParams::power_gating == PG_NONE)
 	{
-	    for (int vc=0;vc<GlobalParams::n_virtual_channels;vc++)
+	    power.leakageRouter();
+	    power.leakageBufferRouter((DIRECTIONS + 1) * GlobalParams::n_virtual_channels);
+	}
+	else
+	    powerGatingUpdate();
+	power.leakageLinkRouter2Router((DIRECTIONS + 1) * GlobalParams::n_virtual_channels);
+
+	// one r2h link for each hub of the tile, at least the one wired
+	// to the hub port
+	for (int k = 0; k < max(n_hub_links, 1); k++)
+	    power.leakageLinkRouter2Hub();
+    }
+}
+
+bool Router::dvfsTick()
+{
+    dvfs_epoch_cycles++;
+    dvfs_phase += dvfs_ratio;
+    if (dvfs_phase < 1.0)
+	return false;
+    dvfs_phase -= 1.0;
+
+    dvfs_ticks++;
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+	    dvfs_occupancy += (buffer[i][vc].GetMaxBufferSize() - buffer[i][vc].getCurrentFreeSlots()) /
+		(double) (buffer[i][vc].GetMaxBufferSize() * (DIRECTIONS + 1) * GlobalParams::n_virtual_channels);
+
+    return true;
+}
+
+void Router::setDVFSLevel(const int level)
+{
+    pair <double, double> & l = GlobalParams::power_configuration.dvfs_levels[level];
+
+    dvfs_level = level;
+    dvfs_ratio = l.first;
+    power.setVoltageScale(l.second / GlobalParams::power_configuration.dvfs_levels[0].second);
+
+    dvfs_ticks = dvfs_epoch_cycles = dvfs_forwarded = 0;
+    dvfs_occupancy = 0.0;
+}
+
+bool Router::isSynchronized(const int port)
+{
+    // the synchronizer FIFO is pipelined: only the head flit of a packet
+    // pays its latency
+    if (!GlobalParams::dvfs_mode || flit_rx[port].read().flit_type != FLIT_TYPE_HEAD)
+	return true;
+
+    // PEs and hubs run at the nominal level
+    int neighbor_level = 0;
+
+    if (port < DIRECTIONS)
+    {
+	int neighbor = getNeighborId(local_id, port);
+
+	if (neighbor != NOT_VALID)
+	    neighbor_level = DVFSController::getLevel(neighbor);
+    }
+
+    if (neighbor_level == dvfs_level || ++dvfs_sync[port] > GlobalParams::dvfs_sync_latency)
+    {
+	dvfs_sync[port] = 0;
+	return true;
+    }
+
+    return false;
+}
+
+int Router::advertisedFreeSlots(const int port)
+{
+    if (!GlobalParams::use_winoc || GlobalParams::winoc_path_selection != WINOC_PATH_ADAPTIVE)
+	return buffer[port][DEFAULT_VC].getCurrentFreeSlots();
+
+    int free = 0;
+    for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+	free += buffer[port][vc].getCurrentFreeSlots();
+
+    return free;
+}
+
+bool Router::isBypassing(const int port) const
+{
+    // flits crossing a gated router do not wake it up, only the local
+    // injection does
+    return GlobalParams::pg_bypass && pg_router_state == PG_GATED && port != DIRECTION_LOCAL;
+}
+
+bool Router::isGated(const int port) const
+{
+    if (GlobalParams::power_gating == PG_NONE || isBypassing(port))
+	return false;
+
+    if (pg_router_state != PG_ON)
+	return true;
+
+    // the hub ports are gated along with the router logic only
+    return port < DIRECTION_HUB && pg_state[port] != PG_ON;
+}
+
+double Router::getBlockLeakage(const int block)
+{
+    if (block == PG_BLOCK_PORT)
+	return power.getStaticEnergy(BUFFER_ROUTER_PWR_S) * GlobalParams::n_virtual_channels;
+
+    return power.getStaticEnergy(ROUTING_PWR_S) + power.getStaticEnergy(SELECTION_PWR_S) +
+	power.getStaticEnergy(CROSSBAR_PWR_S) + power.getStaticEnergy(NI_PWR_S);
+}
+
+double Router::getBreakEven(const int block)
+{
+    double leakage = getBlockLeakage(block);
+
+    return leakage > 0 ? GlobalParams::pg_wakeup_energy / leakage : 0.0;
+}
+
+// Gates the input ports (and, at PG_ROUTER level, the router logic) idle
+// for pg_idle_threshold cycles and wakes them up when a flit requests
+// them, which then waits pg_wakeup_latency cycles. Only the blocks not
+// gated, or bypassed by transit flits, account their leakage
+void Router::powerGatingUpdate()
+{
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+    bool all_gated = true;
+    bool bypass_busy = false;
+    int powered_ports = 0;
+
+    for (int i = 0; i < DIRECTIONS + 1; i++)
+    {
+	bool pending = req_rx[i].read() == 1 - current_level_rx[i];
+	bool empty = true;
+
+	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+	    empty = empty && buffer[i][vc].IsEmpty();
+
+	// a port bypassed by transit flits is powered while they use it
+	bool bypassed = isBypassing(i) && (pending || !empty);
+	bypass_busy = bypass_busy || bypassed;
+
+	if (pg_state[i] == PG_ON)
+	{
+	    if (pending || !empty)
+		pg_idle[i] = 0;
+	    else if (++pg_idle[i] >= GlobalParams::pg_idle_threshold)
+	    {
+		pg_state[i] = PG_GATED;
+		pg_sleep_start[i] = now;
+		pg_stats.gatings[PG_BLOCK_PORT]++;
+	    }
+	}
+	else if (pg_state[i] == PG_GATED)
+	{
+	    if (pending && !isBypassing(i))
 	    {
-		power.leakageBufferRouter();
-		power.leakageLinkRouter2Router();
+		pg_stats.wakeup(PG_BLOCK_PORT, now - pg_sleep_start[i], getBreakEven(PG_BLOCK_PORT));
+		power.powerGatingWakeup();
+		pg_wakeup[i] = GlobalParams::pg_wakeup_latency;
+		pg_state[i] = pg_wakeup[i] > 0 ? PG_WAKING : PG_ON;
+		pg_idle[i] = 0;
 	    }
+	    else if (!bypassed)
+		pg_stats.gated_cycles[PG_BLOCK_PORT]++;
+	}
+	else // PG_WAKING
+	{
+	    if (pending)
+		pg_stats.wakeup_stall_cycles++;
+	    if (--pg_wakeup[i] == 0)
+		pg_state[i] = PG_ON;
+	}
+
+	if (pg_state[i] != PG_GATED || bypassed)
+	    powered_ports++;
+	all_gated = all_gated && pg_state[i] == PG_GATED;
+
+	// neighbors see a gated input port as a full one, and its free
+	// slots again once it is powered (RANDOM and XY selections do not
+	// refresh them)
+	if (pg_state[i] != PG_ON && !isBypassing(i))
+	    free_slots[i].write(0);
+	else if (free_slots[i].read() == 0)
+	    free_slots[i].write(advertisedFreeSlots(i));
+    }
+
+    if (GlobalParams::power_gating == PG_ROUTER)
+    {
+	bool hub_idle = true;
+
+	for (int i = DIRECTION_HUB; i < n_ports; i++)
+	{
+	    hub_idle = hub_idle && req_rx[i].read() == current_level_rx[i];
+	    for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
+		hub_idle = hub_idle && buffer[i][vc].IsEmpty();
 	}
+	bypass_busy = bypass_busy || (!hub_idle && isBypassing(DIRECTION_HUB));
 
-	power.leakageLinkRouter2Hub();
+	if (pg_router_state == PG_ON)
+	{
+	    if (all_gated && hub_idle)
+	    {
+		pg_router_state = PG_GATED;
+		pg_router_sleep_start = now;
+		pg_stats.gatings[PG_BLOCK_ROUTER]++;
+	    }
+	}
+	else if (pg_router_state == PG_GATED)
+	{
+	    if (!all_gated || (!hub_idle && !GlobalParams::pg_bypass))
+	    {
+		pg_stats.wakeup(PG_BLOCK_ROUTER, now - pg_router_sleep_start, getBreakEven(PG_BLOCK_ROUTER));
+		power.powerGatingWakeup();
+		pg_router_wakeup = GlobalParams::pg_wakeup_latency;
+		pg_router_state = pg_router_wakeup > 0 ? PG_WAKING : PG_ON;
+	    }
+	    else if (!bypass_busy)
+		pg_stats.gated_cycles[PG_BLOCK_ROUTER]++;
+	}
+	else if (--pg_router_wakeup == 0)
+	    pg_router_state = PG_ON;
     }
+
+    // the routing, selection and crossbar of a bypassed router switch
+    // its transit flits
+    if (pg_router_state != PG_GATED || bypass_busy)
+	power.leakageRouter();
+    power.leakageBufferRouter(powered_ports * GlobalParams::n_virtual_channels);
 }
 
 vector<int> Router::nextDeltaHops(RouteData rd) {
@@ -391,6 +712,8 @@ vector<int> Router::nextDeltaHops(RouteData rd) {
 
 vector < int > Router::routingFunction(const RouteData & route_data)
 {
+	wireless_candidate = false;
+
 	if (GlobalParams::use_winoc)
 	{
 		// - If the current node C and the destination D are connected to an radiohub, use wireless
@@ -402,59 +725,74 @@ vector < int > Router::routingFunction(const RouteData & route_data)
 		// node I and the destination D.
 		// - NOTE: default threshold is 0, which means I=D, i.e., we explicitly ask the destination D to be connected to the
 		// target radio hub
-		if (hasRadioHub(local_id))
+		// - The decisions are precomputed by WirelessPaths at configure time
+		// - With ADAPTIVE path selection the wireless direction is only
+		// taken if it is expected to be faster than the wired one
+		int direction = WirelessPaths::route(local_id, route_data.src_id, route_data.dst_id);
+
+		if (direction != NOT_VALID)
+			wireless_candidate = true;
+
+		if (direction != NOT_VALID && GlobalParams::winoc_path_selection == WINOC_PATH_ADAPTIVE)
 		{
-			// Check if destination is directly connected to an hub
-			if ( hasRadioHub(route_data.dst_id) &&
-				 !sameRadioHub(local_id,route_data.dst_id) )
+			vector<int> wired = routingAlgorithm->route(this, route_data);
+			double wired_latency = wiredLatency(route_data, wired);
+			double wireless_latency = WirelessPaths::wirelessLatency(local_id, direction, route_data.dst_id, route_data.sequence_length);
+
+			if (wired_latency <= wireless_latency)
 			{
-                map<int, int>::iterator it1 = GlobalParams::hub_for_tile.find(route_data.dst_id);
-                map<int, int>::iterator it2 = GlobalParams::hub_for_tile.find(route_data.current_id);
-
-                if (connectedHubs(it1->second,it2->second))
-                {
-                    LOG << "Destination node " << route_data.dst_id << " is directly connected to a reachable RadioHub" << endl;
-                    vector<int> dirv;
-                    dirv.push_back(DIRECTION_HUB);
-                    return dirv;
-                }
+				LOG << "Wired routing for dst = " << route_data.dst_id << " (expected " << wired_latency <<
+					" cycles, " << wireless_latency << " wireless)" << endl;
+				return wired;
 			}
-			// let's check whether some node in the route has an acceptable distance to the dst
-            if (GlobalParams::winoc_dst_hops>0)
-            {
-                // TODO: for the moment, just print the set of nexts hops to check everything is ok
-                LOG << "NEXT_DELTA_HOPS (from node " << route_data.src_id << " to " << route_data.dst_id << ") >>>> :";
-                vector<int> nexthops;
-                nexthops = nextDeltaHops(route_data);
-                //for (int i=0;i<nexthops.size();i++) cout << "(" << nexthops[i] <<")-->";
-                //cout << endl;
-                for (int i=1;i<=GlobalParams::winoc_dst_hops;i++)
-				{
-                	int dest_position = nexthops.size()-1;
-                	int candidate_hop = nexthops[dest_position-i];
-					if ( hasRadioHub(candidate_hop) && !sameRadioHub(local_id,candidate_hop) ) {
-						//LOG << "Checking candidate hop " << candidate_hop << " ... It's OK!" << endl;
-						LOG << "Relaying to hub-connected node " << candidate_hop << " to reach destination " << route_data.dst_id << endl;
-						vector<int> dirv;
-						dirv.push_back(DIRECTION_HUB_RELAY+candidate_hop);
-						return dirv;
-					}
-					//else
-					// LOG << "Checking candidate hop " << candidate_hop << " ... NOT OK" << endl;
-				}
-            }
+		}
+
+		if (direction == DIRECTION_HUB)
+		{
+			LOG << "Destination node " << route_data.dst_id << " is directly connected to a reachable RadioHub" << endl;
+			return vector<int>(1, DIRECTION_HUB);
+		}
+		if (direction != NOT_VALID)
+		{
+			LOG << "Relaying to hub-connected node " << direction - DIRECTION_HUB_RELAY << " to reach destination " << route_data.dst_id << endl;
+			return vector<int>(1, direction);
 		}
 	}
-	// TODO: fix all the deprecated verbose mode logs
-	if (GlobalParams::verbose_mode > VERBOSE_OFF)
-		LOG << "Wired routing for dst = " << route_data.dst_id << endl;
+	LOG << "Wired routing for dst = " << route_data.dst_id << endl;
 
 	// not wireless direction taken, apply normal routing
 	return routingAlgorithm->route(this, route_data);
 }
 
+double Router::wiredLatency(const RouteData & route_data, const vector<int> & directions)
+{
+	// the flits queued in the least occupied downstream input port, in
+	// all its VCs, assumed to be met at every hop (free slots are only
+	// exchanged in meshes)
+	int queued = 0;
+
+	if (GlobalParams::topology == TOPOLOGY_MESH)
+	{
+		int size = GlobalParams::buffer_depth * GlobalParams::n_virtual_channels;
+
+		queued = size;
+		for (unsigned int i = 0; i < directions.size(); i++)
+			if (directions[i] < DIRECTIONS)
+				queued = min(queued, size - free_slots_neighbor[directions[i]].read());
+	}
+
+	return WirelessPaths::wiredHops(local_id, route_data.dst_id) * (1 + queued) + route_data.sequence_length;
+}
+
 int Router::route(const RouteData & route_data)
 {
+    // multicast packets are only generated by the nodes attached to a
+    // radio hub, which replicates them
+    if (route_data.multicast)
+    {
+	wireless_candidate = false;
+	return DIRECTION_HUB;
+    }
 
     if (route_data.dst_id == local_id)
 	return DIRECTION_LOCAL;
@@ -521,14 +859,17 @@ void Router::configure(const int _id,
     stats.configure(_id, _warm_up_time);
 
     start_from_port = DIRECTION_LOCAL;
+    wireless_candidate = false;
   
 
     if (grt.isValid())
 	routing_table.configure(grt, _id);
 
-    reservation_table.setSize(DIRECTIONS+2);
+    n_ports = DIRECTION_HUB + GlobalParams::hub_links;
+    n_hub_links = GlobalParams::hubs_for_tile.count(_id) ? GlobalParams::hubs_for_tile[_id].size() : 0;
+    reservation_table.setSize(n_ports);
 
-    for (int i = 0; i < DIRECTIONS + 2; i++)
+    for (int i = 0; i < n_ports; i++)
     {
 	for (int vc = 0; vc < GlobalParams::n_virtual_channels; vc++)
 	{
@@ -634,7 +975,7 @@ bool Router::inCongestion()
 
 void Router::ShowBuffersStats(std::ostream & out)
 {
-  for (int i=0; i<DIRECTIONS+2; i++)
+  for (int i=0; i<n_ports; i++)
       for (int vc=0; vc<GlobalParams::n_virtual_channels;vc++)
 	    buffer[i][vc].ShowStats(out);
 }
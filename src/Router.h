@@ -19,6 +19,8 @@
 #include "LocalRoutingTable.h"
 #include "ReservationTable.h"
 #include "Utils.h"
+#include "DVFS.h"
+#include "WirelessPaths.h"
 #include "routingAlgorithms/RoutingAlgorithm.h"
 #include "routingAlgorithms/RoutingAlgorithms.h"
 #include "selectionStrategies/SelectionStrategy.h"
@@ -30,6 +32,13 @@ using namespace std;
 
 extern unsigned int drained_volume;
 
+// Power gating states of a router block
+enum {
+    PG_ON,
+    PG_GATED,
+    PG_WAKING
+};
+
 SC_MODULE(Router)
 {
     friend class Selection_NOP;
@@ -39,16 +48,16 @@ SC_MODULE(Router)
     sc_in_clk clock;		                  // The input clock for the router
     sc_in <bool> reset;                           // The reset signal for the router
 
-    // number of ports: 4 mesh directions + local + wireless 
-    sc_in <Flit> flit_rx[DIRECTIONS + 2];	  // The input channels 
-    sc_in <bool> req_rx[DIRECTIONS + 2];	  // The requests associated with the input channels
-    sc_out <bool> ack_rx[DIRECTIONS + 2];	  // The outgoing ack signals associated with the input channels
-    sc_out <TBufferFullStatus> buffer_full_status_rx[DIRECTIONS+2];
+    // number of ports: 4 mesh directions + local + r2h links (see n_ports)
+    sc_in <Flit> flit_rx[MAX_ROUTER_PORTS];	  // The input channels 
+    sc_in <bool> req_rx[MAX_ROUTER_PORTS];	  // The requests associated with the input channels
+    sc_out <bool> ack_rx[MAX_ROUTER_PORTS];	  // The outgoing ack signals associated with the input channels
+    sc_out <TBufferFullStatus> buffer_full_status_rx[MAX_ROUTER_PORTS];
 
-    sc_out <Flit> flit_tx[DIRECTIONS + 2];   // The output channels
-    sc_out <bool> req_tx[DIRECTIONS + 2];	  // The requests associated with the output channels
-    sc_in <bool> ack_tx[DIRECTIONS + 2];	  // The outgoing ack signals associated with the output channels
-    sc_in <TBufferFullStatus> buffer_full_status_tx[DIRECTIONS+2];
+    sc_out <Flit> flit_tx[MAX_ROUTER_PORTS];   // The output channels
+    sc_out <bool> req_tx[MAX_ROUTER_PORTS];	  // The requests associated with the output channels
+    sc_in <bool> ack_tx[MAX_ROUTER_PORTS];	  // The outgoing ack signals associated with the output channels
+    sc_in <TBufferFullStatus> buffer_full_status_tx[MAX_ROUTER_PORTS];
 
     sc_out <int> free_slots[DIRECTIONS + 1];
     sc_in <int> free_slots_neighbor[DIRECTIONS + 1];
@@ -62,10 +71,13 @@ SC_MODULE(Router)
     int local_id;		                // Unique ID
     int routing_type;		                // Type of routing algorithm
     int selection_type;
-    BufferBank buffer[DIRECTIONS + 2];		// buffer[direction][virtual_channel] 
-    bool current_level_rx[DIRECTIONS + 2];	// Current level for Alternating Bit Protocol (ABP)
-    bool current_level_tx[DIRECTIONS + 2];	// Current level for Alternating Bit Protocol (ABP)
+    BufferBank buffer[MAX_ROUTER_PORTS];		// buffer[direction][virtual_channel] 
+    bool current_level_rx[MAX_ROUTER_PORTS];	// Current level for Alternating Bit Protocol (ABP)
+    bool current_level_tx[MAX_ROUTER_PORTS];	// Current level for Alternating Bit Protocol (ABP)
     Stats stats;		                // Statistics
+    LatencyStats latency_stats;		// Per-hop latency breakdown
+    AllocatorStats allocator_stats;	// Allocation and contention counters
+    PowerGatingStats pg_stats;		// Power gating events
     Power power;
     LocalRoutingTable routing_table;		// Routing table
     ReservationTable reservation_table;		// Switch reservation table
@@ -85,6 +97,25 @@ SC_MODULE(Router)
 
     unsigned long getRoutedFlits();	// Returns the number of routed flits 
 
+    // Break-even time [cycles] of a gated block (PG_BLOCK_*): the sleep
+    // length whose leakage saving pays back the wake-up energy
+    double getBreakEven(const int block);
+
+    // Leakage energy [J] of one cycle of a block
+    double getBlockLeakage(const int block);
+
+    // Switches to a DVFS level and restarts the epoch counters
+    void setDVFSLevel(const int level);
+
+    // DVFS: level, router cycles (ticks at the level frequency) and global
+    // cycles of the epoch, sum of the input buffer occupancy sampled at
+    // each tick, flits forwarded
+    int dvfs_level;
+    unsigned long dvfs_ticks;
+    unsigned long dvfs_epoch_cycles;
+    double dvfs_occupancy;
+    unsigned long dvfs_forwarded;
+
     // Constructor
 
     SC_CTOR(Router) {
@@ -122,6 +153,16 @@ SC_MODULE(Router)
     int selectionFunction(const vector <int> &directions,
 			  const RouteData & route_data);
     vector < int >routingFunction(const RouteData & route_data);
+
+    // Cycles a packet is expected to take to reach its destination
+    // through the wired network, leaving along one of the directions
+    double wiredLatency(const RouteData & route_data, const vector <int> & directions);
+
+    // Free slots of an input port advertised to the neighbor: those of
+    // the default VC, or of all the VCs when they feed the wired latency
+    // estimate of -winoc_path ADAPTIVE
+    int advertisedFreeSlots(const int port);
+    bool wireless_candidate;	// the last routed packet could use the hub
  
     NoP_data getCurrentNoPData();
     void NoP_report() const;
@@ -130,11 +171,49 @@ SC_MODULE(Router)
     int getNeighborId(int _id, int direction) const;
    
     vector<int> getNextHops(int src, int dst);
+    int n_ports;		     // DIRECTION_HUB + GlobalParams::hub_links
+    int n_hub_links;	     // r2h links in use: the hubs the tile is attached to
     int start_from_port;	     // Port from which to start the reservation cycle
-    int start_from_vc[DIRECTIONS+2]; // VC from which to start the reservation cycle for the specific port
+    int start_from_vc[MAX_ROUTER_PORTS]; // VC from which to start the reservation cycle for the specific port
+
+    // Latency breakdown: cycle of the first routing and of the reservation
+    // grant of the head flit at the front of each input buffer
+    double route_time[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];
+    double grant_time[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];
+
+    // Power gating: state, consecutive idle cycles and remaining wake-up
+    // cycles of each input port (mesh directions and local) and of the
+    // router logic, and the cycle each of them was gated
+    int pg_state[DIRECTIONS + 1];
+    int pg_idle[DIRECTIONS + 1];
+    int pg_wakeup[DIRECTIONS + 1];
+    double pg_sleep_start[DIRECTIONS + 1];
+    int pg_router_state;
+    int pg_router_wakeup;
+    double pg_router_sleep_start;
+
+    // Last payload received from and sent to each port (payload_energy)
+    Payload last_rx_payload[MAX_ROUTER_PORTS];
+    Payload last_tx_payload[MAX_ROUTER_PORTS];
+
+    // DVFS: phase accumulator of the effective clock, cycles each input
+    // head flit has been synchronized for
+    double dvfs_ratio;
+    double dvfs_phase;
+    int dvfs_sync[MAX_ROUTER_PORTS];
+
+    bool dvfsTick();
+    bool isSynchronized(const int port);
+
+    void powerGatingUpdate();
+    bool isBypassing(const int port) const;
+    bool isGated(const int port) const;
 
-    vector<int> nextDeltaHops(RouteData rd);
   public:
+    // Nodes crossed from the source to the destination of a packet
+    // (delta topologies)
+    vector<int> nextDeltaHops(RouteData rd);
+
     unsigned int local_drained;
 
     bool inCongestion();
@@ -0,0 +1,184 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the sleep controller of the
+ * radio hub transceivers
+ */
+
+#include <systemc.h>
+
+#include "SleepController.h"
+
+SleepPoliciesMap * SleepPolicies::sleepPoliciesMap = 0;
+
+SleepPolicy * SleepPolicies::get(const string & sleepPolicyName) {
+    SleepPoliciesMap::iterator it = getSleepPoliciesMap()->find(sleepPolicyName);
+
+    if (it == getSleepPoliciesMap()->end())
+	return 0;
+
+    return it->second;
+}
+
+SleepPoliciesMap * SleepPolicies::getSleepPoliciesMap() {
+    if (sleepPoliciesMap == 0)
+	sleepPoliciesMap = new SleepPoliciesMap();
+    return sleepPoliciesMap;
+}
+
+// Turns the transceiver off after wireless_sleep_timeout idle cycles
+class SLEEP_TIMEOUT : public SleepPolicy {
+  public:
+    int sleepAfter(const deque <int> & history, const double break_even) {
+	return GlobalParams::wireless_sleep_timeout;
+    }
+    int wakeAfter(const deque <int> & history, const double break_even) {
+	return NOT_VALID;
+    }
+};
+
+// Predicts the idle period as the average of the last ones, each weighing
+// twice the previous one. If the transceiver can sleep for the break-even
+// time before it has to wake up for the predicted end of the period, it
+// is turned off at once and woken up in advance; otherwise, or without a
+// history, it is turned off after the timeout
+class SLEEP_PREDICTIVE : public SleepPolicy {
+  public:
+    int sleepAfter(const deque <int> & history, const double break_even) {
+	return worthSleeping(history, break_even) ? 0 : GlobalParams::wireless_sleep_timeout;
+    }
+    int wakeAfter(const deque <int> & history, const double break_even) {
+	if (!worthSleeping(history, break_even))
+	    return NOT_VALID;
+	return (int)(predict(history) - GlobalParams::wireless_wakeup_latency);
+    }
+
+  private:
+    double predict(const deque <int> & history) {
+	double sum = 0.0, weights = 0.0, weight = 1.0;
+
+	for (unsigned int i = 0; i < history.size(); i++, weight *= 2)
+	{
+	    sum += weight * history[i];
+	    weights += weight;
+	}
+	return sum / weights;
+    }
+    bool worthSleeping(const deque <int> & history, const double break_even) {
+	return !history.empty() &&
+	    predict(history) - GlobalParams::wireless_wakeup_latency >= max(break_even, 1.0);
+    }
+};
+
+static SleepPoliciesRegister sleep_timeout("TIMEOUT", new SLEEP_TIMEOUT());
+static SleepPoliciesRegister sleep_predictive("PREDICTIVE", new SLEEP_PREDICTIVE());
+
+SleepController::SleepController()
+{
+    policy = 0;
+    on_energy = 0.0;
+    break_even = 0.0;
+    state = SLEEP_ON;
+    pending = false;
+    idle_start = NOT_VALID;
+    sleep_at = wake_at = NOT_VALID;
+    sleep_start = wake_end = 0.0;
+    sleeps = sleep_cycles = wakeups = early_wakeups = short_sleeps = stall_cycles = 0;
+}
+
+void SleepController::configure(const double _on_energy)
+{
+    policy = SleepPolicies::get(GlobalParams::wireless_sleep_policy);
+    if (policy == 0)
+    {
+	cerr << " FATAL: invalid sleep policy -wisleep " << GlobalParams::wireless_sleep_policy << ", check with noxim -help" << endl;
+	exit(-1);
+    }
+
+    on_energy = _on_energy;
+    break_even = on_energy > 0 ? GlobalParams::wireless_wakeup_energy / on_energy : 0.0;
+}
+
+void SleepController::wakeUp(const double now, const bool early)
+{
+    if (now - sleep_start < break_even)
+	short_sleeps++;
+    if (early)
+	early_wakeups++;
+    else
+	wakeups++;
+
+    wake_end = now + GlobalParams::wireless_wakeup_latency;
+    state = wake_end > now ? SLEEP_WAKING : SLEEP_ON;
+}
+
+void SleepController::request()
+{
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+    if (state == SLEEP_OFF)
+	wakeUp(now, false);
+    pending = true;
+}
+
+void SleepController::cycle(const bool busy)
+{
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+
+    if (state == SLEEP_WAKING && now >= wake_end)
+	state = SLEEP_ON;
+
+    if (busy || pending)
+    {
+	// end of the idle period
+	if (idle_start != NOT_VALID)
+	{
+	    history.push_back((int)(now - idle_start));
+	    if ((int)history.size() > GlobalParams::wireless_sleep_history)
+		history.pop_front();
+	    idle_start = NOT_VALID;
+	}
+
+	if (state == SLEEP_OFF)
+	    wakeUp(now, false);
+
+	// a requested transceiver stays on until it is used
+	if (state != SLEEP_ON)
+	    stall_cycles++;
+	else if (busy)
+	    pending = false;
+	return;
+    }
+
+    if (idle_start == NOT_VALID)
+    {
+	int sleep_after = policy->sleepAfter(history, break_even);
+	int wake_after = policy->wakeAfter(history, break_even);
+
+	idle_start = now;
+	sleep_at = now + sleep_after;
+	wake_at = wake_after == NOT_VALID ? NOT_VALID : now + max(wake_after, sleep_after);
+    }
+
+    if (state == SLEEP_ON && now >= sleep_at)
+    {
+	state = SLEEP_OFF;
+	sleep_start = now;
+	sleeps++;
+    }
+    else if (state == SLEEP_OFF && wake_at != NOT_VALID && now >= wake_at)
+    {
+	// predicted end of the idle period: if it is longer, the
+	// transceiver is turned off again after the timeout
+	wakeUp(now, true);
+	sleep_at = wake_end + GlobalParams::wireless_sleep_timeout;
+	wake_at = NOT_VALID;
+    }
+
+    if (state == SLEEP_OFF)
+	sleep_cycles++;
+}
@@ -0,0 +1,105 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the sleep controller of the radio
+ * hub transceivers and of the policies predicting their idle periods
+ */
+
+#ifndef __NOXIMSLEEPCONTROLLER_H__
+#define __NOXIMSLEEPCONTROLLER_H__
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include "GlobalParams.h"
+
+using namespace std;
+
+// A policy decides, at the start of an idle period of a transceiver,
+// after how many idle cycles to turn it off and to wake it up again in
+// advance, from the lengths of the last idle periods (oldest first)
+class SleepPolicy {
+  public:
+    virtual ~SleepPolicy() {}
+    virtual int sleepAfter(const deque <int> & history, const double break_even) = 0;
+    // NOT_VALID to wake up only when requested
+    virtual int wakeAfter(const deque <int> & history, const double break_even) = 0;
+};
+
+typedef map<string, SleepPolicy * > SleepPoliciesMap;
+
+class SleepPolicies {
+  public:
+    static SleepPoliciesMap * sleepPoliciesMap;
+    static SleepPoliciesMap * getSleepPoliciesMap();
+
+    static SleepPolicy * get(const string & sleepPolicyName);
+};
+
+struct SleepPoliciesRegister : SleepPolicies {
+    SleepPoliciesRegister(const string & sleepPolicyName, SleepPolicy * sleepPolicy) {
+	getSleepPoliciesMap()->insert(make_pair(sleepPolicyName, sleepPolicy));
+    }
+};
+
+// Turns a transceiver off while idle and on again when a transmission
+// requests it or when its policy predicts the end of the idle period;
+// waking up takes wireless_wakeup_latency cycles and
+// wireless_wakeup_energy J. Like the energy, the events are accounted for
+// the whole simulation, warm-up included
+class SleepController {
+
+  public:
+
+    SleepController();
+
+    // on_energy is the energy [J] of a cycle with the transceiver on
+    void configure(const double on_energy);
+
+    // Advances a cycle, busy if the transceiver is in use or needed
+    void cycle(const bool busy);
+
+    // A transmission found the transceiver not on: it starts waking up,
+    // if off, and stays on until it is used
+    void request();
+
+    bool isOn() const { return state == SLEEP_ON; }
+    bool isOff() const { return state == SLEEP_OFF; }
+
+    // Sleep cycles saving the energy of a wake-up
+    double getBreakEven() const { return break_even; }
+    double getOnEnergy() const { return on_energy; }
+
+    unsigned long sleeps;
+    unsigned long sleep_cycles;
+    unsigned long wakeups;		// requested by a transmission
+    unsigned long early_wakeups;	// predicted by the policy
+    unsigned long short_sleeps;		// shorter than the break-even time
+    unsigned long stall_cycles;		// needed while not on
+
+  private:
+
+    enum { SLEEP_ON, SLEEP_OFF, SLEEP_WAKING };
+
+    SleepPolicy * policy;
+    double on_energy;
+    double break_even;
+
+    int state;
+    bool pending;			// requested and not used yet
+    deque <int> history;		// last idle periods [cycles]
+    double idle_start;			// NOT_VALID while busy
+    double sleep_at;
+    double wake_at;			// NOT_VALID if only on request
+    double sleep_start;
+    double wake_end;
+
+    void wakeUp(const double now, const bool early);
+};
+
+#endif
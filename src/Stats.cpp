@@ -9,6 +9,7 @@
  */
 
 #include "Stats.h"
+#include "Profiler.h"
 
 // TODO: nan in averageDelay
 
@@ -21,6 +22,8 @@ void Stats::configure(const int node_id, const double _warm_up_time)
 void Stats::receivedFlit(const double arrival_time,
 			      const Flit & flit)
 {
+    PROFILE(PROF_STATS_RECEIVED_FLIT);
+
     if (arrival_time - GlobalParams::reset_time < warm_up_time)
 	return;
 
@@ -41,6 +44,10 @@ void Stats::receivedFlit(const double arrival_time,
     if (flit.flit_type == FLIT_TYPE_HEAD)
 	chist[i].delays.push_back(arrival_time - flit.timestamp);
 
+    // last flit of the packet (the head one for single flit packets)
+    if (flit.sequence_no == flit.sequence_length - 1)
+	chist[i].packet_delays.push_back(arrival_time - flit.timestamp);
+
     chist[i].total_received_flits++;
     chist[i].last_received_flit_time = arrival_time - warm_up_time;
 }
@@ -103,6 +110,42 @@ double Stats::getMaxDelay()
     return maxd;
 }
 
+double Stats::getAveragePacketDelay()
+{
+    double sum = 0.0;
+    unsigned int n = 0;
+
+    for (unsigned int k = 0; k < chist.size(); k++) {
+	for (unsigned int j = 0; j < chist[k].packet_delays.size(); j++)
+	    sum += chist[k].packet_delays[j];
+	n += chist[k].packet_delays.size();
+    }
+
+    return sum / (double) n;
+}
+
+double Stats::getMaxPacketDelay()
+{
+    double maxd = -1.0;
+
+    for (unsigned int k = 0; k < chist.size(); k++)
+	for (unsigned int j = 0; j < chist[k].packet_delays.size(); j++)
+	    if (chist[k].packet_delays[j] > maxd)
+		maxd = chist[k].packet_delays[j];
+
+    return maxd;
+}
+
+unsigned int Stats::getCompletedPackets()
+{
+    unsigned int n = 0;
+
+    for (unsigned int i = 0; i < chist.size(); i++)
+	n += chist[i].packet_delays.size();
+
+    return n;
+}
+
 double Stats::getAverageThroughput(const int src_id)
 {
     int i = searchCommHistory(src_id);
@@ -154,6 +197,16 @@ unsigned int Stats::getReceivedFlits()
     return n;
 }
 
+unsigned int Stats::getReceivedFlits(const int src_id)
+{
+    int i = searchCommHistory(src_id);
+
+    if (i < 0)
+	return 0;
+
+    return chist[i].total_received_flits;
+}
+
 unsigned int Stats::getTotalCommunications()
 {
     return chist.size();
@@ -230,3 +283,151 @@ void Stats::showStats(int curr_node, std::ostream & out, bool header)
     out << "% Aggregated average throughput (flits/cycle): " <<
 	getAverageThroughput() << endl;
 }
+
+bool SourceStats::inWarmUp() const
+{
+    return sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time <
+	GlobalParams::stats_warm_up_time;
+}
+
+void SourceStats::generatedPacket(const Packet & packet)
+{
+    generated_flits += packet.size;
+
+    if (!inWarmUp())
+	offered_flits += packet.size * max(1, packet.multicast.size());
+}
+
+void SourceStats::multicastPacket(const int destinations, const int wireless)
+{
+    if (inWarmUp())
+	return;
+
+    multicast_packets++;
+    multicast_destinations += destinations;
+    wireless_destinations += wireless;
+}
+
+void SourceStats::sampleBacklog()
+{
+    if (inWarmUp())
+	return;
+
+    unsigned long backlog = getBacklog();
+
+    if (backlog_samples == 0)
+	first_backlog = backlog;
+    last_backlog = backlog;
+
+    backlog_sum += backlog;
+    backlog_samples++;
+
+    if (backlog > max_backlog)
+	max_backlog = backlog;
+}
+
+double SourceStats::getAverageBacklog() const
+{
+    return backlog_samples ? backlog_sum / backlog_samples : 0.0;
+}
+
+bool AllocatorStats::inWarmUp() const
+{
+    return sc_time_stamp().to_double() / GlobalParams::clock_period_ps - GlobalParams::reset_time <
+	GlobalParams::stats_warm_up_time;
+}
+
+void AllocatorStats::reservation(const int port, const int rt_status)
+{
+    // an already reserved head flit is not a new request
+    if (rt_status == RT_ALREADY_SAME || inWarmUp())
+	return;
+
+    requests[port]++;
+
+    if (rt_status == RT_AVAILABLE)
+	grants[port]++;
+    else if (rt_status == RT_OUTVC_BUSY)
+	outvc_busy[port]++;
+    else if (rt_status == RT_ALREADY_OTHER_OUT)
+	other_out[port]++;
+}
+
+void AllocatorStats::stall(const int port, const bool ack_pending)
+{
+    if (inWarmUp())
+	return;
+
+    if (ack_pending)
+	stall_ack[port]++;
+    else
+	stall_full[port]++;
+}
+
+void AllocatorStats::sampleWait(const int port, const int vc, const bool waiting)
+{
+    if (!waiting) {
+	wait_age[port][vc] = 0;
+	return;
+    }
+
+    wait_age[port][vc]++;
+
+    if (inWarmUp())
+	return;
+
+    hol_cycles[port]++;
+    if (wait_age[port][vc] > max_wait[port])
+	max_wait[port] = wait_age[port][vc];
+}
+
+bool LatencyStats::inWarmUp(const Flit & flit) const
+{
+    // whole packets are either in or out, based on their generation time
+    return flit.timestamp - GlobalParams::reset_time < GlobalParams::stats_warm_up_time;
+}
+
+vector <double> & LatencyStats::flow(const Flit & flit)
+{
+    vector <double> & v = flows[make_pair(flit.src_id, flit.dst_id)];
+
+    if (v.empty())
+	v.resize(LAT_NO_COMPONENTS + 1, 0.0);
+
+    return v;
+}
+
+void LatencyStats::account(const Flit & flit, const int component, const double cycles)
+{
+    if (inWarmUp(flit))
+	return;
+
+    total[component] += cycles;
+    samples[component]++;
+    flow(flit)[component] += cycles;
+}
+
+void LatencyStats::delivered(const Flit & flit)
+{
+    if (inWarmUp(flit))
+	return;
+
+    flow(flit)[LAT_NO_COMPONENTS]++;
+}
+
+const char * LatencyStats::getLabel(const int component)
+{
+    static const char * labels[LAT_NO_COMPONENTS] = {
+	"source_queueing",
+	"routing",
+	"vc_allocation",
+	"switch_allocation",
+	"link",
+	"hub_tx_queueing",
+	"token_wait",
+	"wireless_transmission",
+	"hub_rx_queueing"
+    };
+
+    return labels[component];
+}
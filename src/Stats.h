@@ -14,6 +14,7 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <map>
 #include "DataStructs.h"
 #include "Power.h"
 using namespace std;
@@ -21,6 +22,7 @@ using namespace std;
 struct CommHistory {
     int src_id;
      vector < double >delays;
+     vector < double >packet_delays;	// tail arrival - generation
     unsigned int total_received_flits;
     double last_received_flit_time;
 };
@@ -51,6 +53,18 @@ class Stats {
     // Returns the max delay (cycles) for the current node
     double getMaxDelay();
 
+    // Returns the average packet completion delay (cycles), i.e. from
+    // packet generation to the arrival of its last flit, for the
+    // current node
+    double getAveragePacketDelay();
+
+    // Returns the max packet completion delay (cycles) for the current
+    // node
+    double getMaxPacketDelay();
+
+    // Returns the number of completely received packets
+    unsigned int getCompletedPackets();
+
     // Returns the average throughput (flits/cycle) for the current node
     // and for the communication whose source is src_id
     double getAverageThroughput(const int src_id);
@@ -64,6 +78,9 @@ class Stats {
     // Returns the number of received flits from current node
     unsigned int getReceivedFlits();
 
+    // Returns the number of flits received from src_id
+    unsigned int getReceivedFlits(const int src_id);
+
     // Returns the number of communications whose destination is the
     // current node
     unsigned int getTotalCommunications();
@@ -88,4 +105,203 @@ class Stats {
     int searchCommHistory(int src_id);
 };
 
+// Source side statistics of a processing element: offered load and
+// backlog of packets generated but not yet injected into the network
+class SourceStats {
+
+  public:
+
+    SourceStats() {
+	generated_flits = injected_flits = 0;
+	offered_flits = 0;
+	backlog_sum = 0.0;
+	backlog_samples = 0;
+	max_backlog = 0;
+	first_backlog = last_backlog = 0;
+	multicast_packets = multicast_destinations = wireless_destinations = 0;
+    }
+
+    // Accounts a packet entering the source queue. A multicast packet
+    // offers its flits to each of its destinations
+    void generatedPacket(const Packet & packet);
+
+    // Accounts a multicast packet of which wireless destinations are
+    // reached by a single radio transmission, the others by unicast
+    // copies
+    void multicastPacket(const int destinations, const int wireless);
+
+    // Accounts a flit leaving the source queue
+    void injectedFlit() { injected_flits++; }
+
+    // Samples the current backlog, to be called once per cycle
+    void sampleBacklog();
+
+    // Returns the flits generated after the warm-up
+    unsigned long getOfferedFlits() const { return offered_flits; }
+
+    // Returns the flits currently waiting in the source queue
+    unsigned long getBacklog() const { return generated_flits - injected_flits; }
+
+    // Returns the average backlog (flits) after the warm-up
+    double getAverageBacklog() const;
+
+    // Returns the max backlog (flits) after the warm-up
+    unsigned long getMaxBacklog() const { return max_backlog; }
+
+    // Returns the backlog growth (flits) along the measured window
+    long getBacklogGrowth() const { return (long)last_backlog - (long)first_backlog; }
+
+    // Multicast packets generated after the warm-up, their destinations
+    // and those reached by a wireless multicast
+    unsigned long getMulticastPackets() const { return multicast_packets; }
+    unsigned long getMulticastDestinations() const { return multicast_destinations; }
+    unsigned long getWirelessDestinations() const { return wireless_destinations; }
+
+  private:
+
+    bool inWarmUp() const;
+
+    unsigned long generated_flits;
+    unsigned long injected_flits;
+    unsigned long offered_flits;
+    double backlog_sum;
+    unsigned long backlog_samples;
+    unsigned long max_backlog;
+    unsigned long first_backlog;
+    unsigned long last_backlog;
+    unsigned long multicast_packets;
+    unsigned long multicast_destinations;
+    unsigned long wireless_destinations;
+};
+
+// Allocation and contention counters of the input ports of a router,
+// enabled by GlobalParams::show_allocator_stats
+class AllocatorStats {
+
+  public:
+
+    AllocatorStats() {
+	for (int i = 0; i < MAX_ROUTER_PORTS; i++) {
+	    requests[i] = grants[i] = 0;
+	    outvc_busy[i] = other_out[i] = 0;
+	    stall_ack[i] = stall_full[i] = 0;
+	    hol_cycles[i] = max_wait[i] = 0;
+	    for (int vc = 0; vc < MAX_VIRTUAL_CHANNELS; vc++)
+		wait_age[i][vc] = 0;
+	}
+    }
+
+    // Accounts the outcome (RT_*) of a reservation attempt of the head
+    // flit at the front of input port
+    void reservation(const int port, const int rt_status);
+
+    // Accounts a reserved flit of input port which cannot be forwarded
+    // because the ack of the previous flit is pending (ABP) or because
+    // the downstream buffer is full
+    void stall(const int port, const bool ack_pending);
+
+    // Accounts one more cycle the front flit of input port, virtual
+    // channel vc, has been waiting (or resets its age when it moved)
+    void sampleWait(const int port, const int vc, const bool waiting);
+
+    unsigned long requests[MAX_ROUTER_PORTS];	// reservation attempts
+    unsigned long grants[MAX_ROUTER_PORTS];	// reservations granted
+    unsigned long outvc_busy[MAX_ROUTER_PORTS];	// conflicts: output VC reserved by another input
+    unsigned long other_out[MAX_ROUTER_PORTS];	// conflicts: routed to another output than the reserved one
+    unsigned long stall_ack[MAX_ROUTER_PORTS];	// reserved but ABP ack pending
+    unsigned long stall_full[MAX_ROUTER_PORTS];	// reserved but downstream buffer full
+    unsigned long hol_cycles[MAX_ROUTER_PORTS];	// cycles x VCs with a non-moving front flit
+    unsigned long max_wait[MAX_ROUTER_PORTS];	// starvation age: longest wait of a front flit
+
+  private:
+
+    bool inWarmUp() const;
+
+    unsigned long wait_age[MAX_ROUTER_PORTS][MAX_VIRTUAL_CHANNELS];
+};
+
+// Blocks gated by the router power gating (see GlobalParams::power_gating)
+enum {
+    PG_BLOCK_PORT,		// buffers of an input port
+    PG_BLOCK_ROUTER,		// routing, selection, crossbar and NI
+    PG_NO_BLOCKS
+};
+
+// Power gating events of a router. Like the energy, they are accounted
+// for the whole simulation, warm-up included
+class PowerGatingStats {
+
+  public:
+
+    PowerGatingStats() {
+	for (int i = 0; i < PG_NO_BLOCKS; i++)
+	    gatings[i] = wakeups[i] = gated_cycles[i] = short_sleeps[i] = 0;
+	wakeup_stall_cycles = 0;
+	bypassed_flits = 0;
+    }
+
+    // Accounts the wake-up of a block after sleep_cycles of gating; sleeps
+    // shorter than break_even cycles waste more energy than they save
+    void wakeup(const int block, const double sleep_cycles, const double break_even) {
+	wakeups[block]++;
+	if (sleep_cycles < break_even)
+	    short_sleeps[block]++;
+    }
+
+    unsigned long gatings[PG_NO_BLOCKS];
+    unsigned long wakeups[PG_NO_BLOCKS];
+    unsigned long gated_cycles[PG_NO_BLOCKS];	// cycles x blocks
+    unsigned long short_sleeps[PG_NO_BLOCKS];	// sleeps below the break-even time
+    unsigned long wakeup_stall_cycles;		// cycles x ports a flit waited for a wake-up
+    unsigned long bypassed_flits;		// flits crossing the gated router without waking it up
+};
+
+// Latency breakdown components (see LatencyStats)
+enum {
+    LAT_SOURCE_QUEUEING,	// packet generation -> head flit stored in the local router
+    LAT_ROUTING,		// arrival -> first routing at the front of the input buffer
+    LAT_VC_ALLOCATION,		// first routing -> output (VC) reservation granted
+    LAT_SWITCH_ALLOCATION,	// reservation granted -> forwarded through the crossbar
+    LAT_LINK,			// forwarded by the previous hop -> stored in the input buffer
+    LAT_HUB_TX_QUEUEING,	// stored in the hub -> moved to the antenna TX buffer
+    LAT_TOKEN_WAIT,		// antenna TX buffer -> start of the wireless transmission
+    LAT_WIRELESS_TRANSMISSION,	// start of the transmission -> stored in the antenna RX buffer
+    LAT_HUB_RX_QUEUEING,	// antenna RX buffer -> forwarded to the destination tile
+    LAT_NO_COMPONENTS
+};
+
+// Per-hop latency decomposition of the head flits crossing a router or
+// a hub (all values in cycles), enabled by GlobalParams::latency_breakdown
+class LatencyStats {
+
+  public:
+
+    LatencyStats() {
+	for (int i = 0; i < LAT_NO_COMPONENTS; i++) {
+	    total[i] = 0.0;
+	    samples[i] = 0;
+	}
+    }
+
+    // Accounts a latency component of the hop being crossed by flit
+    void account(const Flit & flit, const int component, const double cycles);
+
+    // Accounts a head flit delivered to its destination
+    void delivered(const Flit & flit);
+
+    static const char * getLabel(const int component);
+
+    double total[LAT_NO_COMPONENTS];
+    unsigned long samples[LAT_NO_COMPONENTS];
+
+    // per flow (src_id, dst_id) totals, the last entry counts the
+    // delivered packets
+    map < pair <int, int>, vector <double> > flows;
+
+  private:
+
+    bool inWarmUp(const Flit & flit) const;
+    vector <double> & flow(const Flit & flit);
+};
+
 #endif
@@ -19,11 +19,36 @@ void Target::b_transport( tlm::tlm_generic_payload& trans, sc_time& delay )
     // only moves received flit to the antenna buffer
     // reservations stuff is done in the hub to avoid 
     // race conditions on shared reservation table
-    if (!buffer_rx.IsFull())
+    // the flits of a bonded packet are reassembled by the hub from all
+    // its channels, in the storage reserved by their transmitter
+    bool bonded = my_flit->bond_id != NOT_VALID;
+
+    if (bonded || !buffer_rx.IsFull())
     {
         LOG << "*** [Ch" <<local_id << "] Flit " << *my_flit << " moved to buffer_rx " << endl;
-        buffer_rx.Push(*my_flit);
+        Flit flit = *my_flit;
+        if (GlobalParams::latency_breakdown && flit.flit_type == FLIT_TYPE_HEAD)
+        {
+            double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+            hub->latency_stats.account(flit, LAT_WIRELESS_TRANSMISSION, now - flit.hop_time);
+            flit.hop_time = now;
+        }
+        if (bonded)
+            hub->reassemble(flit);
+        else
+            buffer_rx.Push(flit);
         hub->power.antennaBufferPush();
+        // the receiver is needed until the last flit of the packet (the
+        // flits of a bonded packet can arrive in any order, the hub
+        // counts them)
+        if (!bonded && flit.sequence_length > 1)
+        {
+            if (flit.sequence_no == 0)
+                hub->rx_open_packets++;
+            else if (flit.sequence_no == flit.sequence_length - 1)
+                hub->rx_open_packets--;
+        }
+        hub->rx_flit_received = true;
         // Obliged to set response status to indicate successful completion
         trans.set_response_status( tlm::TLM_OK_RESPONSE );
         //buffer_rx.Print();
@@ -32,7 +57,7 @@ void Target::b_transport( tlm::tlm_generic_payload& trans, sc_time& delay )
     {
         // the response status will remain ERRROR
         // signaling to the Initiator that something went wrong
-        LOG << "[Ch" <<local_id << "] WARNING: buffer_rx is full cannot store flit " << *my_flit << endl;
+        LOG_WARNING << "[Ch" <<local_id << "] WARNING: buffer_rx is full cannot store flit " << *my_flit << endl;
     }
 }
 
@@ -0,0 +1,132 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the compact thermal model
+ */
+
+#include "ThermalModel.h"
+
+#include <cmath>
+
+void ThermalModel::configure(int _dim_x, int _dim_y, double pitch)
+{
+    dim_x = _dim_x;
+    dim_y = _dim_y;
+
+    double side = pitch * 1.0e-3;				// [m]
+    double thickness = GlobalParams::thermal_die_thickness * 1.0e-3;	// [m]
+    double area = side * side;					// [m^2]
+
+    capacitance = GlobalParams::thermal_heat_capacity * area * thickness;
+    // conduction across the side shared by two square tiles: k*(t*side)/side
+    g_lateral = GlobalParams::thermal_conductivity * thickness;
+    // vertical path (package and heat sink) per unit area, in K*mm^2/W
+    g_vertical = area / (GlobalParams::thermal_vertical_resistance * 1.0e-6);
+
+    // forward Euler is stable for steps below C / sum(G)
+    max_step = 0.5 * capacitance / (g_vertical + 4 * g_lateral);
+
+    temperature.assign(dim_x * dim_y, GlobalParams::thermal_ambient);
+    tile_power.assign(dim_x * dim_y, 0.0);
+    next.assign(dim_x * dim_y, 0.0);
+    peak_temperature = GlobalParams::thermal_ambient;
+}
+
+void ThermalModel::addUnit(Power * power, const vector <int> & tiles)
+{
+    Unit u;
+
+    u.power = power;
+    u.tiles = tiles;
+    units.push_back(u);
+
+    if (tiles.empty())
+	return;
+
+    // all the tiles start at the ambient temperature
+    power->setLeakageScale(exp(GlobalParams::thermal_leakage_beta *
+			       (GlobalParams::thermal_ambient - GlobalParams::thermal_leakage_tref)));
+}
+
+void ThermalModel::update(const vector <double> & unit_power, double seconds)
+{
+    double t_amb = GlobalParams::thermal_ambient;
+
+    for (unsigned int i = 0; i < tile_power.size(); i++)
+	tile_power[i] = 0.0;
+
+    for (unsigned int i = 0; i < units.size(); i++)
+	for (unsigned int j = 0; j < units[i].tiles.size(); j++)
+	    tile_power[units[i].tiles[j]] += unit_power[i] / units[i].tiles.size();
+
+    // the thermal time constants are orders of magnitude longer than an
+    // epoch, so the simulated time can be stretched to reach the steady
+    // state within shorter runs
+    double elapsed = seconds * GlobalParams::thermal_time_scale;
+    int steps = (int) ceil(elapsed / max_step);
+    double dt = elapsed / steps;
+
+    // 5-point stencil, adiabatic borders
+    for (int s = 0; s < steps; s++)
+    {
+	for (int y = 0; y < dim_y; y++)
+	    for (int x = 0; x < dim_x; x++)
+	    {
+		int i = y * dim_x + x;
+		double t = temperature[i];
+		double flow = tile_power[i] - g_vertical * (t - t_amb);
+
+		if (x > 0) flow -= g_lateral * (t - temperature[i - 1]);
+		if (x < dim_x - 1) flow -= g_lateral * (t - temperature[i + 1]);
+		if (y > 0) flow -= g_lateral * (t - temperature[i - dim_x]);
+		if (y < dim_y - 1) flow -= g_lateral * (t - temperature[i + dim_x]);
+
+		next[i] = t + dt * flow / capacitance;
+	    }
+	temperature.swap(next);
+    }
+
+    if (getMaxTemperature() > peak_temperature)
+	peak_temperature = getMaxTemperature();
+
+    // leakage grows exponentially with the temperature
+    for (unsigned int i = 0; i < units.size(); i++)
+    {
+	double t = 0.0;
+
+	if (units[i].tiles.empty())
+	    continue;
+
+	for (unsigned int j = 0; j < units[i].tiles.size(); j++)
+	    t += temperature[units[i].tiles[j]];
+	t /= units[i].tiles.size();
+
+	units[i].power->setLeakageScale(exp(GlobalParams::thermal_leakage_beta *
+					    (t - GlobalParams::thermal_leakage_tref)));
+    }
+}
+
+double ThermalModel::getAverageTemperature() const
+{
+    double sum = 0.0;
+
+    for (unsigned int i = 0; i < temperature.size(); i++)
+	sum += temperature[i];
+
+    return sum / temperature.size();
+}
+
+double ThermalModel::getMaxTemperature() const
+{
+    double max = temperature[0];
+
+    for (unsigned int i = 1; i < temperature.size(); i++)
+	if (temperature[i] > max)
+	    max = temperature[i];
+
+    return max;
+}
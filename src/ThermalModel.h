@@ -0,0 +1,70 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the compact thermal model, an RC
+ * grid with one node per mesh tile whose temperature drives the leakage
+ */
+
+#ifndef __NOXIMTHERMALMODEL_H__
+#define __NOXIMTHERMALMODEL_H__
+
+#include <vector>
+
+#include "Power.h"
+
+using namespace std;
+
+class ThermalModel {
+
+  public:
+
+    // Builds the dim_x x dim_y grid of square tiles of side pitch [mm]
+    void configure(int dim_x, int dim_y, double pitch);
+
+    // Adds a power unit dissipating on the given tiles (its power is
+    // split evenly among them) whose leakage follows their temperature.
+    // Units must be added in the same order as in the power trace; those
+    // without tiles are not modelled
+    void addUnit(Power * power, const vector <int> & tiles);
+
+    // Integrates the grid over seconds [s] of simulated time with the
+    // average power [W] of each unit, then updates the leakage scaling
+    void update(const vector <double> & unit_power, double seconds);
+
+    // Temperature [C] of a tile
+    double getTemperature(int tile) const { return temperature[tile]; }
+
+    double getAverageTemperature() const;
+    double getMaxTemperature() const;
+
+    // Highest temperature [C] reached by any tile during the simulation
+    double getPeakTemperature() const { return peak_temperature; }
+
+    int getDimX() const { return dim_x; }
+    int getDimY() const { return dim_y; }
+
+  private:
+
+    struct Unit {
+	Power * power;
+	vector <int> tiles;
+    };
+
+    int dim_x, dim_y;
+    double capacitance;		// per tile [J/K]
+    double g_lateral;		// between adjacent tiles [W/K]
+    double g_vertical;		// from a tile to the ambient [W/K]
+    double max_step;		// largest stable integration step [s]
+    double peak_temperature;
+
+    vector <Unit> units;
+    vector <double> temperature;
+    vector <double> tile_power;
+    vector <double> next;
+};
+
+#endif
@@ -16,6 +16,20 @@
 #include "ProcessingElement.h"
 using namespace std;
 
+// Signals of a further r2h link of a tile attached to several hubs,
+// bound by the NoC to the ports of the hub
+struct HubLink {
+    sc_signal <Flit> flit_to_hub;
+    sc_signal <bool> req_to_hub;
+    sc_signal <bool> ack_from_hub;
+    sc_signal <TBufferFullStatus> buffer_full_status_from_hub;
+
+    sc_signal <Flit> flit_from_hub;
+    sc_signal <bool> req_from_hub;
+    sc_signal <bool> ack_to_hub;
+    sc_signal <TBufferFullStatus> buffer_full_status_to_hub;
+};
+
 SC_MODULE(Tile)
 {
     SC_HAS_PROCESS(Tile);
@@ -49,6 +63,9 @@ SC_MODULE(Tile)
     sc_in <bool> hub_ack_tx;	        // The outgoing ack signals associated with the output channels
     sc_in <TBufferFullStatus> hub_buffer_full_status_tx;	
 
+    // r2h links to the other hubs, DIRECTION_HUB + 1, ...
+    HubLink hub_link[MAX_HUB_LINKS - 1];
+
 
     // NoP related I/O and signals
     sc_out <int> free_slots[DIRECTIONS];
@@ -126,6 +143,19 @@ SC_MODULE(Tile)
 	r->ack_tx[DIRECTION_HUB] (hub_ack_tx);
 	r->buffer_full_status_tx[DIRECTION_HUB] (hub_buffer_full_status_tx);
 
+	for (int k = 1; k < MAX_HUB_LINKS; k++)
+	{
+	    r->flit_rx[DIRECTION_HUB + k] (hub_link[k - 1].flit_from_hub);
+	    r->req_rx[DIRECTION_HUB + k] (hub_link[k - 1].req_from_hub);
+	    r->ack_rx[DIRECTION_HUB + k] (hub_link[k - 1].ack_to_hub);
+	    r->buffer_full_status_rx[DIRECTION_HUB + k] (hub_link[k - 1].buffer_full_status_to_hub);
+
+	    r->flit_tx[DIRECTION_HUB + k] (hub_link[k - 1].flit_to_hub);
+	    r->req_tx[DIRECTION_HUB + k] (hub_link[k - 1].req_to_hub);
+	    r->ack_tx[DIRECTION_HUB + k] (hub_link[k - 1].ack_from_hub);
+	    r->buffer_full_status_tx[DIRECTION_HUB + k] (hub_link[k - 1].buffer_full_status_from_hub);
+	}
+
 
 	// Processing Element pin assignments
 	pe = new ProcessingElement("ProcessingElement");
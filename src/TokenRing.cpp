@@ -8,148 +8,410 @@
  * This file contains the implementation of the processing element
  */
 
+#include <algorithm>
+#include <numeric>
+
 #include "TokenRing.h"
+#include "Profiler.h"
 
-void TokenRing::updateTokenPacket(int channel)
+void TokenRing::resize(int n_channels)
 {
-    int token_pos = token_position[channel];
-    int token_holder = rings_mapping[channel][token_pos];
-    // TEST HOLD BUG
-	//if (flag[channel][token_pos]->read() == RELEASE_CHANNEL)
+    ring_ids.resize(n_channels);
+    max_hold_cycles.resize(n_channels, 0);
+    frame_slots.resize(n_channels, 0);
+    token_policy.resize(n_channels);
+    mac_policy.resize(n_channels, NOT_VALID);
+}
 
-    if (flag[channel][token_holder]->read() == RELEASE_CHANNEL)
-	{
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
+int TokenRing::decodePolicy(const string & policy)
+{
+    if (policy == TOKEN_PACKET)
+	return MAC_TOKEN_PACKET;
+    if (policy == TOKEN_HOLD)
+	return MAC_TOKEN_HOLD;
+    if (policy == TOKEN_MAX_HOLD)
+	return MAC_TOKEN_MAX_HOLD;
+    if (policy == TDMA)
+	return MAC_TDMA;
+    if (policy == TDMA_WEIGHTED)
+	return MAC_TDMA_WEIGHTED;
+    if (policy == CSMA)
+	return MAC_CSMA;
+    return NOT_VALID;
+}
 
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
+bool TokenRing::isTDMA(int ring) const
+{
+    int policy = mac_policy[ring_channel[ring]];
+    return policy == MAC_TDMA || policy == MAC_TDMA_WEIGHTED;
+}
 
-	    int new_token_holder = rings_mapping[channel][token_position[channel]];
-        LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  new_token_holder << endl;
-	    current_token_holder[channel]->write(new_token_holder);
-	    // TEST HOLD BUG
-	    //flag[channel][token_position[channel]]->write(HOLD_CHANNEL);
-        flag[channel][new_token_holder]->write(HOLD_CHANNEL);
+void TokenRing::buildSchedule(int ring)
+{
+    int channel = ring_channel[ring];
+    int num_hubs = rings_mapping[ring].size();
+    vector<int> slots(num_hubs, 1);
+
+    if (mac_policy[channel] == MAC_TDMA_WEIGHTED)
+    {
+	int spare = max(0, frame_slots[channel] - num_hubs);
+	int total = 0;
+	for (int i = 0; i < num_hubs; i++)
+	    total += demand[ring][i];
+
+	// largest remainders, the spare slots evenly without demand
+	vector<pair<double, int> > remainders;
+	int assigned = 0;
+	for (int i = 0; i < num_hubs; i++)
+	{
+	    double quota = total > 0 ? (double) spare * demand[ring][i] / total : (double) spare / num_hubs;
+	    slots[i] += (int) quota;
+	    assigned += (int) quota;
+	    remainders.push_back(make_pair(-(quota - (int) quota), i));
 	}
+	sort(remainders.begin(), remainders.end());
+	for (int i = 0; assigned < spare; i++, assigned++)
+	    slots[remainders[i].second]++;
+
+	demand[ring].assign(num_hubs, 0);
+    }
+
+    // the slots of a hub are spread over the frame
+    slot_schedule[ring].clear();
+    for (int round = 0; (int) slot_schedule[ring].size() < accumulate(slots.begin(), slots.end(), 0); round++)
+	for (int i = 0; i < num_hubs; i++)
+	    if (slots[i] > round)
+		slot_schedule[ring].push_back(i);
 }
 
-void TokenRing::updateTokenMaxHold(int channel)
+void TokenRing::accountDemand(int channel, int hub)
 {
-	if (--token_hold_count[channel] == 0 ||
-		flag[channel][token_position[channel]]->read() == RELEASE_CHANNEL)
-	{
-	    token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
+    int ring = ringOf(channel, hub);
+    const vector<int> & hubs = rings_mapping[ring];
+    demand[ring][find(hubs.begin(), hubs.end(), hub) - hubs.begin()]++;
+}
 
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
-	    LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  rings_mapping[channel][token_position[channel]] << endl;
+int TokenRing::groupOf(int channel, int hub)
+{
+    const vector<vector<int> > & groups = GlobalParams::channel_configuration[channel].reuseGroups;
 
-	    current_token_holder[channel]->write(rings_mapping[channel][token_position[channel]]);
-	}
+    if (!groups.empty())
+    {
+	for (unsigned int g = 0; g < groups.size(); g++)
+	    if (find(groups[g].begin(), groups[g].end(), hub) != groups[g].end())
+		return g;
+	// the hubs not listed share one more token
+	return groups.size();
+    }
+
+    if (GlobalParams::wireless_reuse_region > 0)
+    {
+	double x, y;
+	hubPosition(hub, x, y);
+	int side = GlobalParams::wireless_reuse_region;
+	int regions_x = (GlobalParams::mesh_dim_x + side - 1) / side;
+	return (int)(y / side) * regions_x + (int)(x / side);
+    }
+
+    return 0;
+}
+
+int TokenRing::ringOf(int channel, int hub) const
+{
+    int group = groupOf(channel, hub);
+    assert(group < (int)ring_ids[channel].size() && ring_ids[channel][group] != NOT_VALID);
+    return ring_ids[channel][group];
+}
+
+int TokenRing::tokenWait(int channel, int hub) const
+{
+    if (mac_policy[channel] == MAC_CSMA)
+	return 0;
+
+    int ring = ringOf(channel, hub);
+    const vector<int> & hubs = rings_mapping[ring];
+    int num_hubs = hubs.size();
+    int position = find(hubs.begin(), hubs.end(), hub) - hubs.begin();
+    assert(position < num_hubs);
+
+    int distance = (position - token_position[ring] + num_hubs) % num_hubs;
+
+    if (distance == 0)
+	return 0;
+
+    if (mac_policy[channel] == MAC_TOKEN_PACKET || mac_policy[channel] == MAC_TOKEN_MAX_HOLD)
+	return distance;
+
+    if (isTDMA(ring))
+    {
+	// slots up to the next one of the hub
+	const vector<int> & schedule = slot_schedule[ring];
+	int frame = schedule.size();
+	distance = 1;
+	while (distance < frame && schedule[(slot_index[ring] + distance) % frame] != position)
+	    distance++;
+    }
+
+    int cycle = (int)(sc_time_stamp().to_double() / GlobalParams::clock_period_ps);
+    int left = started ? max(0, token_expiration[ring] - cycle) : max_hold_cycles[channel];
+
+    return left + (distance - 1) * max_hold_cycles[channel];
+}
+
+void TokenRing::passToken(int ring)
+{
+    // number of hubs of the ring
+    int num_hubs = rings_mapping[ring].size();
+
+    if (isTDMA(ring))
+    {
+	slot_index[ring] = (slot_index[ring] + 1) % slot_schedule[ring].size();
+	if (slot_index[ring] == 0 && mac_policy[ring_channel[ring]] == MAC_TDMA_WEIGHTED)
+	    buildSchedule(ring);
+	token_position[ring] = slot_schedule[ring][slot_index[ring]];
+    }
+    else
+	token_position[ring] = (token_position[ring]+1)%num_hubs;
+
+    int new_token_holder = rings_mapping[ring][token_position[ring]];
+    LOG << "*** Token of channel " << ring_channel[ring] << " has been assigned to Hub_" <<  new_token_holder << endl;
+    current_token_holder[ring]->write(new_token_holder);
+}
+
+void TokenRing::updateTokenPacket(int ring)
+{
+    if (flag[ring][token_position[ring]]->read() == RELEASE_CHANNEL)
+    {
+	passToken(ring);
+	flag[ring][token_position[ring]]->write(HOLD_CHANNEL);
+    }
+}
 
-	current_token_expiration[channel]->write(token_hold_count[channel]);
+void TokenRing::updateTokenMaxHold(int ring, int cycle)
+{
+    if (cycle == token_expiration[ring] ||
+	flag[ring][token_position[ring]]->read() == RELEASE_CHANNEL)
+    {
+	token_expiration[ring] = cycle + max_hold_cycles[ring_channel[ring]];
+	current_token_expiration[ring]->write(token_expiration[ring]);
+	passToken(ring);
+    }
 }
 
-void TokenRing::updateTokenHold(int channel)
+void TokenRing::updateTokenHold(int ring, int cycle)
 {
-	if (--token_hold_count[channel] == 0)
+    if (cycle == token_expiration[ring])
+    {
+	token_expiration[ring] = cycle + max_hold_cycles[ring_channel[ring]];
+	current_token_expiration[ring]->write(token_expiration[ring]);
+	passToken(ring);
+    }
+}
+
+void TokenRing::scheduleUpdate(int cycle)
+{
+    bool edge = false;
+    int timer = NOT_VALID;
+
+    update_events = sc_event_or_list();
+
+    for (unsigned int i = 0; i < rings.size(); i++)
+    {
+	int ring = rings[i];
+	int policy = mac_policy[ring_channel[ring]];
+
+	// the holder's flag can release the token at the first edge
+	// after it has been written
+	if (policy == MAC_TOKEN_PACKET || policy == MAC_TOKEN_MAX_HOLD)
 	{
-	    token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
-	    // number of hubs of the ring
-	    int num_hubs = rings_mapping[channel].size();
+	    sc_inout<int> * holder_flag = flag[ring][token_position[ring]];
 
-	    token_position[channel] = (token_position[channel]+1)%num_hubs;
-	    LOG << "*** Token of channel " << channel << " has been assigned to Hub_" <<  rings_mapping[channel][token_position[channel]] << endl;
+	    if (holder_flag->read() == RELEASE_CHANNEL)
+		edge = true;
+	    else
+		update_events |= holder_flag->value_changed_event();
+	}
 
-	    current_token_holder[channel]->write(rings_mapping[channel][token_position[channel]]);
+	if (policy != MAC_TOKEN_PACKET)
+	{
+	    assert(token_expiration[ring] >= cycle);
+	    if (token_expiration[ring] == cycle)
+		edge = true;
+	    else if (timer == NOT_VALID || token_expiration[ring] < timer)
+		timer = token_expiration[ring];
 	}
+    }
 
-	current_token_expiration[channel]->write(token_hold_count[channel]);
+    if (edge)
+	update_events |= clock.posedge_event();
+
+    // the timer wakes the process between two edges, so that the
+    // expiration is handled by the following one
+    hold_timer.cancel();
+    if (timer != NOT_VALID)
+    {
+	double now = sc_time_stamp().to_double();
+	hold_timer.notify((timer - 0.5) * GlobalParams::clock_period_ps - now, SC_PS);
+	update_events |= hold_timer;
+    }
+
+    next_trigger(update_events);
 }
 
 void TokenRing::updateTokens()
 {
+    PROFILE(PROF_TOKEN_RING_UPDATE);
+
     if (reset.read()) {
-        for (map<int,ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin();
-             i!=GlobalParams::channel_configuration.end();
-             i++)
-            current_token_holder[i->first]->write(rings_mapping[i->first][0]);
+        for (unsigned int i = 0; i < rings.size(); i++)
+            current_token_holder[rings[i]]->write(rings_mapping[rings[i]][0]);
+        return;
     }
-    else
+
+    if (rings.empty())
+	return;
+
+    double now = sc_time_stamp().to_double() / GlobalParams::clock_period_ps;
+    int cycle = NOT_VALID;
+
+    if (clock.posedge())
+	cycle = (int) now;
+    else if (!started)
+	// released reset: updated as the clock edge preceding the next one
+	cycle = (int) ceil(now) - 1;
+
+    if (cycle == NOT_VALID)
     {
+	// activated by a flag or by the hold timer, nothing moves before
+	// the next edge
+	scheduleUpdate((int) floor(now) + 1);
+	return;
+    }
 
-        for (map<int,ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin(); i!=GlobalParams::channel_configuration.end(); i++)
-        {
-            int channel = i->first;
-            //int channel_holder;
-            //channel_holder = current_token_holder[channel]->read();
-
-            string macPolicy = getPolicy(channel).first;
-
-            if (macPolicy == TOKEN_PACKET)
-                updateTokenPacket(channel);
-            else if (macPolicy == TOKEN_HOLD)
-                updateTokenHold(channel);
-            else if (macPolicy == TOKEN_MAX_HOLD)
-                updateTokenMaxHold(channel);
-            else
-                assert(false);
-        }
+    if (!started)
+    {
+	// the holds count from the reset, plus the cycle of the
+	// initialization (see the constructor)
+	for (unsigned int i = 0; i < rings.size(); i++)
+	{
+	    int ring = rings[i];
+	    int channel = ring_channel[ring];
+	    if (mac_policy[channel] != MAC_TOKEN_PACKET)
+	    {
+		token_expiration[ring] = cycle - 2 + max_hold_cycles[channel];
+		current_token_expiration[ring]->write(token_expiration[ring]);
+	    }
+	}
+	started = true;
     }
+
+    for (unsigned int i = 0; i < rings.size(); i++)
+    {
+	int ring = rings[i];
+
+	switch (mac_policy[ring_channel[ring]])
+	{
+	case MAC_TOKEN_PACKET:
+	    updateTokenPacket(ring);
+	    break;
+	case MAC_TOKEN_HOLD:
+	case MAC_TDMA:
+	case MAC_TDMA_WEIGHTED:
+	    updateTokenHold(ring, cycle);
+	    break;
+	case MAC_TOKEN_MAX_HOLD:
+	    updateTokenMaxHold(ring, cycle);
+	    break;
+	default:
+	    assert(false);
+	}
+    }
+
+    scheduleUpdate(cycle + 1);
 }
 
 
 void TokenRing::attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port)
 {
-    // If port for requested channel is not present, create the
-    // port and connect a signal
-    if (!current_token_holder[channel])
-    {
-        token_position[channel] = 0;
-        // TEST HOLDBUG
-        //token_position[channel] = hub;
-        current_token_holder[channel] = new sc_out<int>();
-        current_token_expiration[channel] = new sc_out<int>();
+    if (channel >= (int)ring_ids.size())
+        resize(channel + 1);
+
+    int group = groupOf(channel, hub);
+    if (group >= (int)ring_ids[channel].size())
+        ring_ids[channel].resize(group + 1, NOT_VALID);
 
-        token_holder_signals[channel] = new sc_signal<int>();
-        token_expiration_signals[channel] = new sc_signal<int>();
+    // If the ring of the hub is not present, create its ports and
+    // connect a signal
+    if (ring_ids[channel][group] == NOT_VALID)
+    {
+        int ring = current_token_holder.size();
+        ring_ids[channel][group] = ring;
+        ring_channel.push_back(channel);
+        ring_group.push_back(group);
+        rings_mapping.push_back(vector<int>());
+        flag.push_back(vector<sc_inout<int>* >());
+        flag_signals.push_back(vector<sc_signal<int>* >());
+        token_position.push_back(0);
+        token_expiration.push_back(NOT_VALID);
+        slot_schedule.push_back(vector<int>());
+        slot_index.push_back(0);
+        demand.push_back(vector<int>());
 
-        current_token_holder[channel]->bind(*(token_holder_signals[channel]));
-        current_token_expiration[channel]->bind(*(token_expiration_signals[channel]));
+        current_token_holder.push_back(new sc_out<int>());
+        current_token_expiration.push_back(new sc_out<int>());
 
-        // initial value that will be overwritten if mac policy != TOKEN_PACKET
-        token_hold_count[channel] = 0;
+        token_holder_signals.push_back(new sc_signal<int>());
+        token_expiration_signals.push_back(new sc_signal<int>());
 
+        current_token_holder[ring]->bind(*(token_holder_signals[ring]));
+        current_token_expiration[ring]->bind(*(token_expiration_signals[ring]));
+        current_token_expiration[ring]->write(NOT_VALID);
 
-        if (GlobalParams::channel_configuration[channel].macPolicy[0] != TOKEN_PACKET) {
+        if (mac_policy[channel] != MAC_TOKEN_PACKET && mac_policy[channel] != MAC_CSMA) {
             // checking max hold cycles vs wireless transmission latency
             // consistency
             //TODO move this check: max_hold_cycles depends on the Channel not on the Hub
             double delay_ps = 1000*GlobalParams::flit_size/GlobalParams::channel_configuration[channel].dataRate;
             int cycles = ceil(delay_ps/GlobalParams::clock_period_ps);
-            int max_hold_cycles = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
-            assert(cycles< max_hold_cycles);
+            max_hold_cycles[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
+            assert(cycles< max_hold_cycles[channel]);
+        }
+        if (mac_policy[channel] == MAC_TDMA_WEIGHTED)
+            frame_slots[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[2].c_str());
 
-            token_hold_count[channel] = atoi(GlobalParams::channel_configuration[channel].macPolicy[1].c_str());
+        // rings sorted by channel and group, the hubs of a CSMA channel
+        // contend for it without token
+        if (mac_policy[channel] != MAC_CSMA)
+        {
+            unsigned int position = 0;
+            while (position < rings.size() &&
+                   (ring_channel[rings[position]] < channel ||
+                    (ring_channel[rings[position]] == channel && ring_group[rings[position]] < group)))
+                position++;
+            rings.insert(rings.begin() + position, ring);
         }
     }
 
-    flag[channel][hub] = new sc_inout<int>();
-    flag_signals[channel][hub] = new sc_signal<int>();
-    flag[channel][hub]->bind(*(flag_signals[channel][hub]));
-    hub_flag_port->bind(*(flag_signals[channel][hub]));
+    int ring = ring_ids[channel][group];
+
+    // the flags follow the order of the hubs in the ring
+    sc_inout<int>* ring_flag = new sc_inout<int>();
+    sc_signal<int>* ring_flag_signal = new sc_signal<int>();
+    ring_flag->bind(*ring_flag_signal);
+    hub_flag_port->bind(*ring_flag_signal);
+    flag[ring].push_back(ring_flag);
+    flag_signals[ring].push_back(ring_flag_signal);
 
     // Connect tokenring to hub
-    hub_token_holder_port->bind(*(token_holder_signals[channel]));
-    hub_token_expiration_port->bind(*(token_expiration_signals[channel]));
+    hub_token_holder_port->bind(*(token_holder_signals[ring]));
+    hub_token_expiration_port->bind(*(token_expiration_signals[ring]));
 
     //LOG << "Attaching Hub " << hub << " to the token ring for channel " << channel << endl;
-    rings_mapping[channel].push_back(hub);
+    rings_mapping[ring].push_back(hub);
+    demand[ring].push_back(0);
+    if (isTDMA(ring))
+        buildSchedule(ring);
 
-    // TEST HOLD BUG
-    int starting_hub = rings_mapping[channel][0];
-    current_token_holder[channel]->write(starting_hub);
+    int starting_hub = rings_mapping[ring][0];
+    current_token_holder[ring]->write(starting_hub);
 }
-
-
@@ -27,18 +27,25 @@ SC_MODULE(TokenRing)
     sc_in_clk clock;	
     sc_in < bool > reset;
 
-    map<int, sc_out<int>* > current_token_holder;
-    map<int, sc_out<int>* > current_token_expiration;
-    map<int, map<int,sc_inout<int>* > > flag;
+    // Each channel has one ring, and therefore one token, per reuse group
+    // of its hubs (see groupOf). Indexed by ring id
+    vector<sc_out<int>* > current_token_holder;
+    // cycle at which the hold of the token expires (TOKEN_HOLD and
+    // TOKEN_MAX_HOLD), NOT_VALID before the first update
+    vector<sc_out<int>* > current_token_expiration;
+    vector<vector<sc_inout<int>* > > flag;	// by position in the ring
 
-    map<int, sc_signal<int>* > token_holder_signals;
-    map<int, sc_signal<int>* > token_expiration_signals;
-    map<int, map<int, sc_signal<int>* > > flag_signals;
+    vector<sc_signal<int>* > token_holder_signals;
+    vector<sc_signal<int>* > token_expiration_signals;
+    vector<vector<sc_signal<int>* > > flag_signals;
 
 
 
     void attachHub(int channel, int hub, sc_in<int>* hub_token_holder_port, sc_in<int>* hub_token_expiration_port, sc_inout<int>* hub_flag_port);
 
+    // Moves the tokens. After the reset the process is only activated by
+    // the clock edges at which a token can move: the edge following the
+    // release of the holder's flag or the expiration of a hold
     void updateTokens();
 
     TokenRing(sc_module_name nm): sc_module(nm) {
@@ -49,32 +56,101 @@ SC_MODULE(TokenRing)
 	    SC_METHOD(updateTokens);
 	    sensitive << reset;
 	    sensitive << clock.pos();
+	    // the reset is not yet asserted at the initialization, which
+	    // therefore counts as one cycle of the first token holds
+	    dont_initialize();
 	}
+	started = false;
 
         for (map<int, ChannelConfig>::iterator i = GlobalParams::channel_configuration.begin(); 
                 i != GlobalParams::channel_configuration.end();
                 ++i) {
-            token_policy[i->first] = make_pair(i->second.macPolicy[0], i->second.macPolicy); 
+            int channel = i->first;
+
+            if (channel >= (int)token_policy.size())
+                resize(channel + 1);
+            token_policy[channel] = make_pair(i->second.macPolicy[0], i->second.macPolicy); 
+            mac_policy[channel] = decodePolicy(i->second.macPolicy[0]);
         }
     }
 
     pair<string, vector<string> > getPolicy(int channel) { return token_policy[channel];}
 
+    // Reuse group of a hub on a channel: the hubs of a group share a
+    // token, those of different groups can transmit at the same time.
+    // Groups are listed by reuse_groups in the channel configuration or
+    // are the square regions of wireless_reuse_region tiles per side;
+    // otherwise all the hubs of the channel share a single token
+    static int groupOf(int channel, int hub);
+
+    // MAC_* code of the policy of a channel, to avoid string compares
+    // on the per cycle paths
+    int getMacPolicy(int channel) const { return mac_policy[channel]; }
+
+    // Cycles a hub is expected to wait for the token of a channel: the
+    // hubs ahead in the ring pass it at once, unless with TOKEN_HOLD
+    // each of them keeps it for the whole hold, or with TDMA for the
+    // slots ahead of the next one of the hub (none with CSMA)
+    int tokenWait(int channel, int hub) const;
+
+    // Counts a flit queued by a hub for a TDMA_WEIGHTED channel: the
+    // slots of each frame are shared by the demand of the previous one
+    void accountDemand(int channel, int hub);
+
+    // MAC_* code of a policy name, NOT_VALID if unknown
+    static int decodePolicy(const string & policy);
+
     private:
 
-    void updateTokenMaxHold(int channel);
-    void updateTokenHold(int channel);
-    void updateTokenPacket(int channel);
+    void updateTokenMaxHold(int ring, int cycle);
+    void updateTokenHold(int ring, int cycle);
+    void updateTokenPacket(int ring);
+    void passToken(int ring);
+
+    // Sets the events activating the next update, cycle being the next
+    // clock edge
+    void scheduleUpdate(int cycle);
 
-    // ring of a channel -> list of pairs < hubs , hold counts >
-    map<int,vector<int> > rings_mapping;
+    // channel -> reuse group -> ring id (NOT_VALID if not created yet)
+    vector<vector<int> > ring_ids;
+    int ringOf(int channel, int hub) const;
 
-    // ring of a channel -> token position in the ring
-    map<int,int> token_position;
+    vector<int> ring_channel;
+    vector<int> ring_group;
+
+    // ring -> hubs in token order
+    vector<vector<int> > rings_mapping;
+
+    // ring -> token position in the ring
+    vector<int> token_position;
     
-    map<int,int> token_hold_count;
+    vector<int> token_expiration;	// cycle at which the hold expires, by ring
+    vector<int> max_hold_cycles;	// by channel
+
+    vector<pair<string, vector<string> > > token_policy;	// by channel
+    vector<int> mac_policy;		// by channel
+
+    // TDMA: positions of the slots of the frame, current slot and flits
+    // queued since the start of the frame (by position), by ring
+    vector<vector<int> > slot_schedule;
+    vector<int> slot_index;
+    vector<vector<int> > demand;
+    vector<int> frame_slots;		// TDMA_WEIGHTED, by channel
+
+    // Builds the slots of the next frame: one per hub, the others of
+    // TDMA_WEIGHTED shared by the demand of the last frame
+    void buildSchedule(int ring);
+    bool isTDMA(int ring) const;
+
+    // rings moved by the token ring (CSMA channels have none), by
+    // channel and group
+    vector<int> rings;
+
+    bool started;			// first update after the reset done
+    sc_event hold_timer;		// half a cycle before the next expiration
+    sc_event_or_list update_events;
 
-    map<int,pair<string, vector<string> > >token_policy;
+    void resize(int n_channels);
 
 };
 
@@ -17,41 +17,69 @@
 #include "DataStructs.h"
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+
+// Logging
+//
+// LOG_AT(level, module) << ... prints only when the log level of
+// 'module' (a hierarchical module name) is >= level. The stream
+// expression is in the else branch of an if, so none of the operands
+// is evaluated when the message is filtered out.
+//
+// LOG_MAX_LEVEL is the compile-time ceiling: call sites above it are
+// removed by the compiler. Build with -DLOG_MAX_LEVEL=LOG_LEVEL_OFF to
+// drop all logging code. Runtime levels are set with -log and
+// -log_module (or log_level/log_modules in the YAML file).
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_LEVEL_DEBUG
+#endif
 
-#ifdef DEBUG
-
-#define LOG (std::cout << std::setw(7) << left << sc_time_stamp().to_double() / GlobalParams::clock_period_ps << " " << name() << "::" << __func__<< "() --> ")
-
-#else
-template <class cT, class traits = std::char_traits<cT> >
-class basic_nullbuf: public std::basic_streambuf<cT, traits> {
-    typename traits::int_type overflow(typename traits::int_type c)
-    {
-        return traits::not_eof(c); // indicate success
-    }
-};
-
-template <class cT, class traits = std::char_traits<cT> >
-class basic_onullstream: public std::basic_ostream<cT, traits> {
-public:
-    basic_onullstream():
-    std::basic_ios<cT, traits>(&m_sbuf),
-    std::basic_ostream<cT, traits>(&m_sbuf)
-    {
-        // note: the original code is missing the required this->
-        this->init(&m_sbuf);
+// Returns the runtime log level of a module: the level of the longest
+// log_module_levels entry which is the module itself or one of its
+// parents, otherwise the global log_level
+inline int logModuleLevel(const char * module)
+{
+    // module names returned by name() are stable for the whole simulation
+    static map<const char *, int> cache;
+
+    map<const char *, int>::iterator it = cache.find(module);
+    if (it != cache.end())
+	return it->second;
+
+    string m(module);
+    int level = GlobalParams::log_level;
+    size_t best = 0;
+    for (map<string, int>::iterator i = GlobalParams::log_module_levels.begin();
+	 i != GlobalParams::log_module_levels.end(); i++) {
+	const string & pattern = i->first;
+	if (pattern.size() > best && m.compare(0, pattern.size(), pattern) == 0 &&
+	    (m.size() == pattern.size() || m[pattern.size()] == '.')) {
+	    level = i->second;
+	    best = pattern.size();
+	}
     }
 
-private:
-    basic_nullbuf<cT, traits> m_sbuf;
-};
+    cache[module] = level;
+    return level;
+}
 
-typedef basic_onullstream<char> onullstream;
-typedef basic_onullstream<wchar_t> wonullstream;
+inline bool logEnabled(int level, const char * module)
+{
+    // fast path: nothing in the network logs at this level
+    if (level > GlobalParams::log_level_max)
+	return false;
 
-static onullstream LOG;
+    return level <= logModuleLevel(module);
+}
 
-#endif
+#define LOG_AT(level, module) \
+    if (!((level) <= LOG_MAX_LEVEL && logEnabled((level), (module)))) ; else \
+	(std::cout << std::setw(7) << left << sc_time_stamp().to_double() / GlobalParams::clock_period_ps << " " << (module) << "::" << __func__ << "() --> ")
+
+#define LOG LOG_AT(LOG_LEVEL_DEBUG, name())
+#define LOG_INFO LOG_AT(LOG_LEVEL_INFO, name())
+#define LOG_WARNING LOG_AT(LOG_LEVEL_WARNING, name())
 
 // Output overloading
 
@@ -94,7 +122,18 @@ inline ostream & operator <<(ostream & os, const Flit & flit)
 	    break;
 	}
 
-	os <<  flit.sequence_no << ", " << flit.src_id << "->" << flit.dst_id << " VC " << flit.vc_id << ")";
+	os <<  flit.sequence_no << ", " << flit.src_id << "->";
+	if (flit.multicast.empty())
+	    os << flit.dst_id;
+	else
+	{
+	    vector<int> nodes = flit.multicast.nodes();
+	    os << "{";
+	    for (unsigned int i = 0; i < nodes.size(); i++)
+		os << (i ? "," : "") << nodes[i];
+	    os << "}";
+	}
+	os << " VC " << flit.vc_id << ")";
     }
 
     return os;
@@ -209,15 +248,19 @@ inline int coord2Id(const Coord & coord)
     return id;
 }
 
+// Whether two tiles are attached to a common hub
 inline bool sameRadioHub(int id1, int id2)
 {
-    map<int, int>::iterator it1 = GlobalParams::hub_for_tile.find(id1); 
-    map<int, int>::iterator it2 = GlobalParams::hub_for_tile.find(id2); 
+    map<int, vector<int> >::iterator it1 = GlobalParams::hubs_for_tile.find(id1); 
+    map<int, vector<int> >::iterator it2 = GlobalParams::hubs_for_tile.find(id2); 
 
-    assert( (it1 != GlobalParams::hub_for_tile.end()) && "Specified Tile is not connected to any Hub");
-    assert( (it2 != GlobalParams::hub_for_tile.end()) && "Specified Tile is not connected to any Hub");
+    assert( (it1 != GlobalParams::hubs_for_tile.end()) && "Specified Tile is not connected to any Hub");
+    assert( (it2 != GlobalParams::hubs_for_tile.end()) && "Specified Tile is not connected to any Hub");
 
-    return (it1->second == it2->second);
+    for (unsigned int i = 0; i < it1->second.size(); i++)
+	if (find(it2->second.begin(), it2->second.end(), it1->second[i]) != it2->second.end())
+	    return true;
+    return false;
 }
 
 inline bool hasRadioHub(int id)
@@ -228,6 +271,7 @@ inline bool hasRadioHub(int id)
 }
 
 
+// Primary hub of a tile, the one delivering its wireless traffic
 inline int tile2Hub(int id)
 {
     map<int, int>::iterator it = GlobalParams::hub_for_tile.find(id); 
@@ -235,6 +279,92 @@ inline int tile2Hub(int id)
     return it->second;
 }
 
+// Radio hubs of the nodes addressed by a multicast packet, in increasing
+// order
+inline vector<int> multicastHubs(const DestinationSet & multicast)
+{
+    vector<int> nodes = multicast.nodes();
+    vector<int> hubs;
+
+    for (unsigned int i = 0; i < nodes.size(); i++)
+    {
+	int hub = tile2Hub(nodes[i]);
+	if (find(hubs.begin(), hubs.end(), hub) == hubs.end())
+	    hubs.push_back(hub);
+    }
+    sort(hubs.begin(), hubs.end());
+    return hubs;
+}
+
+// Position of a radio hub [tiles]: the mean coordinates of the tiles
+// attached to it (MESH topology)
+inline void hubPosition(int hub, double & x, double & y)
+{
+    const vector<int> & nodes = GlobalParams::hub_configuration[hub].attachedNodes;
+
+    x = y = 0;
+    for (unsigned int i = 0; i < nodes.size(); i++)
+    {
+	Coord coord = id2Coord(nodes[i]);
+	x += coord.x;
+	y += coord.y;
+    }
+    if (!nodes.empty())
+    {
+	x /= nodes.size();
+	y /= nodes.size();
+    }
+}
+
+// Whether the transmissions of hub tx are heard by hub rx: given by the
+// wireless_interference matrix, otherwise by the distance of the hubs if
+// an interference range is set, otherwise every hub hears every other
+inline bool wirelessHeard(int tx, int rx)
+{
+    const vector<vector<int> > & heard = GlobalParams::wireless_interference;
+
+    if (tx < (int)heard.size() && rx < (int)heard[tx].size())
+	return heard[tx][rx] != 0;
+
+    if (GlobalParams::wireless_interference_range > 0)
+    {
+	double tx_x, tx_y, rx_x, rx_y;
+	hubPosition(tx, tx_x, tx_y);
+	hubPosition(rx, rx_x, rx_y);
+	return sqrt(pow(tx_x - rx_x, 2) + pow(tx_y - rx_y, 2)) <= GlobalParams::wireless_interference_range;
+    }
+
+    return true;
+}
+
+// Whether the radio channels are split in more tokens (spatial reuse)
+inline bool wirelessReuse()
+{
+    if (GlobalParams::wireless_reuse_region > 0)
+	return true;
+
+    for (map<int, ChannelConfig>::const_iterator i = GlobalParams::channel_configuration.begin();
+	 i != GlobalParams::channel_configuration.end(); ++i)
+	if (!i->second.reuseGroups.empty())
+	    return true;
+
+    return false;
+}
+
+// Cycles from the start of a flit on a radio channel, flit_cycles long,
+// to the start of the next one when no error occurs: with STOP_AND_WAIT
+// each flit waits for its acknowledgement, with GO_BACK_N a window of
+// flits shares the wait
+inline int arqFlitCycles(int flit_cycles)
+{
+    if (GlobalParams::wireless_arq == ARQ_NONE)
+	return flit_cycles;
+
+    int window = GlobalParams::wireless_arq == ARQ_GO_BACK_N ? GlobalParams::wireless_arq_window : 1;
+
+    return max(flit_cycles, (int)ceil((double)(flit_cycles + GlobalParams::wireless_ack_cycles) / window));
+}
+
 
 inline void printMap(string label, const map<string,double> & m,std::ostream & out)
 {
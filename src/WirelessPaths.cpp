@@ -0,0 +1,272 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the implementation of the table of the wired/wireless
+ * path decisions taken by the routers of a WiNoC
+ */
+
+#include "WirelessPaths.h"
+#include "Router.h"
+#include "Hub.h"
+
+int WirelessPaths::n_tiles = 0;
+vector < vector <int> > WirelessPaths::hubs_of_node;
+vector <bool> WirelessPaths::direct;
+vector < vector <int> > WirelessPaths::relays;
+vector < vector <int> > WirelessPaths::links;
+vector <int> WirelessPaths::next_link;
+vector <Hub *> WirelessPaths::hubs;
+vector <unsigned long> WirelessPaths::eligible;
+vector <unsigned long> WirelessPaths::offloaded;
+vector <unsigned long> WirelessPaths::balanced;
+
+void WirelessPaths::configure(Router * router, const map<int, Hub *> & _hubs)
+{
+    int n_nodes;
+
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	n_tiles = GlobalParams::mesh_dim_x * GlobalParams::mesh_dim_y;
+	n_nodes = n_tiles;
+    }
+    else
+    {
+	// cores followed by the switches of each stage
+	n_tiles = GlobalParams::n_delta_tiles;
+	n_nodes = n_tiles + (n_tiles/2) * (int)log2(n_tiles);
+    }
+
+    hubs_of_node.assign(n_nodes, vector <int> ());
+    for (map<int, vector<int> >::iterator i = GlobalParams::hubs_for_tile.begin(); i != GlobalParams::hubs_for_tile.end(); i++)
+	if (i->first < n_nodes)
+	    hubs_of_node[i->first] = i->second;
+
+    int max_hub = NOT_VALID;
+    for (map<int, Hub *>::const_iterator i = _hubs.begin(); i != _hubs.end(); i++)
+	max_hub = max(max_hub, i->first);
+    hubs.assign(max_hub + 1, NULL);
+    for (map<int, Hub *>::const_iterator i = _hubs.begin(); i != _hubs.end(); i++)
+	hubs[i->first] = i->second;
+    eligible.assign(max_hub + 1, 0);
+    offloaded.assign(max_hub + 1, 0);
+    balanced.assign(max_hub + 1, 0);
+
+    // NOTE: the destination hub is checked as the transmitter, as
+    // done since the first WiNoC releases
+    links.assign(n_nodes * (max_hub + 1), vector <int> ());
+    next_link.assign(n_nodes, 0);
+    for (int node = 0; node < n_nodes; node++)
+    {
+	const vector <int> & node_hubs = hubs_of_node[node];
+	if (node_hubs.size() < 2)
+	    continue;
+
+	for (int hub = 0; hub <= max_hub; hub++)
+	{
+	    if (!hubs[hub])
+		continue;
+
+	    for (unsigned int k = 0; k < node_hubs.size(); k++)
+		if (node_hubs[k] != hub && router->connectedHubs(hub, node_hubs[k]))
+		    links[node * (max_hub + 1) + hub].push_back(k);
+	}
+    }
+
+    direct.assign(n_nodes * n_tiles, false);
+    for (int node = 0; node < n_nodes; node++)
+    {
+	const vector <int> & node_hubs = hubs_of_node[node];
+
+	for (int dst = 0; dst < n_tiles && !node_hubs.empty(); dst++)
+	{
+	    int dst_hub = getHub(dst);
+	    if (dst_hub == NOT_VALID)
+		continue;
+
+	    if (node_hubs.size() > 1)
+		direct[node * n_tiles + dst] = !links[node * (max_hub + 1) + dst_hub].empty();
+	    else if (dst_hub != node_hubs[0])
+		direct[node * n_tiles + dst] = router->connectedHubs(dst_hub, node_hubs[0]);
+	}
+    }
+
+    relays.clear();
+    if (GlobalParams::winoc_dst_hops > 0)
+    {
+	relays.resize(n_tiles * n_tiles);
+
+	RouteData rd;
+	for (int src = 0; src < n_tiles; src++)
+	    for (int dst = 0; dst < n_tiles; dst++)
+	    {
+		if (src == dst)
+		    continue;
+
+		rd.src_id = src;
+		rd.dst_id = dst;
+		rd.current_id = src;
+		vector <int> hops = router->nextDeltaHops(rd);
+
+		int dest_position = hops.size() - 1;
+		for (int i = 1; i <= GlobalParams::winoc_dst_hops && i <= dest_position; i++)
+		{
+		    int candidate_hop = hops[dest_position - i];
+		    if (!hubs_of_node[candidate_hop].empty())
+			relays[src * n_tiles + dst].push_back(candidate_hop);
+		}
+	    }
+    }
+}
+
+int WirelessPaths::route(const int current, const int src, const int dst)
+{
+    const vector <int> & node_hubs = hubs_of_node[current];
+
+    if (node_hubs.empty())
+	return NOT_VALID;
+
+    if (direct[current * n_tiles + dst])
+	return DIRECTION_HUB;
+
+    if (!relays.empty())
+    {
+	const vector <int> & candidates = relays[src * n_tiles + dst];
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	    if (node_hubs.size() > 1 || getHub(candidates[i]) != node_hubs[0])
+		return DIRECTION_HUB_RELAY + candidates[i];
+    }
+
+    return NOT_VALID;
+}
+
+int WirelessPaths::wiredHops(const int from, const int dst)
+{
+    if (GlobalParams::topology == TOPOLOGY_MESH)
+    {
+	Coord a = id2Coord(from);
+	Coord b = id2Coord(dst);
+	return abs(a.x - b.x) + abs(a.y - b.y);
+    }
+
+    // delta topologies: every path crosses all the stages
+    int stages = (int)log2(GlobalParams::n_delta_tiles);
+    if (from < GlobalParams::n_delta_tiles)
+	return stages + 1;
+    return stages - id2Coord(from).x;
+}
+
+double WirelessPaths::wirelessLatency(const int current, const int direction, const int dst, const int length)
+{
+    int target = (direction == DIRECTION_HUB) ? dst : direction - DIRECTION_HUB_RELAY;
+
+    int link = hubs_of_node[current].size() > 1 ? selectLink(current, target, length) : 0;
+    double latency = 2 + hubs[hubs_of_node[current][link]]->wirelessLatency(getHub(target), length);
+
+    if (target != dst)
+	latency += wiredHops(target, dst);
+
+    return latency;
+}
+
+int WirelessPaths::selectLink(const int current, const int target, const int length)
+{
+    const vector <int> & candidates = links[current * hubs.size() + getHub(target)];
+
+    // the hubs reached by none of the links are left to the primary one
+    if (candidates.empty())
+	return 0;
+
+    if (GlobalParams::hub_selection == HUB_SELECTION_ROUND_ROBIN)
+    {
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	    if (candidates[i] >= next_link[current])
+		return candidates[i];
+	return candidates[0];
+    }
+
+    if (GlobalParams::hub_selection == HUB_SELECTION_ADAPTIVE)
+    {
+	// the flits queued by the node in the hub, then the token wait,
+	// the antenna queue and the packet on the best channel
+	int best = candidates[0];
+	double best_latency = NOT_VALID;
+
+	for (unsigned int i = 0; i < candidates.size(); i++)
+	{
+	    Hub * hub = hubs[hubs_of_node[current][candidates[i]]];
+	    double latency = hub->fromTileFlits(current) + hub->wirelessLatency(getHub(target), length);
+
+	    if (best_latency == NOT_VALID || latency < best_latency)
+	    {
+		best = candidates[i];
+		best_latency = latency;
+	    }
+	}
+	return best;
+    }
+
+    // PRIMARY: the first hub reaching the target one
+    return candidates[0];
+}
+
+void WirelessPaths::account(const int current, const bool wireless)
+{
+    int hub = getHub(current);
+
+    eligible[hub]++;
+    if (wireless)
+	offloaded[hub]++;
+}
+
+void WirelessPaths::showStats(std::ostream & out)
+{
+    unsigned long total_eligible = 0;
+    unsigned long total_offloaded = 0;
+
+    out << "wireless_offload = [" << endl;
+    out << "%	hub	eligible_packets	wireless_packets	offload_ratio" << endl;
+    for (unsigned int i = 0; i < hubs.size(); i++)
+    {
+	if (!hubs[i])
+	    continue;
+
+	out << "\t" << i << "\t" << eligible[i] << "\t" << offloaded[i]
+	    << "\t" << (eligible[i] > 0 ? offloaded[i] / (double) eligible[i] : 0) << endl;
+	total_eligible += eligible[i];
+	total_offloaded += offloaded[i];
+    }
+    out << "];" << endl;
+
+    out << "% Wireless offload ratio: " << (total_eligible > 0 ? total_offloaded / (double) total_eligible : 0) << endl;
+}
+
+void WirelessPaths::accountLink(const int current, const int link)
+{
+    balanced[hubs_of_node[current][link]]++;
+    next_link[current] = (link + 1) % hubs_of_node[current].size();
+}
+
+void WirelessPaths::showLinkStats(std::ostream & out)
+{
+    unsigned long total = 0;
+
+    for (unsigned int i = 0; i < balanced.size(); i++)
+	total += balanced[i];
+
+    out << "hub_selection = [" << endl;
+    out << "%	hub	packets	share" << endl;
+    for (unsigned int i = 0; i < hubs.size(); i++)
+    {
+	if (!hubs[i])
+	    continue;
+
+	out << "\t" << i << "\t" << balanced[i] << "\t" << (total > 0 ? balanced[i] / (double) total : 0) << endl;
+    }
+    out << "];" << endl;
+
+    out << "% Packets of tiles attached to several hubs: " << total << endl;
+}
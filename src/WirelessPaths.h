@@ -0,0 +1,100 @@
+/*
+ * Noxim - the NoC Simulator
+ *
+ * (C) 2005-2018 by the University of Catania
+ * For the complete list of authors refer to file ../doc/AUTHORS.txt
+ * For the license applied to these sources refer to file ../doc/LICENSE.txt
+ *
+ * This file contains the declaration of the table of the wired/wireless
+ * path decisions taken by the routers of a WiNoC
+ */
+
+#ifndef __NOXIMWIRELESSPATHS_H__
+#define __NOXIMWIRELESSPATHS_H__
+
+#include <map>
+#include <vector>
+#include <iostream>
+
+#include "GlobalParams.h"
+
+using namespace std;
+
+class Router;
+struct Hub;
+
+class WirelessPaths {
+
+  public:
+
+    // Builds the decisions from the hub configuration (hubs_for_tile and
+    // the channels of the hubs). The router is only used to compute the
+    // delta paths of the relays, the hubs to estimate the wireless
+    // latency (ADAPTIVE path selection). To be called again whenever the
+    // hub configuration changes
+    static void configure(Router * router, const map<int, Hub *> & hubs);
+
+    // Direction taken at node current by a packet from src to dst:
+    // DIRECTION_HUB, DIRECTION_HUB_RELAY + relay node or NOT_VALID for
+    // wired routing
+    static int route(const int current, const int src, const int dst);
+
+    // Primary hub of a node, NOT_VALID if not attached to any
+    static int getHub(const int id) { return hubs_of_node[id].empty() ? NOT_VALID : hubs_of_node[id][0]; }
+
+    // Hubs of a node, primary first: its r2h link k leads to the k-th
+    static const vector <int> & getHubs(const int id) { return hubs_of_node[id]; }
+
+    // Hub module of a hub id
+    static Hub * getHubModule(const int id) { return hubs[id]; }
+
+    // r2h link taken at node current, attached to several hubs, by a
+    // packet of length flits to the primary hub of target (destination
+    // or relay), among the links to the other hubs sharing a channel
+    // with it (GlobalParams::hub_selection)
+    static int selectLink(const int current, const int target, const int length);
+
+    // Wired hops from a node to a destination tile
+    static int wiredHops(const int from, const int dst);
+
+    // Cycles a packet of length flits is expected to take to reach dst
+    // when taking the wireless direction at node current: the hops to and
+    // from the hubs, the radio and the wired hops after a relay
+    static double wirelessLatency(const int current, const int direction, const int dst, const int length);
+
+    // Counts a packet for which the node could use its hub, and whether
+    // it did (ADAPTIVE path selection)
+    static void account(const int current, const bool wireless);
+
+    // Counts a packet sent on r2h link of node current, attached to
+    // several hubs
+    static void accountLink(const int current, const int link);
+
+    static void showStats(std::ostream & out);
+
+    // Packets of the nodes attached to several hubs taken by each hub
+    static void showLinkStats(std::ostream & out);
+
+  private:
+
+    static int n_tiles;
+    static vector < vector <int> > hubs_of_node;	// by node id, primary first
+    static vector <bool> direct;		// by (node, destination tile)
+
+    // by (source, destination tile): the hub attached nodes among the
+    // last winoc_dst_hops hops of the path, closest to the destination
+    // first
+    static vector < vector <int> > relays;
+
+    // by (node attached to several hubs, hub): its r2h links to the hubs
+    // sharing a channel with the hub, other than the hub itself
+    static vector < vector <int> > links;
+    static vector <int> next_link;		// ROUND_ROBIN, by node id
+
+    static vector <Hub *> hubs;			// by hub id
+    static vector <unsigned long> eligible;	// packets, by hub id
+    static vector <unsigned long> offloaded;	// packets sent wireless, by hub id
+    static vector <unsigned long> balanced;	// packets of nodes attached to several hubs, by hub id
+};
+
+#endif
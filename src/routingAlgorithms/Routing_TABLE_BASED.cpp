@@ -19,7 +19,7 @@ vector<int> Routing_TABLE_BASED::route(Router * router, const RouteData & routeD
     AdmissibleOutputs ao = router->routing_table.getAdmissibleOutputs(routeData.dir_in, routeData.dst_id);
 
     if (ao.size() == 0) {
-        LOG << "dir: " << routeData.dir_in << ", (" << current.x << "," << current.
+        LOG_AT(LOG_LEVEL_ERROR, router->name()) << "dir: " << routeData.dir_in << ", (" << current.x << "," << current.
             y << ") --> " << "(" << destination.x << "," << destination.
             y << ")" << endl << routeData.current_id << "->" <<
             routeData.dst_id << endl;